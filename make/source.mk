@@ -64,6 +64,7 @@ COMMON_SRC = \
             fc/controlrate_profile.c \
             drivers/camera_control.c \
             drivers/accgyro/gyro_sync.c \
+            drivers/dshot_telemetry.c \
             drivers/pwm_esc_detect.c \
             drivers/pwm_output.c \
             drivers/rx/rx_spi.c \
@@ -74,6 +75,8 @@ COMMON_SRC = \
             fc/fc_rc.c \
             fc/rc_adjustments.c \
             fc/rc_controls.c \
+            fc/rc_latency.c \
+            fc/rc_prediction.c \
             fc/rc_modes.c \
             flight/position.c \
             flight/failsafe.c \
@@ -82,6 +85,7 @@ COMMON_SRC = \
             flight/mixer.c \
             flight/mixer_tricopter.c \
             flight/pid.c \
+            flight/rpm_filter.c \
             flight/servos.c \
             flight/servos_tricopter.c \
             interface/cli.c \
@@ -110,10 +114,12 @@ COMMON_SRC = \
             sensors/compass.c \
             sensors/gyro.c \
             sensors/gyroanalyse.c \
+            sensors/gyro_capture.c \
             sensors/initialisation.c \
             blackbox/blackbox.c \
             blackbox/blackbox_encoding.c \
             blackbox/blackbox_io.c \
+            blackbox/blackbox_compact.c \
             cms/cms.c \
             cms/cms_menu_blackbox.c \
             cms/cms_menu_builtin.c \
@@ -183,6 +189,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             common/encoding.c \
             common/filter.c \
             common/maths.c \
+            common/sdft.c \
             common/typeconversion.c \
             drivers/accgyro/accgyro_fake.c \
             drivers/accgyro/accgyro_mpu.c \
@@ -204,6 +211,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             drivers/buf_writer.c \
             drivers/bus.c \
             drivers/bus_spi.c \
+            drivers/dshot_telemetry.c \
             drivers/exti.c \
             drivers/io.c \
             drivers/pwm_output.c \
@@ -216,10 +224,13 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             fc/fc_tasks.c \
             fc/fc_rc.c \
             fc/rc_controls.c \
+            fc/rc_latency.c \
+            fc/rc_prediction.c \
             fc/runtime_config.c \
             flight/imu.c \
             flight/mixer.c \
             flight/pid.c \
+            flight/rpm_filter.c \
             rx/ibus.c \
             rx/rx.c \
             rx/rx_spi.c \
@@ -235,6 +246,7 @@ SPEED_OPTIMISED_SRC := $(SPEED_OPTIMISED_SRC) \
             sensors/boardalignment.c \
             sensors/gyro.c \
             sensors/gyroanalyse.c \
+            sensors/gyro_capture.c \
             $(CMSIS_SRC) \
             $(DEVICE_STDPERIPH_SRC) \
 
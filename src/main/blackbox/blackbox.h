@@ -50,11 +50,30 @@ typedef enum FlightLogEvent {
     FLIGHT_LOG_EVENT_LOG_END = 255
 } FlightLogEvent;
 
+// Groups of fields that can be dropped from the log, the bits of blackboxConfig_t.fields_disabled_mask
+typedef enum {
+    FLIGHT_LOG_FIELD_SELECT_PID = 0,
+    FLIGHT_LOG_FIELD_SELECT_RC_COMMANDS,
+    FLIGHT_LOG_FIELD_SELECT_BATTERY,
+    FLIGHT_LOG_FIELD_SELECT_MAG,
+    FLIGHT_LOG_FIELD_SELECT_ALTITUDE,
+    FLIGHT_LOG_FIELD_SELECT_RSSI,
+    FLIGHT_LOG_FIELD_SELECT_GYRO,
+    FLIGHT_LOG_FIELD_SELECT_ACC,
+    FLIGHT_LOG_FIELD_SELECT_DEBUG,
+    FLIGHT_LOG_FIELD_SELECT_MOTOR,
+    FLIGHT_LOG_FIELD_SELECT_GPS,
+    FLIGHT_LOG_FIELD_SELECT_COUNT
+} FlightLogFieldSelect_e;
+
 typedef struct blackboxConfig_s {
     uint16_t p_ratio; // I-frame interval / P-frame interval
     uint8_t device;
     uint8_t record_acc;
     uint8_t mode;
+    uint8_t high_rate; // log compact frames every PID loop instead of I/P frames
+    uint8_t compression; // Huffman code the frames of flash logs
+    uint32_t fields_disabled_mask; // FlightLogFieldSelect_e groups left out of I/P and GPS frames
 } blackboxConfig_t;
 
 PG_DECLARE(blackboxConfig_t, blackboxConfig);
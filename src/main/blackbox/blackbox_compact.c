@@ -0,0 +1,223 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/encoding.h"
+#include "common/maths.h"
+
+#include "blackbox_compact.h"
+
+typedef struct bitWriter_s {
+    uint8_t *buf;
+    int length;
+    uint64_t bits;
+    int bitCount;
+} bitWriter_t;
+
+typedef struct bitReader_s {
+    const uint8_t *buf;
+    int length;
+    int pos;
+    uint64_t bits;
+    int bitCount;
+} bitReader_t;
+
+// number of bits needed to store value, zero needs none
+static int bitLength(uint32_t value)
+{
+    return value ? 32 - __builtin_clz(value) : 0;
+}
+
+static int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static void writeBits(bitWriter_t *writer, uint32_t value, int width)
+{
+    // at most 7 bits are pending, so a 32 bit value always fits in the accumulator
+    writer->bits |= (uint64_t)value << writer->bitCount;
+    writer->bitCount += width;
+    while (writer->bitCount >= 8) {
+        writer->buf[writer->length++] = writer->bits;
+        writer->bits >>= 8;
+        writer->bitCount -= 8;
+    }
+}
+
+static void flushBits(bitWriter_t *writer)
+{
+    if (writer->bitCount > 0) {
+        writer->buf[writer->length++] = writer->bits;
+        writer->bits = 0;
+        writer->bitCount = 0;
+    }
+}
+
+static bool readBits(bitReader_t *reader, int width, uint32_t *value)
+{
+    while (reader->bitCount < width) {
+        if (reader->pos >= reader->length) {
+            return false;
+        }
+        reader->bits |= (uint64_t)reader->buf[reader->pos++] << reader->bitCount;
+        reader->bitCount += 8;
+    }
+    *value = width ? reader->bits & (0xffffffffU >> (32 - width)) : 0;
+    reader->bits >>= width;
+    reader->bitCount -= width;
+    return true;
+}
+
+static void writeGroup(bitWriter_t *writer, const int16_t *values, const int16_t *previous, int count, bool keyFrame)
+{
+    uint32_t residuals[BLACKBOX_COMPACT_FIELD_COUNT];
+    uint32_t mask = 0;
+
+    for (int i = 0; i < count; i++) {
+        residuals[i] = zigzagEncode(keyFrame ? values[i] : values[i] - previous[i]);
+        mask |= residuals[i];
+    }
+
+    const int width = bitLength(mask);
+    writeBits(writer, width, BLACKBOX_COMPACT_GROUP_WIDTH_BITS);
+    for (int i = 0; i < count; i++) {
+        writeBits(writer, residuals[i], width);
+    }
+}
+
+static bool readGroup(bitReader_t *reader, int16_t *values, const int16_t *previous, int count, bool keyFrame)
+{
+    uint32_t width;
+    if (!readBits(reader, BLACKBOX_COMPACT_GROUP_WIDTH_BITS, &width) || width > BLACKBOX_COMPACT_FIELD_MAX_BITS) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        uint32_t residual;
+        if (!readBits(reader, width, &residual)) {
+            return false;
+        }
+        values[i] = zigzagDecode(residual) + (keyFrame ? 0 : previous[i]);
+    }
+    return true;
+}
+
+void blackboxCompactInit(blackboxCompactState_t *state, int motorCount)
+{
+    memset(state, 0, sizeof(*state));
+    state->fieldCount = BLACKBOX_COMPACT_FIELD_MOTOR + constrain(motorCount, 0, MAX_SUPPORTED_MOTORS);
+}
+
+/*
+ * Encode frame into buf, which must hold BLACKBOX_COMPACT_MAX_FRAME_SIZE bytes. A delta frame is written as a key
+ * frame if no key frame preceded it.
+ *
+ * Returns the number of bytes written.
+ */
+int blackboxCompactEncode(blackboxCompactState_t *state, const blackboxCompactFrame_t *frame, bool keyFrame, uint8_t *buf)
+{
+    keyFrame = keyFrame || !state->hasKeyFrame;
+
+    buf[0] = keyFrame ? BLACKBOX_COMPACT_KEY_FRAME : BLACKBOX_COMPACT_DELTA_FRAME;
+    bitWriter_t writer = { .buf = buf, .length = 1 };
+
+    // time is stored as the change in loop time, which is zero while the loop runs at a steady rate
+    uint32_t time;
+    if (keyFrame) {
+        time = frame->time;
+        state->previousTimeDelta = 0;
+    } else {
+        const uint32_t timeDelta = frame->time - state->previous.time;
+        time = zigzagEncode((int32_t)(timeDelta - state->previousTimeDelta));
+        state->previousTimeDelta = timeDelta;
+    }
+    const int timeWidth = bitLength(time);
+    writeBits(&writer, timeWidth, BLACKBOX_COMPACT_TIME_WIDTH_BITS);
+    writeBits(&writer, time, timeWidth);
+
+    const int16_t *values = frame->fields;
+    const int16_t *previous = state->previous.fields;
+    writeGroup(&writer, values + BLACKBOX_COMPACT_FIELD_GYRO_UNFILT, previous + BLACKBOX_COMPACT_FIELD_GYRO_UNFILT, XYZ_AXIS_COUNT, keyFrame);
+    writeGroup(&writer, values + BLACKBOX_COMPACT_FIELD_GYRO, previous + BLACKBOX_COMPACT_FIELD_GYRO, XYZ_AXIS_COUNT, keyFrame);
+    writeGroup(&writer, values + BLACKBOX_COMPACT_FIELD_PID_SUM, previous + BLACKBOX_COMPACT_FIELD_PID_SUM, XYZ_AXIS_COUNT, keyFrame);
+    writeGroup(&writer, values + BLACKBOX_COMPACT_FIELD_MOTOR, previous + BLACKBOX_COMPACT_FIELD_MOTOR, state->fieldCount - BLACKBOX_COMPACT_FIELD_MOTOR, keyFrame);
+    flushBits(&writer);
+
+    state->previous = *frame;
+    state->hasKeyFrame = true;
+
+    return writer.length;
+}
+
+/*
+ * Decode the frame at the start of buf. Fields beyond the motor count are zero.
+ *
+ * Returns the number of bytes consumed, or -1 if the frame is corrupt, truncated, or is a delta frame with no
+ * preceding key frame. The state is left untouched on failure so the caller can resynchronise on the next key frame.
+ */
+int blackboxCompactDecode(blackboxCompactState_t *state, const uint8_t *buf, int length, blackboxCompactFrame_t *frame)
+{
+    if (length < 1) {
+        return -1;
+    }
+    const bool keyFrame = buf[0] == BLACKBOX_COMPACT_KEY_FRAME;
+    if (!keyFrame && (buf[0] != BLACKBOX_COMPACT_DELTA_FRAME || !state->hasKeyFrame)) {
+        return -1;
+    }
+
+    bitReader_t reader = { .buf = buf, .length = length, .pos = 1 };
+    blackboxCompactFrame_t decoded;
+    memset(&decoded, 0, sizeof(decoded));
+
+    uint32_t timeWidth;
+    uint32_t time;
+    if (!readBits(&reader, BLACKBOX_COMPACT_TIME_WIDTH_BITS, &timeWidth) || timeWidth > 32 || !readBits(&reader, timeWidth, &time)) {
+        return -1;
+    }
+    uint32_t timeDelta = 0;
+    if (keyFrame) {
+        decoded.time = time;
+    } else {
+        timeDelta = state->previousTimeDelta + zigzagDecode(time);
+        decoded.time = state->previous.time + timeDelta;
+    }
+
+    int16_t *values = decoded.fields;
+    const int16_t *previous = state->previous.fields;
+    if (!readGroup(&reader, values + BLACKBOX_COMPACT_FIELD_GYRO_UNFILT, previous + BLACKBOX_COMPACT_FIELD_GYRO_UNFILT, XYZ_AXIS_COUNT, keyFrame)
+        || !readGroup(&reader, values + BLACKBOX_COMPACT_FIELD_GYRO, previous + BLACKBOX_COMPACT_FIELD_GYRO, XYZ_AXIS_COUNT, keyFrame)
+        || !readGroup(&reader, values + BLACKBOX_COMPACT_FIELD_PID_SUM, previous + BLACKBOX_COMPACT_FIELD_PID_SUM, XYZ_AXIS_COUNT, keyFrame)
+        || !readGroup(&reader, values + BLACKBOX_COMPACT_FIELD_MOTOR, previous + BLACKBOX_COMPACT_FIELD_MOTOR, state->fieldCount - BLACKBOX_COMPACT_FIELD_MOTOR, keyFrame)) {
+        return -1;
+    }
+
+    state->previous = decoded;
+    state->previousTimeDelta = timeDelta;
+    state->hasKeyFrame = true;
+    *frame = decoded;
+
+    // the remaining bits of the last byte are padding
+    return reader.pos;
+}
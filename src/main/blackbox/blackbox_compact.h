@@ -0,0 +1,73 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/axis.h"
+#include "drivers/pwm_output_counts.h"
+
+/*
+ * Compact frames are used by the high rate logging mode. They have a fixed field layout so the encoder can
+ * run every PID loop: each group of fields is stored as residuals against the previous frame, zig-zag
+ * encoded and bit-packed at the width of the largest residual in the group.
+ *
+ * 'K' key frames store absolute values, 'D' delta frames store residuals against the previous frame.
+ */
+#define BLACKBOX_COMPACT_KEY_FRAME   'K'
+#define BLACKBOX_COMPACT_DELTA_FRAME 'D'
+
+typedef enum {
+    BLACKBOX_COMPACT_FIELD_GYRO_UNFILT = 0,
+    BLACKBOX_COMPACT_FIELD_GYRO = BLACKBOX_COMPACT_FIELD_GYRO_UNFILT + XYZ_AXIS_COUNT,
+    BLACKBOX_COMPACT_FIELD_PID_SUM = BLACKBOX_COMPACT_FIELD_GYRO + XYZ_AXIS_COUNT,
+    BLACKBOX_COMPACT_FIELD_MOTOR = BLACKBOX_COMPACT_FIELD_PID_SUM + XYZ_AXIS_COUNT,
+    BLACKBOX_COMPACT_FIELD_COUNT = BLACKBOX_COMPACT_FIELD_MOTOR + MAX_SUPPORTED_MOTORS
+} blackboxCompactField_e;
+
+#define BLACKBOX_COMPACT_GROUP_COUNT        4
+#define BLACKBOX_COMPACT_TIME_WIDTH_BITS    6
+#define BLACKBOX_COMPACT_GROUP_WIDTH_BITS   5
+// a residual between two int16 values needs 17 bits once zig-zag encoded
+#define BLACKBOX_COMPACT_FIELD_MAX_BITS     17
+
+// frame marker, then the worst case bitstream rounded up to whole bytes
+#define BLACKBOX_COMPACT_MAX_FRAME_SIZE (1 + (BLACKBOX_COMPACT_TIME_WIDTH_BITS + 32 \
+    + BLACKBOX_COMPACT_GROUP_COUNT * BLACKBOX_COMPACT_GROUP_WIDTH_BITS \
+    + BLACKBOX_COMPACT_FIELD_COUNT * BLACKBOX_COMPACT_FIELD_MAX_BITS + 7) / 8)
+
+typedef struct blackboxCompactFrame_s {
+    uint32_t time;
+    int16_t fields[BLACKBOX_COMPACT_FIELD_COUNT];
+} blackboxCompactFrame_t;
+
+// Shared by the encoder and the decoder, both sides must see the same sequence of frames
+typedef struct blackboxCompactState_s {
+    blackboxCompactFrame_t previous;
+    uint32_t previousTimeDelta;
+    uint8_t fieldCount;
+    bool hasKeyFrame;
+} blackboxCompactState_t;
+
+void blackboxCompactInit(blackboxCompactState_t *state, int motorCount);
+int blackboxCompactEncode(blackboxCompactState_t *state, const blackboxCompactFrame_t *frame, bool keyFrame, uint8_t *buf);
+int blackboxCompactDecode(blackboxCompactState_t *state, const uint8_t *buf, int length, blackboxCompactFrame_t *frame);
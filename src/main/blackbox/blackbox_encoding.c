@@ -32,6 +32,7 @@
 #include "blackbox_io.h"
 
 #include "common/encoding.h"
+#include "common/huffman.h"
 #include "common/printf.h"
 
 
@@ -507,4 +508,46 @@ void blackboxWriteFloat(float value)
 {
     blackboxWriteU32(castFloatBytesToInt(value));
 }
+
+#ifdef USE_BLACKBOX_COMPRESSION
+/**
+ * Huffman code length bytes of data into block, which must hold BLACKBOX_COMPRESSED_BLOCK_MAX_SIZE(length) bytes.
+ * Data that doesn't get smaller is stored as it is.
+ *
+ * Returns the length of the block.
+ */
+int blackboxCompressBlock(uint8_t *block, const uint8_t *data, int length)
+{
+    uint8_t *payload = block + BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE;
+
+    huffmanState_t state = {
+        .bytesWritten = 0,
+        .outByte = payload,
+        .outBufLen = length,
+        .outBit = 0x80,
+    };
+    *state.outByte = 0;
+
+    int compressedLength = 0;
+    if (huffmanEncodeBufStreaming(&state, data, length, huffmanTable) == 0) {
+        if (state.outBit != 0x80) {
+            ++state.bytesWritten;
+        }
+        if (state.bytesWritten < length) {
+            compressedLength = state.bytesWritten;
+        }
+    }
+    if (compressedLength == 0) {
+        memcpy(payload, data, length);
+    }
+
+    block[0] = BLACKBOX_COMPRESSED_BLOCK_MARKER;
+    block[1] = length & 0xFF;
+    block[2] = (length >> 8) & 0xFF;
+    block[3] = compressedLength & 0xFF;
+    block[4] = (compressedLength >> 8) & 0xFF;
+
+    return BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE + (compressedLength ? compressedLength : length);
+}
+#endif
 #endif // BLACKBOX
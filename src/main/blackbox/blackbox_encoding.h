@@ -34,3 +34,15 @@ void blackboxWriteTag8_4S16(int32_t *values);
 void blackboxWriteTag8_8SVB(int32_t *values, int valueCount);
 void blackboxWriteU32(int32_t value);
 void blackboxWriteFloat(float value);
+
+/*
+ * Compressed logs store the frame data as a sequence of blocks: the marker, the uncompressed length and the
+ * compressed length as little endian uint16s, then the Huffman coded bytes. A compressed length of zero means
+ * the block is stored uncompressed. The headers before the first frame are not compressed.
+ */
+#define BLACKBOX_COMPRESSED_BLOCK_MARKER 'Z'
+#define BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE 5
+// the encoder clears the byte after the last one it fills
+#define BLACKBOX_COMPRESSED_BLOCK_MAX_SIZE(length) (BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE + (length) + 1)
+
+int blackboxCompressBlock(uint8_t *block, const uint8_t *data, int length);
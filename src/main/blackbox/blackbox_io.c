@@ -29,6 +29,7 @@
 #ifdef USE_BLACKBOX
 
 #include "blackbox.h"
+#include "blackbox_encoding.h"
 #include "blackbox_io.h"
 
 #include "common/maths.h"
@@ -49,9 +50,20 @@ static uint8_t blackboxMaxHeaderBytesPerIteration;
 // How many bytes can we write *this* iteration without overflowing transmit buffers or overstressing the OpenLog?
 int32_t blackboxHeaderBudget;
 
+// Staged bytes that were thrown away because the serial port had no room for them
+uint32_t blackboxDroppedBytes;
+
 static serialPort_t *blackboxPort = NULL;
 static portSharing_e blackboxPortSharing;
 
+static uint8_t blackboxStagingBuffer[BLACKBOX_STAGING_BUFFER_SIZE];
+static int blackboxStagingLength;
+
+#ifdef USE_BLACKBOX_COMPRESSION
+static bool blackboxCompressing;
+static uint8_t blackboxCompressedBlock[BLACKBOX_COMPRESSED_BLOCK_MAX_SIZE(BLACKBOX_STAGING_BUFFER_SIZE)];
+#endif
+
 #ifdef USE_SDCARD
 
 static struct {
@@ -83,61 +95,83 @@ void blackboxOpen(void)
     }
 }
 
-void blackboxWrite(uint8_t value)
+/**
+ * Write the staged bytes to the blackbox device in one call.
+ */
+void blackboxCommit(void)
 {
-    switch (blackboxConfig()->device) {
-#ifdef USE_FLASHFS
-    case BLACKBOX_DEVICE_FLASH:
-        flashfsWriteByte(value); // Write byte asynchronously
-        break;
-#endif
-#ifdef USE_SDCARD
-    case BLACKBOX_DEVICE_SDCARD:
-        afatfs_fputc(blackboxSDCard.logFile, value);
-        break;
-#endif
-    case BLACKBOX_DEVICE_SERIAL:
-    default:
-        serialWrite(blackboxPort, value);
-        break;
+    if (blackboxStagingLength == 0) {
+        return;
     }
-}
-
-// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
-int blackboxWriteString(const char *s)
-{
-    int length;
-    const uint8_t *pos;
 
     switch (blackboxConfig()->device) {
-
 #ifdef USE_FLASHFS
     case BLACKBOX_DEVICE_FLASH:
-        length = strlen(s);
-        flashfsWrite((const uint8_t*) s, length, false); // Write asynchronously
+#ifdef USE_BLACKBOX_COMPRESSION
+        if (blackboxCompressing) {
+            const int blockLength = blackboxCompressBlock(blackboxCompressedBlock, blackboxStagingBuffer, blackboxStagingLength);
+            flashfsWrite(blackboxCompressedBlock, blockLength, false);
+            break;
+        }
+#endif
+        flashfsWrite(blackboxStagingBuffer, blackboxStagingLength, false); // Write asynchronously
         break;
 #endif // USE_FLASHFS
 
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
-        length = strlen(s);
-        afatfs_fwrite(blackboxSDCard.logFile, (const uint8_t*) s, length); // Ignore failures due to buffers filling up
+        afatfs_fwrite(blackboxSDCard.logFile, blackboxStagingBuffer, blackboxStagingLength); // Ignore failures due to buffers filling up
         break;
 #endif // USE_SDCARD
 
     case BLACKBOX_DEVICE_SERIAL:
     default:
-        pos = (uint8_t*) s;
-        while (*pos) {
-            serialWrite(blackboxPort, *pos);
-            pos++;
+        // Never wait for the port, and never send part of the staged bytes: a block that doesn't fit is dropped
+        // whole so the decoder can resynchronise on the next frame
+        if (blackboxStagingLength <= (int) serialTxBytesFree(blackboxPort)) {
+            serialWriteBuf(blackboxPort, blackboxStagingBuffer, blackboxStagingLength);
+        } else {
+            blackboxDroppedBytes += blackboxStagingLength;
         }
-
-        length = pos - (uint8_t*) s;
         break;
     }
 
-    return length;
+    blackboxStagingLength = 0;
+}
+
+void blackboxWrite(uint8_t value)
+{
+    blackboxStagingBuffer[blackboxStagingLength++] = value;
+    if (blackboxStagingLength == BLACKBOX_STAGING_BUFFER_SIZE) {
+        blackboxCommit();
+    }
+}
+
+void blackboxWriteBuf(const uint8_t *data, int length)
+{
+    while (length > 0) {
+        const int chunk = MIN(length, BLACKBOX_STAGING_BUFFER_SIZE - blackboxStagingLength);
+        memcpy(blackboxStagingBuffer + blackboxStagingLength, data, chunk);
+        blackboxStagingLength += chunk;
+        data += chunk;
+        length -= chunk;
+        if (blackboxStagingLength == BLACKBOX_STAGING_BUFFER_SIZE) {
+            blackboxCommit();
+        }
+    }
+}
+
+// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
+int blackboxWriteString(const char *s)
+{
+    const uint8_t *pos = (const uint8_t *) s;
+
+    while (*pos) {
+        blackboxWrite(*pos);
+        pos++;
+    }
+
+    return pos - (const uint8_t *) s;
 }
 
 /**
@@ -147,6 +181,15 @@ int blackboxWriteString(const char *s)
  */
 void blackboxDeviceFlush(void)
 {
+#ifdef USE_BLACKBOX_COMPRESSION
+    // Only compress full staging buffers, a block per iteration would spend most of the saving on block headers
+    if (!blackboxCompressing) {
+        blackboxCommit();
+    }
+#else
+    blackboxCommit();
+#endif
+
     switch (blackboxConfig()->device) {
 #ifdef USE_FLASHFS
         /*
@@ -163,6 +206,31 @@ void blackboxDeviceFlush(void)
     }
 }
 
+/**
+ * True if the log frames will be compressed, only flash logs are compressed.
+ */
+bool blackboxDeviceCanCompress(void)
+{
+#ifdef USE_BLACKBOX_COMPRESSION
+    return blackboxConfig()->compression && blackboxConfig()->device == BLACKBOX_DEVICE_FLASH;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Start or stop compressing the bytes written from now on. Bytes written before the call are committed as they are.
+ */
+void blackboxDeviceSetCompression(bool enabled)
+{
+#ifdef USE_BLACKBOX_COMPRESSION
+    blackboxCommit();
+    blackboxCompressing = enabled && blackboxDeviceCanCompress();
+#else
+    UNUSED(enabled);
+#endif
+}
+
 /**
  * If there is data waiting to be written to the blackbox device, attempt to write (a portion of) that now.
  *
@@ -170,6 +238,8 @@ void blackboxDeviceFlush(void)
  */
 bool blackboxDeviceFlushForce(void)
 {
+    blackboxCommit();
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         // Nothing to speed up flushing on serial, as serial is continuously being drained out of its buffer
@@ -198,6 +268,12 @@ bool blackboxDeviceFlushForce(void)
  */
 bool blackboxDeviceOpen(void)
 {
+    blackboxStagingLength = 0;
+    blackboxDroppedBytes = 0;
+#ifdef USE_BLACKBOX_COMPRESSION
+    blackboxCompressing = false;
+#endif
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         {
@@ -322,6 +398,8 @@ bool isBlackboxErased(void)
  */
 void blackboxDeviceClose(void)
 {
+    blackboxCommit();
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         // Can immediately close without attempting to flush any remaining data.
@@ -341,6 +419,9 @@ void blackboxDeviceClose(void)
     case BLACKBOX_DEVICE_FLASH:
         // Some flash device, e.g., NAND devices, require explicit close to flush internally buffered data.
         flashfsClose();
+#ifdef USE_FLASHFS_INDEX
+        flashfsLogEnd();
+#endif
         break;
 #endif
     default:
@@ -478,6 +559,11 @@ bool blackboxDeviceBeginLog(void)
     case BLACKBOX_DEVICE_SDCARD:
         return blackboxSDCardBeginLog();
 #endif // USE_SDCARD
+#ifdef USE_FLASHFS_INDEX
+    case BLACKBOX_DEVICE_FLASH:
+        flashfsLogStart();
+        return true;
+#endif
     default:
         return true;
     }
@@ -497,6 +583,8 @@ bool blackboxDeviceEndLog(bool retainLog)
     UNUSED(retainLog);
 #endif
 
+    blackboxCommit();
+
     switch (blackboxConfig()->device) {
 #ifdef USE_SDCARD
     case BLACKBOX_DEVICE_SDCARD:
@@ -554,6 +642,9 @@ void blackboxReplenishHeaderBudget(void)
 {
     int32_t freeSpace;
 
+    // Header bytes staged last iteration must reach the device before its free space is measured
+    blackboxCommit();
+
     switch (blackboxConfig()->device) {
     case BLACKBOX_DEVICE_SERIAL:
         freeSpace = serialTxBytesFree(blackboxPort);
@@ -38,14 +38,25 @@ typedef enum {
  */
 #define BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION 64
 
+/*
+ * Encoded bytes are staged here and committed to the device with one bulk write, normally once per logged
+ * iteration. Big enough for the largest main frame, a frame that does not fit is committed in pieces.
+ */
+#define BLACKBOX_STAGING_BUFFER_SIZE 256
+
 extern int32_t blackboxHeaderBudget;
+extern uint32_t blackboxDroppedBytes;
 
 void blackboxOpen(void);
 void blackboxWrite(uint8_t value);
+void blackboxWriteBuf(const uint8_t *data, int length);
 int blackboxWriteString(const char *s);
+void blackboxCommit(void);
 
 void blackboxDeviceFlush(void);
 bool blackboxDeviceFlushForce(void);
+bool blackboxDeviceCanCompress(void);
+void blackboxDeviceSetCompression(bool enabled);
 bool blackboxDeviceOpen(void);
 void blackboxDeviceClose(void);
 
@@ -76,4 +76,8 @@ const char * const debugModeNames[DEBUG_COUNT] = {
     "RC_SMOOTHING_RATE",
     "ANTI_GRAVITY",
     "IMU",
+    "RPM_FILTER",
+    "DSHOT_RPM_TELEMETRY",
+    "GYRO_FILTER_CYCLES",
+    "RC_LATENCY",
 };
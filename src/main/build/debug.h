@@ -94,6 +94,10 @@ typedef enum {
     DEBUG_RC_SMOOTHING_RATE,
     DEBUG_ANTI_GRAVITY,
     DEBUG_IMU,
+    DEBUG_RPM_FILTER,
+    DEBUG_DSHOT_RPM_TELEMETRY,
+    DEBUG_GYRO_FILTER_CYCLES,
+    DEBUG_RC_LATENCY,
     DEBUG_COUNT
 } debugType_e;
 
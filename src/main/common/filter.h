@@ -21,6 +21,8 @@
 #pragma once
 #include <stdbool.h>
 
+#include "common/axis.h"
+
 struct filter_s;
 typedef struct filter_s filter_t;
 
@@ -41,6 +43,13 @@ typedef struct biquadFilter_s {
     float x1, x2, y1, y2;
 } biquadFilter_t;
 
+/* three axis biquad sharing one set of coefficients, with the per axis state laid out struct-of-arrays */
+typedef struct biquadFilter3_s {
+    float b0, b1, b2, a1, a2;
+    float x1[XYZ_AXIS_COUNT];
+    float x2[XYZ_AXIS_COUNT];
+} biquadFilter3_t;
+
 typedef struct laggedMovingAverage_s {
     uint16_t movingWindowIndex;
     uint16_t windowSize;
@@ -82,6 +91,10 @@ void biquadFilterUpdateLPF(biquadFilter_t *filter, float filterFreq, uint32_t re
 float biquadFilterApplyDF1(biquadFilter_t *filter, float input);
 float biquadFilterApply(biquadFilter_t *filter, float input);
 float filterGetNotchQ(float centerFreq, float cutoffFreq);
+
+void biquadFilter3Init(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+void biquadFilter3InitLPF(biquadFilter3_t *filter, float filterFreq, uint32_t refreshRate);
+void biquadFilter3Apply(biquadFilter3_t *filter, float *data);
 #ifndef STM32F7
 void laggedMovingAverageInit(laggedMovingAverage_t *filter, uint16_t windowSize, float *buf);
 float laggedMovingAverageUpdate(laggedMovingAverage_t *filter, float input);
@@ -0,0 +1,87 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "common/sdft.h"
+
+// keeps the recursion stable, rounding errors decay instead of accumulating
+#define SDFT_DAMPING_FACTOR 0.9999f
+
+static FAST_RAM_ZERO_INIT bool  sdftInitialized;
+static FAST_RAM_ZERO_INIT float rPowerN;
+static FAST_RAM_ZERO_INIT float twiddleRe[SDFT_BIN_COUNT];
+static FAST_RAM_ZERO_INIT float twiddleIm[SDFT_BIN_COUNT];
+
+void sdftInit(sdft_t *sdft, int startBin, int endBin)
+{
+    if (!sdftInitialized) {
+        rPowerN = powf(SDFT_DAMPING_FACTOR, SDFT_SAMPLE_SIZE);
+        for (int k = 0; k < SDFT_BIN_COUNT; k++) {
+            const float phi = 2 * M_PIf * k / SDFT_SAMPLE_SIZE;
+            twiddleRe[k] = SDFT_DAMPING_FACTOR * cos_approx(phi);
+            twiddleIm[k] = SDFT_DAMPING_FACTOR * sin_approx(phi);
+        }
+        sdftInitialized = true;
+    }
+
+    // the window needs the neighbouring bins, so keep one spare bin on either side
+    sdft->startBin = constrain(startBin, 1, SDFT_BIN_COUNT - 2);
+    sdft->endBin = constrain(endBin, sdft->startBin, SDFT_BIN_COUNT - 2);
+    sdft->idx = 0;
+
+    memset(sdft->samples, 0, sizeof(sdft->samples));
+    memset(sdft->re, 0, sizeof(sdft->re));
+    memset(sdft->im, 0, sizeof(sdft->im));
+}
+
+FAST_CODE void sdftPush(sdft_t *sdft, float sample)
+{
+    const float delta = sample - rPowerN * sdft->samples[sdft->idx];
+
+    sdft->samples[sdft->idx] = sample;
+    if (++sdft->idx == SDFT_SAMPLE_SIZE) {
+        sdft->idx = 0;
+    }
+
+    for (int k = sdft->startBin - 1; k <= sdft->endBin + 1; k++) {
+        const float re = sdft->re[k] + delta;
+        const float im = sdft->im[k];
+        sdft->re[k] = twiddleRe[k] * re - twiddleIm[k] * im;
+        sdft->im[k] = twiddleIm[k] * re + twiddleRe[k] * im;
+    }
+}
+
+// squared magnitude of the Hann windowed bins [startBin, endBin], the window is applied in the frequency domain
+FAST_CODE void sdftWinSq(const sdft_t *sdft, float *output)
+{
+    for (int k = sdft->startBin; k <= sdft->endBin; k++) {
+        const float re = 0.5f * sdft->re[k] - 0.25f * (sdft->re[k - 1] + sdft->re[k + 1]);
+        const float im = 0.5f * sdft->im[k] - 0.25f * (sdft->im[k - 1] + sdft->im[k + 1]);
+        output[k] = re * re + im * im;
+    }
+}
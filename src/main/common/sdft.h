@@ -0,0 +1,48 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/utils.h"
+
+// window length of the sliding DFT, 72 samples at 1333Hz gives bins 18.5Hz wide
+#define SDFT_SAMPLE_SIZE 72
+#define SDFT_BIN_COUNT   (SDFT_SAMPLE_SIZE / 2)
+
+STATIC_ASSERT(SDFT_SAMPLE_SIZE <= (uint8_t) -1, sdft_sample_size_greater_than_underlying_type);
+
+/*
+ * Sliding DFT, updates the bins [startBin, endBin] with every new sample in constant time.
+ * Only bins inside the range are maintained, so analysing a band costs proportionally less.
+ */
+typedef struct sdft_s {
+    uint8_t idx;        // oldest sample in the circular buffer
+    uint8_t startBin;
+    uint8_t endBin;
+    float samples[SDFT_SAMPLE_SIZE];
+    float re[SDFT_BIN_COUNT];
+    float im[SDFT_BIN_COUNT];
+} sdft_t;
+
+void sdftInit(sdft_t *sdft, int startBin, int endBin);
+void sdftPush(sdft_t *sdft, float sample);
+void sdftWinSq(const sdft_t *sdft, float *output);
@@ -93,6 +93,10 @@ typedef struct gyroDev_s {
     ioTag_t mpuIntExtiTag;
     uint8_t gyroHasOverflowProtection;
     gyroSensor_e gyroHardware;
+#ifdef USE_SPI_DMA_READ
+    bool useSpiDma;                                         // read the sensor data with SPI DMA when the driver supports it
+    struct spiDmaRead_s *dmaRead;
+#endif
 }  __attribute__((packed)) gyroDev_t;
 
 typedef struct accDev_s {
@@ -135,6 +135,12 @@ FAST_CODE static void mpuIntExtiHandler(extiCallbackRec_t *cb)
     lastCalledAtUs = nowUs;
 #endif
     gyroDev_t *gyro = container_of(cb, gyroDev_t, exti);
+#ifdef USE_SPI_DMA_READ
+    // a started DMA read flags the data from its complete interrupt, otherwise the data is read with a blocking transfer
+    if (gyro->dmaRead && spiBusDmaReadStart(gyro->dmaRead)) {
+        return;
+    }
+#endif
     gyro->dataReady = true;
 #ifdef DEBUG_MPU_DATA_READY_INTERRUPT
     const uint32_t now2Us = micros();
@@ -143,6 +149,14 @@ FAST_CODE static void mpuIntExtiHandler(extiCallbackRec_t *cb)
 #endif // USE_DMA_SPI_DEVICE
 }
 
+#ifdef USE_SPI_DMA_READ
+static void mpuGyroDmaReadComplete(void *arg)
+{
+    gyroDev_t *gyro = arg;
+    gyro->dataReady = true;
+}
+#endif
+
 static void mpuIntExtiInit(gyroDev_t *gyro)
 {
     if (gyro->mpuIntExtiTag == IO_TAG_NONE) {
@@ -169,6 +183,12 @@ static void mpuIntExtiInit(gyroDev_t *gyro)
     EXTIHandlerInit(&gyro->exti, mpuIntExtiHandler);
     EXTIConfig(mpuIntIO, &gyro->exti, NVIC_PRIO_MPU_INT_EXTI, EXTI_Trigger_Rising);
 #endif
+
+#ifdef USE_SPI_DMA_READ
+    if (gyro->useSpiDma && !gyro->dmaRead && gyro->readFn == mpuGyroReadSPI) {
+        gyro->dmaRead = spiBusDmaReadInit(&gyro->bus, MPU_RA_GYRO_XOUT_H, 6, mpuGyroDmaReadComplete, gyro);
+    }
+#endif
     EXTIEnable(mpuIntIO, true);
 }
 #endif // MPU_INT_EXTI
@@ -287,6 +307,17 @@ FAST_CODE bool mpuGyroRead(gyroDev_t *gyro)
 
 FAST_CODE bool mpuGyroReadSPI(gyroDev_t *gyro)
 {
+#ifdef USE_SPI_DMA_READ
+    const uint8_t *dmaData = gyro->dmaRead ? spiBusDmaReadData(gyro->dmaRead) : NULL;
+    if (dmaData) {
+        gyro->gyroADCRaw[X] = (int16_t)((dmaData[0] << 8) | dmaData[1]);
+        gyro->gyroADCRaw[Y] = (int16_t)((dmaData[2] << 8) | dmaData[3]);
+        gyro->gyroADCRaw[Z] = (int16_t)((dmaData[4] << 8) | dmaData[5]);
+
+        return true;
+    }
+#endif
+
     static const uint8_t dataToSend[7] = {MPU_RA_GYRO_XOUT_H | 0x80, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
     uint8_t data[7];
 
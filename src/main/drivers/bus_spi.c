@@ -40,7 +40,22 @@
 #include "drivers/time.h"
 #endif //USE_DMA_SPI_DEVICE
 
+// bounds the wait of a blocking transfer for a DMA read in flight, a burst read takes a few microseconds
+#define SPI_DMA_LOCK_TIMEOUT 10000
+
 FAST_RAM_ZERO_INIT spiDevice_t spiDevice[SPIDEV_COUNT];
+#ifdef USE_SPI_DMA_READ
+// DMA transfer in flight on each bus, the chip select is released once it completes
+typedef struct spiDmaTransfer_s {
+    const busDevice_t *bus;
+    spiDmaCallbackFn callbackFn;
+    void *callbackArg;
+} spiDmaTransfer_t;
+
+static spiDmaTransfer_t spiDmaTransfers[SPIDEV_COUNT];
+// not in FAST_RAM, the F4 CCM is not reachable by the DMA controllers
+static spiDmaRead_t spiDmaReads[SPIDEV_COUNT];
+#endif
 
 SPIDevice spiDeviceByInstance(SPI_TypeDef *instance)
 {
@@ -123,6 +138,148 @@ uint32_t spiTimeoutUserCallback(SPI_TypeDef *instance)
     return spiDevice[device].errorCount;
 }
 
+#ifdef USE_SPI_DMA_READ
+// Blocking transfers take the bus over from the DMA reads, waiting for a read in flight to complete.
+// Returns false if the read doesn't complete, the transfer must not be started then.
+FAST_CODE static bool spiBusLock(const busDevice_t *bus)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    if (device == SPIINVALID) {
+        return true;
+    }
+    spiDevice_t *spi = &spiDevice[device];
+
+    spi->busLocked = true;
+    uint32_t timeout = SPI_DMA_LOCK_TIMEOUT;
+    while (spi->dmaBusy) {
+        if ((timeout--) == 0) {
+            spiTimeoutUserCallback(bus->busdev_u.spi.instance);
+            spi->busLocked = false;
+            return false;
+        }
+    }
+    return true;
+}
+
+FAST_CODE static void spiBusUnlock(const busDevice_t *bus)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    if (device != SPIINVALID) {
+        spiDevice[device].busLocked = false;
+    }
+}
+
+// Claims the DMA streams of the bus, returns false if they are used by another driver
+bool spiBusDmaInit(const busDevice_t *bus)
+{
+    if (bus->bustype != BUSTYPE_SPI) {
+        return false;
+    }
+
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+
+    return device != SPIINVALID && spiDmaInit(device);
+}
+
+// Starts a transfer, returns false when the bus is in use so the caller can fall back to a blocking transfer
+FAST_CODE bool spiBusDmaTransferStart(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int length, spiDmaCallbackFn callbackFn, void *callbackArg)
+{
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    spiDevice_t *spi = &spiDevice[device];
+
+    if (spi->busLocked || spi->dmaBusy) {
+        return false;
+    }
+    spi->dmaBusy = true;
+
+    spiDmaTransfer_t *transfer = &spiDmaTransfers[device];
+    transfer->bus = bus;
+    transfer->callbackFn = callbackFn;
+    transfer->callbackArg = callbackArg;
+
+    IOLo(bus->busdev_u.spi.csnPin);
+    spiDmaTransferStart(device, txData, rxData, length);
+
+    return true;
+}
+
+FAST_CODE void spiDmaTransferComplete(SPIDevice device)
+{
+    const spiDmaTransfer_t *transfer = &spiDmaTransfers[device];
+
+    IOHi(transfer->bus->busdev_u.spi.csnPin);
+    spiDevice[device].dmaBusy = false;
+
+    if (transfer->callbackFn) {
+        transfer->callbackFn(transfer->callbackArg);
+    }
+}
+
+FAST_CODE static void spiDmaReadComplete(void *arg)
+{
+    spiDmaRead_t *dmaRead = arg;
+
+    dmaRead->readIdx = dmaRead->writeIdx;
+    dmaRead->writeIdx ^= 1;
+    dmaRead->dataReady = true;
+
+    if (dmaRead->callbackFn) {
+        dmaRead->callbackFn(dmaRead->callbackArg);
+    }
+}
+
+spiDmaRead_t *spiBusDmaReadInit(const busDevice_t *bus, uint8_t reg, uint8_t length, spiDmaCallbackFn callbackFn, void *callbackArg)
+{
+    if (bus->bustype != BUSTYPE_SPI || length + 1 > SPI_DMA_READ_MAX_LENGTH) {
+        return NULL;
+    }
+
+    const SPIDevice device = spiDeviceByInstance(bus->busdev_u.spi.instance);
+    if (device == SPIINVALID) {
+        return NULL;
+    }
+
+    // one reader per bus, a second device on the same bus keeps reading with blocking transfers
+    spiDmaRead_t *dmaRead = &spiDmaReads[device];
+    if (dmaRead->bus || !spiDmaInit(device)) {
+        return NULL;
+    }
+
+    memset(dmaRead, 0, sizeof(*dmaRead));
+    dmaRead->device = device;
+    dmaRead->length = length + 1;
+    dmaRead->txBuffer[0] = reg | 0x80; // read transaction
+    memset(&dmaRead->txBuffer[1], 0xFF, length);
+    dmaRead->writeIdx = 0;
+    dmaRead->readIdx = 1;
+    dmaRead->callbackFn = callbackFn;
+    dmaRead->callbackArg = callbackArg;
+    dmaRead->bus = bus;
+
+    return dmaRead;
+}
+
+// Starts a burst read, returns false when the bus is in use so the caller can read it with a blocking transfer later
+FAST_CODE bool spiBusDmaReadStart(spiDmaRead_t *dmaRead)
+{
+    return spiBusDmaTransferStart(dmaRead->bus, dmaRead->txBuffer, dmaRead->rxBuffer[dmaRead->writeIdx], dmaRead->length, spiDmaReadComplete, dmaRead);
+}
+
+// Returns the register data of the latest completed read, or NULL if there was none since the last call
+FAST_CODE const uint8_t *spiBusDmaReadData(spiDmaRead_t *dmaRead)
+{
+    if (!dmaRead->dataReady) {
+        return NULL;
+    }
+    dmaRead->dataReady = false;
+
+    return &dmaRead->rxBuffer[dmaRead->readIdx][1];
+}
+#else
+#define spiBusLock(bus) true
+#define spiBusUnlock(bus)
+#endif
+
 
 FAST_CODE bool spiBusTransfer(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int length)
 {
@@ -151,9 +308,13 @@ FAST_CODE bool spiBusTransfer(const busDevice_t *bus, const uint8_t *txData, uin
             IOHi(bus->busdev_u.spi.csnPin);
         }
     #else
+        if (!spiBusLock(bus)) {
+            return false;
+        }
         IOLo(bus->busdev_u.spi.csnPin);
         spiTransfer(bus->busdev_u.spi.instance, txData, rxData, length);
         IOHi(bus->busdev_u.spi.csnPin);
+        spiBusUnlock(bus);
     #endif
     return true;
 }
@@ -202,10 +363,14 @@ FAST_CODE bool spiBusWriteRegister(const busDevice_t *bus, uint8_t reg, uint8_t
             IOHi(bus->busdev_u.spi.csnPin);
         }
     #else
+        if (!spiBusLock(bus)) {
+            return false;
+        }
         IOLo(bus->busdev_u.spi.csnPin);
         spiTransferByte(bus->busdev_u.spi.instance, reg);
         spiTransferByte(bus->busdev_u.spi.instance, data);
         IOHi(bus->busdev_u.spi.csnPin);
+        spiBusUnlock(bus);
     #endif
 
     return true;
@@ -238,10 +403,14 @@ FAST_CODE bool spiBusReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uin
             IOHi(bus->busdev_u.spi.csnPin);
         }
     #else
+        if (!spiBusLock(bus)) {
+            return false;
+        }
         IOLo(bus->busdev_u.spi.csnPin);
         spiTransferByte(bus->busdev_u.spi.instance, reg | 0x80); // read transaction
         spiTransfer(bus->busdev_u.spi.instance, NULL, data, length);
         IOHi(bus->busdev_u.spi.csnPin);
+        spiBusUnlock(bus);
     #endif
 
     return true;
@@ -277,11 +446,15 @@ FAST_CODE uint8_t spiBusReadRegister(const busDevice_t *bus, uint8_t reg)
             return data;
         }
     #else
-        uint8_t data;
+        uint8_t data = 0;
+        if (!spiBusLock(bus)) {
+            return data;
+        }
         IOLo(bus->busdev_u.spi.csnPin);
         spiTransferByte(bus->busdev_u.spi.instance, reg | 0x80); // read transaction
         spiTransfer(bus->busdev_u.spi.instance, NULL, &data, 1);
         IOHi(bus->busdev_u.spi.csnPin);
+        spiBusUnlock(bus);
         return data;
     #endif
 }
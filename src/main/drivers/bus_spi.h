@@ -119,5 +119,38 @@ bool spiBusReadRegisterBuffer(const busDevice_t *bus, uint8_t reg, uint8_t *data
 uint8_t spiBusReadRegister(const busDevice_t *bus, uint8_t reg);
 void spiBusSetInstance(busDevice_t *bus, SPI_TypeDef *instance);
 
+#ifdef USE_SPI_DMA_READ
+// register byte plus the longest burst a sensor driver reads
+#define SPI_DMA_READ_MAX_LENGTH 16
+
+// called from the DMA interrupt once a transfer completes
+typedef void (*spiDmaCallbackFn)(void *arg);
+
+bool spiBusDmaInit(const busDevice_t *bus);
+// rxData may be NULL when the received bytes are not needed
+bool spiBusDmaTransferStart(const busDevice_t *bus, const uint8_t *txData, uint8_t *rxData, int length, spiDmaCallbackFn callbackFn, void *callbackArg);
+
+/*
+ * Register burst read that runs on the SPI DMA streams without the CPU waiting for the bus.
+ * Transfers complete into alternating buffers, so the latest sample stays intact while the next one is received.
+ */
+typedef struct spiDmaRead_s {
+    const busDevice_t *bus;
+    SPIDevice device;
+    uint8_t length;                                         // bytes on the wire, including the register byte
+    uint8_t txBuffer[SPI_DMA_READ_MAX_LENGTH];
+    uint8_t rxBuffer[2][SPI_DMA_READ_MAX_LENGTH];
+    volatile uint8_t writeIdx;                              // buffer owned by the DMA
+    volatile uint8_t readIdx;                               // last completed buffer
+    volatile bool dataReady;
+    spiDmaCallbackFn callbackFn;
+    void *callbackArg;
+} spiDmaRead_t;
+
+spiDmaRead_t *spiBusDmaReadInit(const busDevice_t *bus, uint8_t reg, uint8_t length, spiDmaCallbackFn callbackFn, void *callbackArg);
+bool spiBusDmaReadStart(spiDmaRead_t *dmaRead);
+const uint8_t *spiBusDmaReadData(spiDmaRead_t *dmaRead);
+#endif
+
 struct spiPinConfig_s;
 void spiPinConfigure(const struct spiPinConfig_s *pConfig);
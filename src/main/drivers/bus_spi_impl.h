@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "drivers/dma.h"
+
 #if defined(STM32F1) || defined(STM32F3) || defined(STM32F4)
 #define MAX_SPI_PIN_SEL 2
 #else
@@ -46,6 +48,11 @@ typedef struct spiHardware_s {
 #if defined(USE_HAL_DRIVER)
     uint8_t dmaIrqHandler;
 #endif
+#ifdef USE_SPI_DMA_READ
+    dmaIdentifier_e rxDmaIdentifier;
+    dmaIdentifier_e txDmaIdentifier;
+    uint8_t dmaChannel;
+#endif
 } spiHardware_t;
 
 extern const spiHardware_t spiHardware[];
@@ -70,9 +77,22 @@ typedef struct SPIDevice_s {
     DMA_HandleTypeDef hdma;
     uint8_t dmaIrqHandler;
 #endif
+#ifdef USE_SPI_DMA_READ
+    dmaIdentifier_e rxDmaIdentifier;
+    dmaIdentifier_e txDmaIdentifier;
+    uint8_t dmaChannel;
+    volatile bool dmaBusy;      // a DMA transfer owns the bus, set at start and cleared from the RX complete interrupt
+    volatile bool busLocked;    // a blocking transfer owns the bus, DMA transfers are refused meanwhile
+#endif
 } spiDevice_t;
 
 extern spiDevice_t spiDevice[SPIDEV_COUNT];
 
 void spiInitDevice(SPIDevice device);
 uint32_t spiTimeoutUserCallback(SPI_TypeDef *instance);
+
+#ifdef USE_SPI_DMA_READ
+bool spiDmaInit(SPIDevice device);
+void spiDmaTransferStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, int length);
+void spiDmaTransferComplete(SPIDevice device);
+#endif
@@ -162,6 +162,11 @@ const spiHardware_t spiHardware[] = {
         },
         .af = GPIO_AF_SPI1,
         .rcc = RCC_APB2(SPI1),
+#ifdef USE_SPI_DMA_READ
+        .rxDmaIdentifier = DMA2_ST0_HANDLER,
+        .txDmaIdentifier = DMA2_ST3_HANDLER,
+        .dmaChannel = 3,
+#endif
     },
     {
         .device = SPIDEV_2,
@@ -180,6 +185,11 @@ const spiHardware_t spiHardware[] = {
         },
         .af = GPIO_AF_SPI2,
         .rcc = RCC_APB1(SPI2),
+#ifdef USE_SPI_DMA_READ
+        .rxDmaIdentifier = DMA1_ST3_HANDLER,
+        .txDmaIdentifier = DMA1_ST4_HANDLER,
+        .dmaChannel = 0,
+#endif
     },
     {
         .device = SPIDEV_3,
@@ -198,6 +208,11 @@ const spiHardware_t spiHardware[] = {
         },
         .af = GPIO_AF_SPI3,
         .rcc = RCC_APB1(SPI3),
+#ifdef USE_SPI_DMA_READ
+        .rxDmaIdentifier = DMA1_ST0_HANDLER,
+        .txDmaIdentifier = DMA1_ST5_HANDLER,
+        .dmaChannel = 0,
+#endif
     },
 #endif
 #ifdef STM32F7
@@ -323,6 +338,11 @@ void spiPinConfigure(const spiPinConfig_t *pConfig)
             pDev->leadingEdge = false; // XXX Should be part of transfer context
 #ifdef USE_HAL_DRIVER
             pDev->dmaIrqHandler = hw->dmaIrqHandler;
+#endif
+#ifdef USE_SPI_DMA_READ
+            pDev->rxDmaIdentifier = hw->rxDmaIdentifier;
+            pDev->txDmaIdentifier = hw->txDmaIdentifier;
+            pDev->dmaChannel = hw->dmaChannel;
 #endif
         }
     }
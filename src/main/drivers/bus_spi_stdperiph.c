@@ -31,6 +31,7 @@
 #include "drivers/bus_spi_impl.h"
 #include "drivers/exti.h"
 #include "drivers/io.h"
+#include "drivers/nvic.h"
 #include "drivers/rcc.h"
 
 spiDevice_t spiDevice[SPIDEV_COUNT];
@@ -193,4 +194,104 @@ void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 
 #undef BR_BITS
 }
+
+#ifdef USE_SPI_DMA_READ
+static void spiDmaRxIrqHandler(dmaChannelDescriptor_t *descriptor)
+{
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        const SPIDevice device = descriptor->userParam;
+        spiDevice_t *spi = &spiDevice[device];
+
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF | DMA_IT_HTIF);
+        DMA_Cmd(descriptor->ref, DISABLE);
+        DMA_Cmd(dmaGetRefByIdentifier(spi->txDmaIdentifier), DISABLE);
+        SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+
+        spiDmaTransferComplete(device);
+    }
+}
+
+static bool spiDmaClaim(dmaIdentifier_e identifier, SPIDevice device)
+{
+    const resourceOwner_e owner = dmaGetOwner(identifier);
+    if (owner == OWNER_SPI_DMA) {
+        return dmaGetResourceIndex(identifier) == RESOURCE_INDEX(device);
+    }
+    return owner == OWNER_FREE;
+}
+
+bool spiDmaInit(SPIDevice device)
+{
+    spiDevice_t *spi = &spiDevice[device];
+
+    // streams already taken by another driver (motors, LED strip, UART) keep the bus on blocking transfers
+    if (!spi->rxDmaIdentifier || !spi->txDmaIdentifier
+        || !spiDmaClaim(spi->rxDmaIdentifier, device) || !spiDmaClaim(spi->txDmaIdentifier, device)) {
+        return false;
+    }
+
+    dmaInit(spi->rxDmaIdentifier, OWNER_SPI_DMA, RESOURCE_INDEX(device));
+    dmaInit(spi->txDmaIdentifier, OWNER_SPI_DMA, RESOURCE_INDEX(device));
+
+    DMA_Stream_TypeDef *rxStream = dmaGetRefByIdentifier(spi->rxDmaIdentifier);
+    DMA_Stream_TypeDef *txStream = dmaGetRefByIdentifier(spi->txDmaIdentifier);
+
+    DMA_InitTypeDef init;
+    DMA_StructInit(&init);
+    init.DMA_Channel = dmaGetChannel(spi->dmaChannel);
+    init.DMA_PeripheralBaseAddr = (uint32_t)&spi->dev->DR;
+    init.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    init.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    init.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    init.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    init.DMA_Mode = DMA_Mode_Normal;
+    init.DMA_FIFOMode = DMA_FIFOMode_Disable;
+
+    // memory address and length are set for every transfer
+    init.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    init.DMA_Priority = DMA_Priority_High;
+    DMA_DeInit(rxStream);
+    DMA_Init(rxStream, &init);
+
+    init.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    init.DMA_Priority = DMA_Priority_Medium;
+    DMA_DeInit(txStream);
+    DMA_Init(txStream, &init);
+
+    DMA_ITConfig(rxStream, DMA_IT_TC, ENABLE);
+    dmaSetHandler(spi->rxDmaIdentifier, spiDmaRxIrqHandler, NVIC_PRIO_SPI_DMA, device);
+
+    return true;
+}
+
+void spiDmaTransferStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, int length)
+{
+    spiDevice_t *spi = &spiDevice[device];
+    dmaChannelDescriptor_t *rxDma = dmaGetDescriptorByIdentifier(spi->rxDmaIdentifier);
+    dmaChannelDescriptor_t *txDma = dmaGetDescriptorByIdentifier(spi->txDmaIdentifier);
+
+    DMA_CLEAR_FLAG(rxDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+    DMA_CLEAR_FLAG(txDma, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+
+    // without a receive buffer every received byte goes to the same scratch byte
+    static uint8_t rxDiscard;
+    rxDma->ref->NDTR = length;
+    if (rxData) {
+        rxDma->ref->M0AR = (uint32_t)rxData;
+        rxDma->ref->CR |= DMA_SxCR_MINC;
+    } else {
+        rxDma->ref->M0AR = (uint32_t)&rxDiscard;
+        rxDma->ref->CR &= ~DMA_SxCR_MINC;
+    }
+    txDma->ref->NDTR = length;
+    txDma->ref->M0AR = (uint32_t)txData;
+
+    // discard a byte left over from a blocking transfer
+    spi->dev->DR;
+
+    DMA_Cmd(rxDma->ref, ENABLE);
+    DMA_Cmd(txDma->ref, ENABLE);
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+#endif
 #endif
@@ -0,0 +1,111 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_DSHOT_TELEMETRY
+
+#include "drivers/dshot_telemetry.h"
+
+#define GCR_FRAME_BITS  21
+
+// 5 bit GCR symbol to 4 bit nibble, unused symbols decode to 0 and are caught by the checksum
+static const uint8_t gcrDecode[32] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 9, 10, 11, 0, 13, 14, 15,
+    0, 0, 2, 3, 0, 5, 6, 7, 0, 0, 8, 1, 0, 4, 12, 0
+};
+
+/*
+ * Decodes a bidirectional dshot reply from the timer capture values of its edges.
+ *
+ * The reply is 21 bits sent NRZI style: every transition is a 1, and the first
+ * edge is the start bit. The 20 data bits are GCR encoded as four 5 bit symbols carrying
+ * 12 bits of eRPM period (3 bit exponent, 9 bit mantissa, in us) and a 4 bit checksum.
+ *
+ * Returns eRPM / 100, matching the units of escSensorData_t.rpm,
+ * or DSHOT_TELEMETRY_INVALID if the reply could not be decoded.
+ */
+uint16_t dshotDecodeTelemetryPacket(const uint32_t *buffer, uint32_t count)
+{
+    if (count == 0 || count >= DSHOT_TELEMETRY_INPUT_LEN) {
+        return DSHOT_TELEMETRY_INVALID;
+    }
+
+    uint32_t value = 0;
+    uint32_t previousEdge = buffer[0];
+    int bits = 0;
+
+    for (uint32_t i = 1; i <= count; i++) {
+        int len;
+        if (i < count) {
+            if (bits >= GCR_FRAME_BITS) {
+                break;
+            }
+            const uint16_t diff = buffer[i] - previousEdge;
+            len = (diff + DSHOT_TELEMETRY_BIT_TICKS / 2) / DSHOT_TELEMETRY_BIT_TICKS;
+            previousEdge = buffer[i];
+        } else {
+            // no edges follow the last transition, so the rest of the frame is implied
+            len = GCR_FRAME_BITS - bits;
+        }
+        if (len <= 0 || bits + len > GCR_FRAME_BITS) {
+            return DSHOT_TELEMETRY_INVALID;
+        }
+        value <<= len;
+        value |= 1 << (len - 1);
+        bits += len;
+    }
+
+    if (bits != GCR_FRAME_BITS) {
+        return DSHOT_TELEMETRY_INVALID;
+    }
+
+    uint32_t decodedValue = gcrDecode[value & 0x1f];
+    decodedValue |= gcrDecode[(value >> 5) & 0x1f] << 4;
+    decodedValue |= gcrDecode[(value >> 10) & 0x1f] << 8;
+    decodedValue |= gcrDecode[(value >> 15) & 0x1f] << 12;
+
+    uint32_t csum = decodedValue;
+    csum = csum ^ (csum >> 8); // xor bytes
+    csum = csum ^ (csum >> 4); // xor nibbles
+    if ((csum & 0xf) != 0xf) {
+        return DSHOT_TELEMETRY_INVALID;
+    }
+    decodedValue >>= 4;
+
+    if (decodedValue == 0x0fff) {
+        // longest representable period, the motor is stopped
+        return 0;
+    }
+
+    // eRPM period in us
+    const uint32_t period = (decodedValue & 0x1ff) << ((decodedValue & 0xe00) >> 9);
+    if (!period) {
+        return DSHOT_TELEMETRY_INVALID;
+    }
+
+    // 60e6 us per minute, in units of 100 eRPM
+    return (1000000 * 60 / 100 + period / 2) / period;
+}
+
+#endif // USE_DSHOT_TELEMETRY
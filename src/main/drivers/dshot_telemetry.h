@@ -0,0 +1,28 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define DSHOT_TELEMETRY_INPUT_LEN       32      // captured edges per reply, a valid reply has at most 21
+#define DSHOT_TELEMETRY_BIT_TICKS       16      // reply bit length in output timer ticks, replies are sent at 5/4 of the command bitrate
+#define DSHOT_TELEMETRY_INVALID         0xffff
+#define DSHOT_TELEMETRY_TIMEOUT_FRAMES  100     // consecutive bad replies before a motor's telemetry is considered lost
+
+uint16_t dshotDecodeTelemetryPacket(const uint32_t *buffer, uint32_t count);
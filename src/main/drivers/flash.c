@@ -70,6 +70,7 @@ bool flashInit(const flashConfig_t *flashConfig)
 #endif
 
     flashDevice.busdev = busdev;
+    flashDevice.useSpiDma = flashConfig->spiDma;
 
     const uint8_t out[] = { SPIFLASH_INSTRUCTION_RDID, 0, 0, 0 };
 
@@ -129,9 +130,9 @@ void flashPageProgramBegin(uint32_t address)
     flashDevice.vTable->pageProgramBegin(&flashDevice, address);
 }
 
-void flashPageProgramContinue(const uint8_t *data, int length)
+int flashPageProgramContinue(const uint8_t *data, int length)
 {
-    flashDevice.vTable->pageProgramContinue(&flashDevice, data, length);
+    return flashDevice.vTable->pageProgramContinue(&flashDevice, data, length);
 }
 
 void flashPageProgramFinish(void)
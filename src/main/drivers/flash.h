@@ -52,7 +52,7 @@ bool flashWaitForReady(uint32_t timeoutMillis);
 void flashEraseSector(uint32_t address);
 void flashEraseCompletely(void);
 void flashPageProgramBegin(uint32_t address);
-void flashPageProgramContinue(const uint8_t *data, int length);
+int flashPageProgramContinue(const uint8_t *data, int length);
 void flashPageProgramFinish(void);
 void flashPageProgram(uint32_t address, const uint8_t *data, int length);
 int flashReadBytes(uint32_t address, uint8_t *buffer, int length);
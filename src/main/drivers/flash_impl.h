@@ -38,6 +38,7 @@ typedef struct flashDevice_s {
     // for writes. This allows us to avoid polling for writable status
     // when it is definitely ready already.
     bool couldBeBusy;
+    bool useSpiDma; // page programs are sent by the SPI DMA, set before detection
 } flashDevice_t;
 
 typedef struct flashVTable_s {
@@ -46,7 +47,7 @@ typedef struct flashVTable_s {
     void (*eraseSector)(flashDevice_t *fdevice, uint32_t address);
     void (*eraseCompletely)(flashDevice_t *fdevice);
     void (*pageProgramBegin)(flashDevice_t *fdevice, uint32_t address);
-    void (*pageProgramContinue)(flashDevice_t *fdevice, const uint8_t *data, int length);
+    int (*pageProgramContinue)(flashDevice_t *fdevice, const uint8_t *data, int length);
     void (*pageProgramFinish)(flashDevice_t *fdevice);
     void (*pageProgram)(flashDevice_t *fdevice, uint32_t address, const uint8_t *data, int length);
     void (*flush)(flashDevice_t *fdevice);
@@ -20,11 +20,14 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
 #include "build/debug.h"
 
+#include "common/maths.h"
+
 #ifdef USE_FLASH_M25P16
 
 #include "drivers/bus_spi.h"
@@ -77,8 +80,26 @@
 
 STATIC_ASSERT(M25P16_PAGESIZE < FLASH_MAX_PAGE_SIZE, M25P16_PAGESIZE_too_small);
 
+#define M25P16_PAGE_PROGRAM_HEADER_SIZE 5 // instruction plus the long address
+
 const flashVTable_t m25p16_vTable;
 
+#ifdef USE_FLASH_SPI_DMA
+/*
+ * Page programs are assembled in one buffer while the other is sent by the DMA, the chip is programmed once the
+ * transfer completes and releases the chip select. Not in FAST_RAM, the F4 CCM is not reachable by the DMA controllers.
+ * A page finished while the chip is still busy waits in its buffer and is sent by the next m25p16_isReady() that
+ * finds the chip ready.
+ */
+static uint8_t pageBuffers[2][M25P16_PAGE_PROGRAM_HEADER_SIZE + M25P16_PAGESIZE];
+static uint8_t pageBufferIdx;       // buffer being filled
+static int pageBufferLength;
+static int pageProgramPendingLength; // length of the page waiting in the other buffer, 0 if none
+static volatile bool pageProgramDmaBusy;
+
+static void m25p16_pageProgramDmaStart(flashDevice_t *fdevice, uint8_t *buf, int length);
+#endif
+
 static void m25p16_disable(busDevice_t *bus)
 {
     IOHi(bus->busdev_u.spi.csnPin);
@@ -134,9 +155,25 @@ static uint8_t m25p16_readStatus(busDevice_t *bus)
 
 static bool m25p16_isReady(flashDevice_t *fdevice)
 {
+#ifdef USE_FLASH_SPI_DMA
+    // the bus is not ours until the page program transfer completes
+    if (pageProgramDmaBusy) {
+        return false;
+    }
+#endif
+
     // If couldBeBusy is false, don't bother to poll the flash chip for its status
     fdevice->couldBeBusy = fdevice->couldBeBusy && ((m25p16_readStatus(fdevice->busdev) & M25P16_STATUS_FLAG_WRITE_IN_PROGRESS) != 0);
 
+#ifdef USE_FLASH_SPI_DMA
+    if (pageProgramPendingLength && !fdevice->couldBeBusy) {
+        const int length = pageProgramPendingLength;
+        pageProgramPendingLength = 0;
+        m25p16_pageProgramDmaStart(fdevice, pageBuffers[pageBufferIdx ^ 1], length);
+        return false;
+    }
+#endif
+
     return !fdevice->couldBeBusy;
 }
 
@@ -209,6 +246,9 @@ bool m25p16_detect(flashDevice_t *fdevice, uint32_t chipID)
 
     fdevice->couldBeBusy = true; // Just for luck we'll assume the chip could be busy even though it isn't specced to be
     fdevice->vTable = &m25p16_vTable;
+#ifdef USE_FLASH_SPI_DMA
+    fdevice->useSpiDma = fdevice->useSpiDma && spiBusDmaInit(fdevice->busdev);
+#endif
     return true;
 }
 
@@ -247,15 +287,62 @@ static void m25p16_eraseCompletely(flashDevice_t *fdevice)
     m25p16_performOneByteCommand(fdevice->busdev, M25P16_INSTRUCTION_BULK_ERASE);
 }
 
+#ifdef USE_FLASH_SPI_DMA
+static void m25p16_pageProgramDmaComplete(void *arg)
+{
+    UNUSED(arg);
+
+    pageProgramDmaBusy = false;
+}
+
+static void m25p16_pageProgramDmaStart(flashDevice_t *fdevice, uint8_t *buf, int length)
+{
+    m25p16_writeEnable(fdevice);
+
+    pageProgramDmaBusy = true;
+    if (!spiBusDmaTransferStart(fdevice->busdev, buf, NULL, length, m25p16_pageProgramDmaComplete, NULL)) {
+        pageProgramDmaBusy = false;
+        m25p16_transfer(fdevice->busdev, buf, NULL, length);
+    }
+}
+#endif
+
 static void m25p16_pageProgramBegin(flashDevice_t *fdevice, uint32_t address)
 {
-    UNUSED(fdevice);
+#ifdef USE_FLASH_SPI_DMA
+    if (fdevice->useSpiDma) {
+        // a page still waiting for the chip holds the other buffer, the next one can't be finished before it is sent
+        if (pageProgramPendingLength) {
+            m25p16_waitForReady(fdevice, DEFAULT_TIMEOUT_MILLIS);
+        }
+        uint8_t *buf = pageBuffers[pageBufferIdx];
+        buf[0] = M25P16_INSTRUCTION_PAGE_PROGRAM;
+        m25p16_setCommandAddress(&buf[1], address, fdevice->isLargeFlash);
+        pageBufferLength = fdevice->isLargeFlash ? 5 : 4;
+    }
+#endif
 
     fdevice->currentWriteAddress = address;
 }
 
-static void m25p16_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, int length)
+/**
+ * Returns the number of bytes accepted, which is less than length only if the data would overrun the page.
+ */
+static int m25p16_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, int length)
 {
+#ifdef USE_FLASH_SPI_DMA
+    // the data is sent as one transfer when the program finishes
+    if (fdevice->useSpiDma) {
+        // the buffer has room for the longer header of a large flash, the data itself must stay within one page
+        const int headerLength = fdevice->isLargeFlash ? 5 : 4;
+        length = MIN(length, headerLength + M25P16_PAGESIZE - pageBufferLength);
+        memcpy(&pageBuffers[pageBufferIdx][pageBufferLength], data, length);
+        pageBufferLength += length;
+        fdevice->currentWriteAddress += length;
+        return length;
+    }
+#endif
+
     uint8_t command[5] = { M25P16_INSTRUCTION_PAGE_PROGRAM };
 
     m25p16_setCommandAddress(&command[1], fdevice->currentWriteAddress, fdevice->isLargeFlash);
@@ -273,11 +360,26 @@ static void m25p16_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *da
     m25p16_disable(fdevice->busdev);
 
     fdevice->currentWriteAddress += length;
+
+    return length;
 }
 
 static void m25p16_pageProgramFinish(flashDevice_t *fdevice)
 {
+#ifdef USE_FLASH_SPI_DMA
+    if (fdevice->useSpiDma) {
+        // doesn't wait for the previous page, if the chip is still busy the page is sent once it is ready
+        if (m25p16_isReady(fdevice)) {
+            m25p16_pageProgramDmaStart(fdevice, pageBuffers[pageBufferIdx], pageBufferLength);
+        } else {
+            pageProgramPendingLength = pageBufferLength;
+        }
+
+        pageBufferIdx ^= 1;
+    }
+#else
     UNUSED(fdevice);
+#endif
 }
 
 /**
@@ -287,7 +389,8 @@ static void m25p16_pageProgramFinish(flashDevice_t *fdevice)
  *
  * Length must be smaller than the page size.
  *
- * This will wait for the flash to become ready before writing begins.
+ * This will wait for the flash to become ready before writing begins. With the SPI DMA the page is sent once the
+ * flash is ready instead, only a second page finished before the first was sent waits.
  *
  * Datasheet indicates typical programming time is 0.8ms for 256 bytes, 0.2ms for 64 bytes, 0.05ms for 16 bytes.
  * (Although the maximum possible write time is noted as 5ms).
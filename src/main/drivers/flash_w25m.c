@@ -169,11 +169,11 @@ void w25m_pageProgramBegin(flashDevice_t *fdevice, uint32_t address)
     dieDevice[currentWriteDie].vTable->pageProgramBegin(&dieDevice[currentWriteDie], currentWriteAddress);
 }
 
-void w25m_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, int length)
+int w25m_pageProgramContinue(flashDevice_t *fdevice, const uint8_t *data, int length)
 {
     UNUSED(fdevice);
 
-    dieDevice[currentWriteDie].vTable->pageProgramContinue(&dieDevice[currentWriteDie], data, length);
+    return dieDevice[currentWriteDie].vTable->pageProgramContinue(&dieDevice[currentWriteDie], data, length);
 }
 
 void w25m_pageProgramFinish(flashDevice_t *fdevice)
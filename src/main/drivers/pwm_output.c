@@ -67,6 +67,9 @@ static bool isDshot = false;
 #ifdef USE_DSHOT_DMAR
 FAST_RAM_ZERO_INIT bool useBurstDshot = false;
 #endif
+#ifdef USE_DSHOT_TELEMETRY
+FAST_RAM_ZERO_INIT bool useDshotTelemetry = false;
+#endif
 
 static void pwmOCConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t value, uint8_t output)
 {
@@ -284,6 +287,15 @@ void motorDevInit(const motorDevConfig_t *motorConfig, uint16_t idlePulse, uint8
         if (motorConfig->useBurstDshot) {
             useBurstDshot = true;
         }
+#endif
+#ifdef USE_DSHOT_TELEMETRY
+        if (motorConfig->useDshotTelemetry) {
+            // replies are captured per channel, which the burst transfer cannot do
+            useDshotTelemetry = true;
+#ifdef USE_DSHOT_DMAR
+            useBurstDshot = false;
+#endif
+        }
 #endif
         break;
 #endif
@@ -311,10 +323,17 @@ void motorDevInit(const motorDevConfig_t *motorConfig, uint16_t idlePulse, uint8
 
 #ifdef USE_DSHOT
         if (isDshot) {
+            uint8_t output = motorConfig->motorPwmInversion ? timerHardware->output ^ TIMER_OUTPUT_INVERTED : timerHardware->output;
+#ifdef USE_DSHOT_TELEMETRY
+            // bidirectional dshot idles high so the ESC can pull the line low to reply
+            if (useDshotTelemetry) {
+                output ^= TIMER_OUTPUT_INVERTED;
+            }
+#endif
             pwmDshotMotorHardwareConfig(timerHardware,
                 motorIndex,
                 motorConfig->motorPwmProtocol,
-                motorConfig->motorPwmInversion ? timerHardware->output ^ TIMER_OUTPUT_INVERTED : timerHardware->output);
+                output);
             motors[motorIndex].enabled = true;
             continue;
         }
@@ -527,6 +546,12 @@ FAST_CODE uint16_t prepareDshotPacket(motorDmaOutput_t *const motor)
         csum ^=  csum_data;   // xor data by nibbles
         csum_data >>= 4;
     }
+#ifdef USE_DSHOT_TELEMETRY
+    // an inverted checksum tells the ESC to reply with eRPM telemetry
+    if (useDshotTelemetry) {
+        csum = ~csum;
+    }
+#endif
     csum &= 0xf;
     // append checksum
     packet = (packet << 4) | csum;
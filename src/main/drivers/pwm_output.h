@@ -22,6 +22,7 @@
 
 #include "platform.h"
 
+#include "drivers/dshot_telemetry.h"
 #include "drivers/io_types.h"
 #include "drivers/pwm_output_counts.h"
 #include "drivers/timer.h"
@@ -139,6 +140,17 @@ typedef struct {
 #else
     uint8_t dmaBuffer[DSHOT_DMA_BUFFER_SIZE];
 #endif
+#ifdef USE_DSHOT_TELEMETRY
+    volatile bool isInput;                  // line is currently capturing the ESC reply
+    volatile uint8_t dmaInputLen;           // number of edges captured in the last reply window
+    uint8_t dshotTelemetryBadFrames;
+    volatile bool dshotTelemetryActive;
+    volatile uint16_t dshotTelemetryValue;  // eRPM / 100
+    TIM_OCInitTypeDef ocInitStruct;
+    TIM_ICInitTypeDef icInitStruct;
+    DMA_InitTypeDef dmaInitStruct;
+    uint32_t dmaInputBuffer[DSHOT_TELEMETRY_INPUT_LEN];
+#endif
 } motorDmaOutput_t;
 
 motorDmaOutput_t *getMotorDmaOutput(uint8_t index);
@@ -168,10 +180,14 @@ typedef struct motorDevConfig_s {
     uint8_t  motorPwmInversion;             // Active-High vs Active-Low. Useful for brushed FCs converted for brushless operation
     uint8_t  useUnsyncedPwm;
     uint8_t  useBurstDshot;
+    uint8_t  useDshotTelemetry;
     ioTag_t  ioTags[MAX_SUPPORTED_MOTORS];
 } motorDevConfig_t;
 
 extern bool useBurstDshot;
+#ifdef USE_DSHOT_TELEMETRY
+extern bool useDshotTelemetry;
+#endif
 
 void motorDevInit(const motorDevConfig_t *motorDevConfig, uint16_t idlePulse, uint8_t motorCount);
 
@@ -207,6 +223,11 @@ bool pwmDshotCommandIsProcessing(void);
 uint8_t pwmGetDshotCommand(uint8_t index);
 bool pwmDshotCommandOutputIsEnabled(uint8_t motorCount);
 
+#ifdef USE_DSHOT_TELEMETRY
+uint16_t getDshotTelemetry(uint8_t index);
+bool isDshotMotorTelemetryActive(uint8_t index);
+#endif
+
 #endif
 
 #ifdef USE_BEEPER
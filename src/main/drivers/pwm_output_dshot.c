@@ -50,6 +50,86 @@ motorDmaOutput_t *getMotorDmaOutput(uint8_t index)
     return &dmaMotors[index];
 }
 
+#ifdef USE_DSHOT_TELEMETRY
+static bool motorHasTelemetry(const motorDmaOutput_t *motor)
+{
+    // complementary outputs cannot be switched to input capture
+    return useDshotTelemetry && !(motor->timerHardware->output & TIMER_OUTPUT_N_CHANNEL);
+}
+
+uint16_t getDshotTelemetry(uint8_t index)
+{
+    return dmaMotors[index].dshotTelemetryValue;
+}
+
+bool isDshotMotorTelemetryActive(uint8_t index)
+{
+    return dmaMotors[index].dshotTelemetryActive;
+}
+
+static void pwmDshotSetDirectionOutput(motorDmaOutput_t * const motor)
+{
+    const timerHardware_t * const timerHardware = motor->timerHardware;
+    TIM_TypeDef *timer = timerHardware->tim;
+
+    DMA_DeInit(timerHardware->dmaRef);
+
+    motor->isInput = false;
+    timerOCPreloadConfig(timer, timerHardware->channel, TIM_OCPreload_Disable);
+    timerOCInit(timer, timerHardware->channel, &motor->ocInitStruct);
+    timerOCPreloadConfig(timer, timerHardware->channel, TIM_OCPreload_Enable);
+    timer->ARR = MOTOR_BITLENGTH;
+
+    motor->dmaInitStruct.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+    motor->dmaInitStruct.DMA_Memory0BaseAddr = (uint32_t)motor->dmaBuffer;
+    motor->dmaInitStruct.DMA_BufferSize = DSHOT_DMA_BUFFER_SIZE;
+    DMA_Init(timerHardware->dmaRef, &motor->dmaInitStruct);
+    DMA_ITConfig(timerHardware->dmaRef, DMA_IT_TC, ENABLE);
+}
+
+static void pwmDshotSetDirectionInput(motorDmaOutput_t * const motor)
+{
+    const timerHardware_t * const timerHardware = motor->timerHardware;
+    TIM_TypeDef *timer = timerHardware->tim;
+
+    DMA_DeInit(timerHardware->dmaRef);
+
+    motor->isInput = true;
+    // let the counter run freely so edge captures never wrap inside a reply
+    timer->ARR = 0xffffffff;
+    TIM_ICInit(timer, &motor->icInitStruct);
+
+    motor->dmaInitStruct.DMA_DIR = DMA_DIR_PeripheralToMemory;
+    motor->dmaInitStruct.DMA_Memory0BaseAddr = (uint32_t)motor->dmaInputBuffer;
+    motor->dmaInitStruct.DMA_BufferSize = DSHOT_TELEMETRY_INPUT_LEN;
+    DMA_Init(timerHardware->dmaRef, &motor->dmaInitStruct);
+    DMA_ITConfig(timerHardware->dmaRef, DMA_IT_TC, ENABLE);
+
+    DMA_Cmd(timerHardware->dmaRef, ENABLE);
+    TIM_DMACmd(timer, motor->timerDmaSource, ENABLE);
+}
+
+static void pwmDshotDecodeTelemetry(motorDmaOutput_t * const motor, uint8_t motorIndex)
+{
+    const uint16_t value = dshotDecodeTelemetryPacket(motor->dmaInputBuffer, motor->dmaInputLen);
+    motor->dmaInputLen = 0;
+
+    if (value != DSHOT_TELEMETRY_INVALID) {
+        motor->dshotTelemetryValue = value;
+        motor->dshotTelemetryActive = true;
+        motor->dshotTelemetryBadFrames = 0;
+        if (motorIndex < 4) {
+            DEBUG_SET(DEBUG_DSHOT_RPM_TELEMETRY, motorIndex, value);
+        }
+    } else if (motor->dshotTelemetryBadFrames < DSHOT_TELEMETRY_TIMEOUT_FRAMES) {
+        motor->dshotTelemetryBadFrames++;
+    } else {
+        motor->dshotTelemetryActive = false;
+    }
+}
+#endif
+
+
 uint8_t getTimerIndex(TIM_TypeDef *timer)
 {
     for (int i = 0; i < dmaMotorTimerCount; i++) {
@@ -69,6 +149,16 @@ void pwmWriteDshotInt(uint8_t index, uint16_t value)
         return;
     }
 
+#ifdef USE_DSHOT_TELEMETRY
+    if (motor->isInput) {
+        // close the reply window, the captured edges are decoded once the next frame has been sent
+        motor->dmaInputLen = DSHOT_TELEMETRY_INPUT_LEN - DMA_GetCurrDataCounter(motor->timerHardware->dmaRef);
+        TIM_DMACmd(motor->timerHardware->tim, motor->timerDmaSource, DISABLE);
+        DMA_Cmd(motor->timerHardware->dmaRef, DISABLE);
+        pwmDshotSetDirectionOutput(motor);
+    }
+#endif
+
     /*If there is a command ready to go overwrite the value and send that instead*/
     if (pwmDshotCommandIsProcessing()) {
         value = pwmGetDshotCommand(index);
@@ -129,6 +219,16 @@ static void motor_DMA_IRQHandler(dmaChannelDescriptor_t *descriptor)
     if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
         motorDmaOutput_t * const motor = &dmaMotors[descriptor->userParam];
 
+#ifdef USE_DSHOT_TELEMETRY
+        if (motor->isInput) {
+            // more edges than any valid reply has, stop capturing and let the decoder reject it
+            DMA_Cmd(motor->timerHardware->dmaRef, DISABLE);
+            TIM_DMACmd(motor->timerHardware->tim, motor->timerDmaSource, DISABLE);
+            DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+            return;
+        }
+#endif
+
 #ifdef USE_DSHOT_DMAR
         if (useBurstDshot) {
             DMA_Cmd(motor->timerHardware->dmaTimUPRef, DISABLE);
@@ -141,6 +241,14 @@ static void motor_DMA_IRQHandler(dmaChannelDescriptor_t *descriptor)
         }
 
         DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+#ifdef USE_DSHOT_TELEMETRY
+        // the frame is out, decode the previous reply and listen for the next one
+        if (motorHasTelemetry(motor)) {
+            pwmDshotDecodeTelemetry(motor, descriptor->userParam);
+            pwmDshotSetDirectionInput(motor);
+        }
+#endif
     }
 }
 
@@ -216,6 +324,16 @@ void pwmDshotMotorHardwareConfig(const timerHardware_t *timerHardware, uint8_t m
     timerOCInit(timer, timerHardware->channel, &TIM_OCInitStructure);
     timerOCPreloadConfig(timer, timerHardware->channel, TIM_OCPreload_Enable);
 
+#ifdef USE_DSHOT_TELEMETRY
+    motor->ocInitStruct = TIM_OCInitStructure;
+    TIM_ICStructInit(&motor->icInitStruct);
+    motor->icInitStruct.TIM_Channel = timerHardware->channel;
+    motor->icInitStruct.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    motor->icInitStruct.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    motor->icInitStruct.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    motor->icInitStruct.TIM_ICFilter = 2;
+#endif
+
     if (output & TIMER_OUTPUT_N_CHANNEL) {
         TIM_CCxNCmd(timer, timerHardware->channel, TIM_CCxN_Enable);
     } else {
@@ -305,6 +423,10 @@ void pwmDshotMotorHardwareConfig(const timerHardware_t *timerHardware, uint8_t m
 
     // XXX Consolidate common settings in the next refactor
 
+#ifdef USE_DSHOT_TELEMETRY
+    // kept to switch the stream between sending frames and capturing replies
+    motor->dmaInitStruct = DMA_InitStructure;
+#endif
     DMA_Init(dmaRef, &DMA_InitStructure);
     DMA_ITConfig(dmaRef, DMA_IT_TC, ENABLE);
 
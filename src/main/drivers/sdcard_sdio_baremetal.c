@@ -643,6 +643,19 @@ sdcardOperationStatus_e sdcard_beginWriteBlocks(uint32_t blockIndex, uint32_t bl
     return SDCARD_OPERATION_SUCCESS;
 }
 
+/**
+ * Returns true if a multi-block write is open and waiting for its next block, whose index is stored in blockIndex.
+ * Writing any other block or reading ends the multi-block write.
+ */
+bool sdcard_getMultiWriteNextBlock(uint32_t *blockIndex)
+{
+    if (sdcard.state != SDCARD_STATE_WRITING_MULTIPLE_BLOCKS) {
+        return false;
+    }
+    *blockIndex = sdcard.multiWriteNextBlock;
+    return true;
+}
+
 /**
  * Read the 512-byte block with the given index into the given 512-byte buffer.
  *
@@ -107,6 +107,26 @@ void serialSetBaudRateCb(serialPort_t *serialPort, void (*cb)(serialPort_t *cont
     }
 }
 
+bool serialSetRxFrameCallback(serialPort_t *instance, serialReceiveFrameCallbackPtr cb)
+{
+    // If the underlying driver can find the end of a frame then it calls cb with each frame, otherwise the
+    // receive callback the port was opened with stays in use.
+    if (instance->vTable->setRxFrameCallback) {
+        return instance->vTable->setRxFrameCallback(instance, cb);
+    }
+    return false;
+}
+
+bool serialWriteFrame(serialPort_t *instance, const uint8_t *data, int count, serialTxFrameDoneCallbackPtr doneCb, void *doneData)
+{
+    // If the underlying driver accepts the frame it sends it straight from data, which must not change until
+    // doneCb is called. Otherwise the caller still owns data and has to write it some other way.
+    if (instance->vTable->writeFrame) {
+        return instance->vTable->writeFrame(instance, data, count, doneCb, doneData);
+    }
+    return false;
+}
+
 void serialWriteBufShim(void *instance, const uint8_t *data, int count)
 {
     serialWriteBuf((serialPort_t *)instance, data, count);
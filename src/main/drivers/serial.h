@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "common/time.h"
 #include "drivers/io.h"
 #include "pg/pg.h"
 
@@ -56,6 +57,10 @@ typedef enum {
 #define CTRL_LINE_STATE_RTS (1 << 1)
 
 typedef void (*serialReceiveCallbackPtr)(uint16_t data, void *rxCallbackData);   // used by serial drivers to return frames to app
+// used by serial drivers that detect the end of a frame by an idle line, frameTimeUs is when the line went idle
+typedef void (*serialReceiveFrameCallbackPtr)(const uint8_t *data, int length, timeUs_t frameTimeUs, void *rxCallbackData);
+// used by serial drivers that send a frame from the caller's buffer, called once the buffer may be reused
+typedef void (*serialTxFrameDoneCallbackPtr)(void *doneData);
 
 typedef struct serialPort_s {
 
@@ -76,6 +81,7 @@ typedef struct serialPort_s {
     uint32_t txBufferTail;
 
     serialReceiveCallbackPtr rxCallback;
+    serialReceiveFrameCallbackPtr rxFrameCallback;
     void *rxCallbackData;
 
     uint8_t identifier;
@@ -120,6 +126,12 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+
+    // Optional, receive whole frames instead of bytes. Returns false if the port can't detect the end of a frame.
+    bool (*setRxFrameCallback)(serialPort_t *instance, serialReceiveFrameCallbackPtr cb);
+
+    // Optional, send a frame without copying it. Returns false if the port can't take it now.
+    bool (*writeFrame)(serialPort_t *instance, const uint8_t *data, int count, serialTxFrameDoneCallbackPtr doneCb, void *doneData);
 };
 
 void serialWrite(serialPort_t *instance, uint8_t ch);
@@ -131,6 +143,8 @@ void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate);
 void serialSetMode(serialPort_t *instance, portMode_e mode);
 void serialSetCtrlLineStateCb(serialPort_t *instance, void (*cb)(void *context, uint16_t ctrlLineState), void *context);
 void serialSetBaudRateCb(serialPort_t *instance, void (*cb)(serialPort_t *context, uint32_t baud), serialPort_t *context);
+bool serialSetRxFrameCallback(serialPort_t *instance, serialReceiveFrameCallbackPtr cb);
+bool serialWriteFrame(serialPort_t *instance, const uint8_t *data, int count, serialTxFrameDoneCallbackPtr doneCb, void *doneData);
 bool isSerialTransmitBufferEmpty(const serialPort_t *instance);
 void serialPrint(serialPort_t *instance, const char *str);
 uint32_t serialGetBaudRate(serialPort_t *instance);
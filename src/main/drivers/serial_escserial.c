@@ -849,7 +849,9 @@ const struct serialPortVTable escSerialVTable[] = {
         .setBaudRateCb = NULL,
         .writeBuf = NULL,
         .beginWrite = NULL,
-        .endWrite = NULL
+        .endWrite = NULL,
+        .setRxFrameCallback = NULL,
+        .writeFrame = NULL
     }
 };
 
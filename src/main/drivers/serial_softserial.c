@@ -642,7 +642,9 @@ static const struct serialPortVTable softSerialVTable = {
     .setBaudRateCb = NULL,
     .writeBuf = NULL,
     .beginWrite = NULL,
-    .endWrite = NULL
+    .endWrite = NULL,
+    .setRxFrameCallback = NULL,
+    .writeFrame = NULL
 };
 
 #endif
@@ -271,4 +271,6 @@ static const struct serialPortVTable tcpVTable = {
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .setRxFrameCallback = NULL,
+        .writeFrame = NULL,
 };
@@ -27,6 +27,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -39,6 +40,7 @@
 #include "drivers/inverter.h"
 #include "drivers/nvic.h"
 #include "drivers/rcc.h"
+#include "drivers/time.h"
 
 #include "drivers/serial.h"
 #include "drivers/serial_uart.h"
@@ -80,6 +82,20 @@ void uartTryStartTxDMA(uartPort_t *s)
 
         // DMA_Cmd(s->txDMAStream, DISABLE); // XXX It's already disabled.
 
+        if (s->txFrameActive) {
+            s->txFrameActive = false;
+            uartReleaseTxFrame(s);
+        }
+
+        if (s->txFrame) {
+            // A frame sent by reference goes out before anything written to the buffer after it
+            DMA_MemoryTargetConfig(s->txDMAStream, (uint32_t)s->txFrame, DMA_Memory_0);
+            s->txDMAStream->NDTR = s->txFrameLength;
+            s->txFrameActive = true;
+            s->txDMAEmpty = false;
+            goto reenable;
+        }
+
         if (s->port.txBufferHead == s->port.txBufferTail) {
             // No more data to transmit.
             s->txDMAEmpty = true;
@@ -117,6 +133,20 @@ void uartTryStartTxDMA(uartPort_t *s)
             goto reenable;
         }
 
+        if (s->txFrameActive) {
+            s->txFrameActive = false;
+            uartReleaseTxFrame(s);
+        }
+
+        if (s->txFrame) {
+            // A frame sent by reference goes out before anything written to the buffer after it
+            s->txDMAChannel->CMAR = (uint32_t)s->txFrame;
+            s->txDMAChannel->CNDTR = s->txFrameLength;
+            s->txFrameActive = true;
+            s->txDMAEmpty = false;
+            goto reenable;
+        }
+
         if (s->port.txBufferHead == s->port.txBufferTail) {
             // No more data to transmit.
             s->txDMAEmpty = true;
@@ -141,6 +171,16 @@ void uartTryStartTxDMA(uartPort_t *s)
     }
 }
 
+// Hands a frame sent by reference back to its owner
+void uartReleaseTxFrame(uartPort_t *s)
+{
+    if (s->txFrame) {
+        s->txFrame = NULL;
+        s->txFrameActive = false;
+        s->txFrameDoneCb(s->txFrameDoneData);
+    }
+}
+
 static uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t*)instance;
@@ -198,7 +238,8 @@ static uint32_t uartTotalTxBytesFree(const serialPort_t *instance)
          * than the total Tx buffer size, because we'll end up transmitting the same buffer region twice. (So we'll be
          * transmitting a garbage mixture of old and new bytes).
          *
-         * Be kind to callers and pretend like our buffer can only ever be 100% full.
+         * Be kind to callers and pretend like our buffer can only ever be 100% full. A frame sent by reference
+         * counts here too, which holds writers back until it has gone out.
          */
         if (bytesUsed >= s->port.txBufferSize - 1) {
             return 0;
@@ -246,6 +287,20 @@ static uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
+static void uartStartTx(uartPort_t *s)
+{
+#ifdef STM32F4
+    if (s->txDMAStream)
+#else
+    if (s->txDMAChannel)
+#endif
+    {
+        uartTryStartTxDMA(s);
+    } else {
+        USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+    }
+}
+
 static void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
@@ -256,15 +311,112 @@ static void uartWrite(serialPort_t *instance, uint8_t ch)
         s->port.txBufferHead++;
     }
 
+    uartStartTx(s);
+}
+
+// Queues the block and starts the transmission once, waits for space like the generic serialWriteBuf()
+static void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        uint32_t bytesFree = uartTotalTxBytesFree(instance);
+        for (; bytesFree > 0 && count > 0; bytesFree--, count--) {
+            s->port.txBuffer[s->port.txBufferHead] = *p++;
+            if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
+                s->port.txBufferHead = 0;
+            } else {
+                s->port.txBufferHead++;
+            }
+        }
+
+        uartStartTx(s);
+    }
+}
+
+// Transmits the frame by DMA from the caller's buffer, once everything queued before it has been sent
+static bool uartWriteFrame(serialPort_t *instance, const uint8_t *data, int count, serialTxFrameDoneCallbackPtr doneCb, void *doneData)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+#ifdef STM32F4
+    if (!s->txDMAStream) {
+#else
+    if (!s->txDMAChannel) {
+#endif
+        return false;
+    }
+
+    // Only one frame at a time, and the transmit buffer must be empty so nothing is sent out of order
+    if (s->txFrame || !s->txDMAEmpty || s->port.txBufferHead != s->port.txBufferTail || count <= 0 || count > UINT16_MAX) {
+        return false;
+    }
+
+    s->txFrameDoneCb = doneCb;
+    s->txFrameDoneData = doneData;
+    s->txFrameLength = count;
+    s->txFrame = data;
+
+    uartTryStartTxDMA(s);
+
+    return true;
+}
+
+// Receiving by DMA, the idle line interrupt marks the end of each frame in place of an interrupt for every byte
+static bool uartSetRxFrameCallback(serialPort_t *instance, serialReceiveFrameCallbackPtr cb)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
 #ifdef STM32F4
-    if (s->txDMAStream)
+    if (!s->rxDMAStream || !(s->port.mode & MODE_RX)) {
 #else
-    if (s->txDMAChannel)
+    if (!s->rxDMAChannel || !(s->port.mode & MODE_RX)) {
 #endif
-    {
-        uartTryStartTxDMA(s);
-    } else {
-        USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+        return false;
+    }
+
+    // Whatever is in the buffer already is not a whole frame
+#ifdef STM32F4
+    s->rxDMAPos = DMA_GetCurrDataCounter(s->rxDMAStream);
+#else
+    s->rxDMAPos = DMA_GetCurrDataCounter(s->rxDMAChannel);
+#endif
+    s->port.rxFrameCallback = cb;
+    USART_ITConfig(s->USARTx, USART_IT_IDLE, cb ? ENABLE : DISABLE);
+
+    return true;
+}
+
+// Called by the UART ISR once the idle line flag has been cleared
+void uartRxIdleHandler(uartPort_t *s)
+{
+    if (!s->port.rxFrameCallback) {
+        return;
+    }
+
+    const timeUs_t frameTimeUs = micros();
+#ifdef STM32F4
+    const uint32_t rxDMAHead = s->rxDMAStream->NDTR;
+#else
+    const uint32_t rxDMAHead = s->rxDMAChannel->CNDTR;
+#endif
+
+    // The DMA counters count down, so these are the buffer indexes of the frame start and of the next byte
+    const uint32_t frameStart = (s->port.rxBufferSize - s->rxDMAPos) % s->port.rxBufferSize;
+    const uint32_t frameEnd = (s->port.rxBufferSize - rxDMAHead) % s->port.rxBufferSize;
+    s->rxDMAPos = rxDMAHead;
+
+    const uint8_t *rxBuffer = (const uint8_t *)s->port.rxBuffer;
+    if (frameEnd > frameStart) {
+        s->port.rxFrameCallback(&rxBuffer[frameStart], frameEnd - frameStart, frameTimeUs, s->port.rxCallbackData);
+    } else if (frameEnd < frameStart) {
+        // The frame wraps around the end of the buffer, hand it over in one piece
+        uint8_t frame[UART_RX_BUFFER_SIZE];
+        const uint32_t firstPart = s->port.rxBufferSize - frameStart;
+        memcpy(frame, &rxBuffer[frameStart], firstPart);
+        memcpy(&frame[firstPart], rxBuffer, frameEnd);
+        s->port.rxFrameCallback(frame, firstPart + frameEnd, frameTimeUs, s->port.rxCallbackData);
     }
 }
 
@@ -279,9 +431,11 @@ const struct serialPortVTable uartVTable[] = {
         .setMode = uartSetMode,
         .setCtrlLineStateCb = NULL,
         .setBaudRateCb = NULL,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .setRxFrameCallback = uartSetRxFrameCallback,
+        .writeFrame = uartWriteFrame,
     }
 };
 
@@ -72,6 +72,13 @@ typedef struct uartPort_s {
 #endif
     USART_TypeDef *USARTx;
     bool txDMAEmpty;
+
+    // Frame sent by DMA straight from the caller's buffer, set until txFrameDoneCb has been called
+    const uint8_t *txFrame;
+    uint16_t txFrameLength;
+    bool txFrameActive;
+    serialTxFrameDoneCallbackPtr txFrameDoneCb;
+    void *txFrameDoneData;
 } uartPort_t;
 
 void uartPinConfigure(const serialPinConfig_t *pSerialPinConfig);
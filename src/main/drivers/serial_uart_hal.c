@@ -370,6 +370,8 @@ const struct serialPortVTable uartVTable[] = {
         .writeBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
+        .setRxFrameCallback = NULL,
+        .writeFrame = NULL,
     }
 };
 
@@ -167,10 +167,12 @@ extern const struct serialPortVTable uartVTable[];
 void uartStartTxDMA(uartPort_t *s);
 #else
 void uartTryStartTxDMA(uartPort_t *s);
+void uartReleaseTxFrame(uartPort_t *s);
 #endif
 
 uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode, portOptions_e options);
 
 void uartIrqHandler(uartPort_t *s);
+void uartRxIdleHandler(uartPort_t *s);
 
 void uartReconfigure(uartPort_t *uartPort);
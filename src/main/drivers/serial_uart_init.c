@@ -126,14 +126,16 @@ serialPort_t *uartOpen(UARTDevice_e device, serialReceiveCallbackPtr rxCallback,
     // common serial initialisation code should move to serialPort::init()
     s->port.rxBufferHead = s->port.rxBufferTail = 0;
     s->port.txBufferHead = s->port.txBufferTail = 0;
-    // callback works for IRQ-based RX ONLY
+    // callback works for IRQ-based RX ONLY, ports with RX DMA can deliver whole frames with serialSetRxFrameCallback()
     s->port.rxCallback = rxCallback;
+    s->port.rxFrameCallback = NULL;
     s->port.rxCallbackData = rxCallbackData;
     s->port.mode = mode;
     s->port.baudRate = baudRate;
     s->port.options = options;
 
     uartReconfigure(s);
+    USART_ITConfig(s->USARTx, USART_IT_IDLE, DISABLE);
 
     // Receive DMA or IRQ
     DMA_InitTypeDef DMA_InitStructure;
@@ -192,6 +194,9 @@ serialPort_t *uartOpen(UARTDevice_e device, serialReceiveCallbackPtr rxCallback,
 
     // Transmit DMA or IRQ
     if (mode & MODE_TX) {
+        // A frame the DMA was sending is abandoned by the reinitialisation below
+        uartReleaseTxFrame(s);
+
 #ifdef STM32F4
         if (s->txDMAStream) {
             DMA_StructInit(&DMA_InitStructure);
@@ -175,16 +175,14 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
         }
     }
 
-    // RX/TX Interrupt
-    if (!hardware->rxDMAChannel || !hardware->txDMAChannel) {
-        NVIC_InitTypeDef NVIC_InitStructure;
-
-        NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
-        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&NVIC_InitStructure);
-    }
+    // RX/TX Interrupt, also needed with RX DMA for idle line detection
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 
     return s;
 }
@@ -204,6 +202,11 @@ void uartIrqHandler(uartPort_t *s)
             }
         }
     }
+    if (SR & USART_FLAG_IDLE && s->rxDMAChannel) {
+        // Reading DR after SR clears the idle flag
+        (void)s->USARTx->DR;
+        uartRxIdleHandler(s);
+    }
     if (SR & USART_FLAG_TXE) {
         if (s->port.txBufferTail != s->port.txBufferHead) {
             s->USARTx->DR = s->port.txBuffer[s->port.txBufferTail++];
@@ -244,15 +244,14 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
 
     serialUARTInitIO(IOGetByTag(uartDev->tx), IOGetByTag(uartDev->rx), mode, options, hardware->af, device);
 
-    if (!s->rxDMAChannel || !s->txDMAChannel) {
-        NVIC_InitTypeDef NVIC_InitStructure;
-
-        NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
-        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&NVIC_InitStructure);
-    }
+    // Also needed with RX DMA, for idle line detection
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 
     return s;
 }
@@ -283,6 +282,11 @@ void uartIrqHandler(uartPort_t *s)
         }
     }
 
+    if (s->rxDMAChannel && (ISR & USART_FLAG_IDLE)) {
+        USART_ClearITPendingBit(s->USARTx, USART_IT_IDLE);
+        uartRxIdleHandler(s);
+    }
+
     if (ISR & USART_FLAG_ORE)
     {
         USART_ClearITPendingBit (s->USARTx, USART_IT_ORE);
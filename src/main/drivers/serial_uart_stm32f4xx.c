@@ -256,15 +256,14 @@ uartPort_t *serialUART(UARTDevice_e device, uint32_t baudRate, portMode_e mode,
         }
     }
 
-    if (!(s->rxDMAChannel)) {
-        NVIC_InitTypeDef NVIC_InitStructure;
-
-        NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
-        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&NVIC_InitStructure);
-    }
+    // Also needed with RX DMA, for idle line detection
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    NVIC_InitStructure.NVIC_IRQChannel = hardware->irqn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(hardware->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 
     return s;
 }
@@ -289,6 +288,12 @@ void uartIrqHandler(uartPort_t *s)
         }
     }
 
+    if (s->rxDMAStream && (USART_GetITStatus(s->USARTx, USART_IT_IDLE) == SET)) {
+        // Reading DR after SR clears the idle flag
+        (void)s->USARTx->DR;
+        uartRxIdleHandler(s);
+    }
+
     if (USART_GetITStatus(s->USARTx, USART_FLAG_ORE) == SET)
     {
         USART_ClearITPendingBit (s->USARTx, USART_IT_ORE);
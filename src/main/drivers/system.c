@@ -28,6 +28,7 @@
 #include "drivers/light_led.h"
 #include "drivers/nvic.h"
 #include "drivers/sound_beeper.h"
+#include "drivers/time.h"
 
 #include "system.h"
 
@@ -48,6 +49,32 @@ void cycleCounterInit(void)
     RCC_GetClocksFreq(&clocks);
     usTicks = clocks.SYSCLK_Frequency / 1000000;
 #endif
+
+    // enable the DWT cycle counter, used by ticks() for cycle accurate timing
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// Return the free running cpu cycle counter (rollover in 25 seconds at 168MHz)
+uint32_t ticks(void)
+{
+    return DWT->CYCCNT;
+}
+
+timeDelta_t ticks_diff_us(uint32_t begin, uint32_t end)
+{
+    return (end - begin) / usTicks;
+}
+
+uint32_t clockCyclesToMicros(uint32_t clockCycles)
+{
+    return clockCycles / usTicks;
+}
+
+uint32_t clockMicrosToCycles(uint32_t micros)
+{
+    return micros * usTicks;
 }
 
 // SysTick
@@ -33,3 +33,5 @@ timeMs_t millis(void);
 
 uint32_t ticks(void);
 timeDelta_t ticks_diff_us(uint32_t begin, uint32_t end);
+uint32_t clockCyclesToMicros(uint32_t clockCycles);
+uint32_t clockMicrosToCycles(uint32_t micros);
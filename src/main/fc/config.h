@@ -38,6 +38,7 @@ typedef struct systemConfig_s {
     uint8_t activeRateProfile;
     uint8_t debug_mode;
     uint8_t task_statistics;
+    uint8_t scheduler_edf;                  // schedule non-realtime tasks earliest deadline first instead of by priority
     uint8_t rateProfile6PosSwitch;
     uint8_t cpu_overclock;
     uint8_t powerOnArmingGraceTime; // in seconds
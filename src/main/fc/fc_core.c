@@ -51,6 +51,7 @@
 #include "sensors/battery.h"
 #include "sensors/boardalignment.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_capture.h"
 #include "sensors/sensors.h"
 
 #include "fc/config.h"
@@ -59,6 +60,7 @@
 #include "fc/fc_rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/runtime_config.h"
 
 #include "msp/msp_serial.h"
@@ -87,6 +89,7 @@
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
+#include "flight/rpm_filter.h"
 #include "flight/servos.h"
 #include "flight/gps_rescue.h"
 
@@ -307,6 +310,10 @@ void disarm(void)
         DISABLE_ARMING_FLAG(ARMED);
         lastDisarmTimeUs = micros();
 
+#ifdef USE_GYRO_CAPTURE
+        gyroCaptureStop();
+#endif
+
 #ifdef USE_BLACKBOX
         if (blackboxConfig()->device && blackboxConfig()->mode != BLACKBOX_MODE_ALWAYS_ON) { // Close the log upon disarm except when logging mode is ALWAYS ON
             blackboxFinish();
@@ -374,6 +381,12 @@ void tryArm(void)
         ENABLE_ARMING_FLAG(ARMED);
         ENABLE_ARMING_FLAG(WAS_EVER_ARMED);
 
+#ifdef USE_GYRO_CAPTURE
+        if (gyroConfig()->gyro_capture) {
+            gyroCaptureStart(gyro.targetLooptime);
+        }
+#endif
+
         resetTryingToArm();
 
 #ifdef USE_ACRO_TRAINER
@@ -863,6 +876,9 @@ static FAST_CODE void subTaskPidController(timeUs_t currentTimeUs)
     // PID - note this is function pointer set by setPIDController()
     pidController(currentPidProfile, &accelerometerConfig()->accelerometerTrims, currentTimeUs);
     DEBUG_SET(DEBUG_PIDLOOP, 1, micros() - startTime);
+#ifdef USE_RC_LATENCY
+    rcLatencyMark(RC_LATENCY_STAGE_PID);
+#endif
 
 #ifdef USE_RUNAWAY_TAKEOFF
     // Check to see if runaway takeoff detection is active (anti-taz), the pidSum is over the threshold,
@@ -958,6 +974,9 @@ static FAST_CODE void subTaskMotorUpdate(timeUs_t currentTimeUs)
     }
 
     mixTable(currentTimeUs, currentPidProfile->vbatPidCompensation);
+#ifdef USE_RC_LATENCY
+    rcLatencyMark(RC_LATENCY_STAGE_MIXER);
+#endif
 
 #ifdef USE_SERVOS
     // motor outputs are used as sources for servo mixing, so motors must be calculated using mixTable() before servos.
@@ -992,7 +1011,9 @@ static FAST_CODE_NOINLINE void subTaskRcCommand(timeUs_t currentTimeUs)
     }
 
     processRcCommand();
-
+#ifdef USE_RC_LATENCY
+    rcLatencyMark(RC_LATENCY_STAGE_RC_COMMAND);
+#endif
 }
 
 // Function for loop trigger
@@ -1035,6 +1056,9 @@ FAST_CODE void taskMainPidLoop(timeUs_t currentTimeUs)
             }
             subTaskRcCommand(currentTimeUs);
         }
+#ifdef USE_RPM_FILTER
+        rpmFilterUpdate();
+#endif
         subTaskPidController(currentTimeUs);
         subTaskMotorUpdate(currentTimeUs);
         subTaskPidSubprocesses(currentTimeUs);
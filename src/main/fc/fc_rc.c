@@ -40,6 +40,7 @@
 #include "fc/fc_rc.h"
 #include "fc/rc_controls.h"
 #include "fc/rc_modes.h"
+#include "fc/rc_prediction.h"
 #include "fc/runtime_config.h"
 
 #include "flight/failsafe.h"
@@ -617,6 +618,41 @@ FAST_CODE uint8_t processRcSmoothingFilter(void)
 }
 #endif // USE_RC_SMOOTHING_FILTER
 
+#ifdef USE_RC_PREDICTION
+static FAST_RAM_ZERO_INIT rcPredictionState_t rcPredictionState;
+
+FAST_CODE uint8_t processRcPrediction(void)
+{
+    const timeUs_t currentTimeUs = micros();
+
+    if (isRXDataNew) {
+        // Stamp the frame with when it arrived rather than when the PID loop got to it, so loop scheduling doesn't show up as link jitter
+        const timeUs_t frameAtUs = rxRuntimeConfig.rcFrameTimeUsFn ? rxRuntimeConfig.rcFrameTimeUsFn(&rxRuntimeConfig) : currentTimeUs;
+
+        // rcCommand holds the new frame, the model takes it before it is overwritten by the prediction
+        rcPredictionFrame(&rcPredictionState, rcCommand, frameAtUs);
+
+        DEBUG_SET(DEBUG_RC_INTERPOLATION, 1, lrintf(rcPredictionState.link.frameIntervalUs));
+        DEBUG_SET(DEBUG_RC_INTERPOLATION, 2, lrintf(rcPredictionState.link.jitterUs));
+    }
+
+    for (int channel = 0; channel < PRIMARY_CHANNEL_COUNT; channel++) {
+        if ((1 << channel) & interpolationChannels) {
+            const float value = rcPredictionValue(&rcPredictionState, channel, currentTimeUs);
+            if (channel == THROTTLE) {
+                rcCommand[channel] = constrainf(value, PWM_RANGE_MIN, PWM_RANGE_MAX);
+            } else {
+                rcCommand[channel] = constrainf(value, -500, 500);
+            }
+        }
+    }
+
+    DEBUG_SET(DEBUG_RC_INTERPOLATION, 0, lrintf(rcCommand[ROLL]));
+
+    return interpolationChannels;
+}
+#endif // USE_RC_PREDICTION
+
 FAST_CODE void processRcCommand(void)
 {
     uint8_t updatedChannel;
@@ -631,6 +667,11 @@ FAST_CODE void processRcCommand(void)
         updatedChannel = processRcSmoothingFilter();
         break;
 #endif // USE_RC_SMOOTHING_FILTER
+#ifdef USE_RC_PREDICTION
+    case RC_SMOOTHING_TYPE_PREDICTIVE:
+        updatedChannel = processRcPrediction();
+        break;
+#endif // USE_RC_PREDICTION
     case RC_SMOOTHING_TYPE_INTERPOLATION:
     default:
         updatedChannel = processRcInterpolation();
@@ -864,6 +905,20 @@ bool rcSmoothingIsEnabled(void)
 #ifdef USE_RC_SMOOTHING_FILTER
 int rcSmoothingGetValue(int whichValue)
 {
+#ifdef USE_RC_PREDICTION
+    if (rxConfig()->rc_smoothing_type == RC_SMOOTHING_TYPE_PREDICTIVE) {
+        switch (whichValue) {
+            case RC_SMOOTHING_VALUE_AVERAGE_FRAME:
+                return lrintf(rcPredictionState.link.frameIntervalUs);
+            case RC_SMOOTHING_VALUE_FRAME_JITTER:
+                return lrintf(rcPredictionState.link.jitterUs);
+            case RC_SMOOTHING_VALUE_DROPPED_FRAMES:
+                return rcPredictionState.link.droppedFrames;
+            default:
+                return 0;
+        }
+    }
+#endif
     switch (whichValue) {
         case RC_SMOOTHING_VALUE_INPUT_ACTIVE:
             return rcSmoothingData.inputCutoffFrequency;
@@ -256,6 +256,7 @@ static void taskCameraControl(uint32_t currentTime)
 void fcTasksInit(void)
 {
     schedulerInit();
+    schedulerSetDeadlineScheduling(systemConfig()->scheduler_edf);
 
     setTaskEnabled(TASK_MAIN, true);
 
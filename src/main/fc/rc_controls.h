@@ -63,7 +63,8 @@ typedef enum {
 
 typedef enum {
     RC_SMOOTHING_TYPE_INTERPOLATION,
-    RC_SMOOTHING_TYPE_FILTER
+    RC_SMOOTHING_TYPE_FILTER,
+    RC_SMOOTHING_TYPE_PREDICTIVE
 } rcSmoothingType_e;
 
 typedef enum {
@@ -80,7 +81,9 @@ typedef enum {
 typedef enum {
     RC_SMOOTHING_VALUE_INPUT_ACTIVE,
     RC_SMOOTHING_VALUE_DERIVATIVE_ACTIVE,
-    RC_SMOOTHING_VALUE_AVERAGE_FRAME
+    RC_SMOOTHING_VALUE_AVERAGE_FRAME,
+    RC_SMOOTHING_VALUE_FRAME_JITTER,
+    RC_SMOOTHING_VALUE_DROPPED_FRAMES
 } rcSmoothingInfoType_e;
 
 #define ROL_LO (1 << (2 * ROLL))
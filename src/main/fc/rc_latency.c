@@ -0,0 +1,110 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_RC_LATENCY
+
+#include "build/debug.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/time.h"
+
+#include "rc_latency.h"
+
+const char * const rcLatencyStageNames[RC_LATENCY_STAGE_COUNT] = {
+    "TOTAL",
+    "RX_CHANNELS",
+    "RC_COMMAND",
+    "PID",
+    "MIXER",
+    "MOTOR_OUTPUT"
+};
+
+// stage to be marked next, RC_LATENCY_STAGE_RX_FRAME while waiting for a frame
+static FAST_RAM_ZERO_INIT uint8_t nextStage;
+static FAST_RAM_ZERO_INIT timeUs_t stageTimeUs[RC_LATENCY_STAGE_COUNT];
+static rcLatencyStats_t stats[RC_LATENCY_STAGE_COUNT];
+
+static void rcLatencyStatsAdd(rcLatencyStats_t *entry, uint32_t delayUs)
+{
+    const uint32_t scaled = delayUs >> RC_LATENCY_HISTOGRAM_SHIFT;
+    const int bucket = scaled ? MIN(32 - __builtin_clz(scaled), RC_LATENCY_HISTOGRAM_BUCKET_COUNT - 1) : 0;
+
+    entry->count++;
+    entry->sumUs += delayUs;
+    entry->maxUs = MAX(entry->maxUs, delayUs);
+    // saturate, the shape of the distribution is kept when the counts stop
+    if (entry->histogram[bucket] < UINT16_MAX) {
+        entry->histogram[bucket]++;
+    }
+}
+
+/*
+ * Start tracing a newly received frame. A frame still being traced is abandoned, its remaining stages will be
+ * run for the new frame.
+ */
+void rcLatencyFrameReceived(timeUs_t frameTimeUs)
+{
+    stageTimeUs[RC_LATENCY_STAGE_RX_FRAME] = frameTimeUs;
+    nextStage = RC_LATENCY_STAGE_RX_CHANNELS;
+}
+
+FAST_CODE void rcLatencyMark(rcLatencyStage_e stage)
+{
+    if (stage != nextStage) {
+        return;
+    }
+
+    const timeUs_t nowUs = micros();
+    stageTimeUs[stage] = nowUs;
+    rcLatencyStatsAdd(&stats[stage], cmpTimeUs(nowUs, stageTimeUs[stage - 1]));
+
+    if (stage < RC_LATENCY_STAGE_MOTOR_OUTPUT) {
+        nextStage++;
+        return;
+    }
+
+    const uint32_t totalUs = cmpTimeUs(nowUs, stageTimeUs[RC_LATENCY_STAGE_RX_FRAME]);
+    rcLatencyStatsAdd(&stats[RC_LATENCY_STAGE_RX_FRAME], totalUs);
+    nextStage = RC_LATENCY_STAGE_RX_FRAME;
+
+    DEBUG_SET(DEBUG_RC_LATENCY, 0, cmpTimeUs(stageTimeUs[RC_LATENCY_STAGE_RX_CHANNELS], stageTimeUs[RC_LATENCY_STAGE_RX_FRAME]));
+    DEBUG_SET(DEBUG_RC_LATENCY, 1, cmpTimeUs(stageTimeUs[RC_LATENCY_STAGE_RC_COMMAND], stageTimeUs[RC_LATENCY_STAGE_RX_CHANNELS]));
+    DEBUG_SET(DEBUG_RC_LATENCY, 2, cmpTimeUs(nowUs, stageTimeUs[RC_LATENCY_STAGE_RC_COMMAND]));
+    DEBUG_SET(DEBUG_RC_LATENCY, 3, totalUs);
+}
+
+const rcLatencyStats_t *rcLatencyGetStats(rcLatencyStage_e stage)
+{
+    return &stats[stage];
+}
+
+void rcLatencyReset(void)
+{
+    memset(stats, 0, sizeof(stats));
+}
+
+#endif // USE_RC_LATENCY
@@ -0,0 +1,60 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/time.h"
+
+/*
+ * The RC latency tracer follows one RC frame at a time through the flight controller, timestamping it at each
+ * stage until the motor outputs computed from it are sent. A stage is only marked once the previous one has
+ * been, so marking costs a single compare while no frame is being traced.
+ */
+typedef enum {
+    RC_LATENCY_STAGE_RX_FRAME = 0,  // last byte of the frame received
+    RC_LATENCY_STAGE_RX_CHANNELS,   // channels read and ranges applied
+    RC_LATENCY_STAGE_RC_COMMAND,    // rcCommand and setpoint updated
+    RC_LATENCY_STAGE_PID,           // PID controller run
+    RC_LATENCY_STAGE_MIXER,         // motor outputs mixed
+    RC_LATENCY_STAGE_MOTOR_OUTPUT,  // motor update sent
+    RC_LATENCY_STAGE_COUNT
+} rcLatencyStage_e;
+
+// bucket n counts delays below 2^(n + RC_LATENCY_HISTOGRAM_SHIFT) us, the last bucket counts everything above
+#define RC_LATENCY_HISTOGRAM_BUCKET_COUNT 12
+#define RC_LATENCY_HISTOGRAM_SHIFT 3
+
+// Delays from the previous stage, the RC_LATENCY_STAGE_RX_FRAME entry holds the total from frame to motor output
+typedef struct rcLatencyStats_s {
+    uint32_t count;
+    uint32_t sumUs;
+    uint32_t maxUs;
+    uint16_t histogram[RC_LATENCY_HISTOGRAM_BUCKET_COUNT];
+} rcLatencyStats_t;
+
+extern const char * const rcLatencyStageNames[RC_LATENCY_STAGE_COUNT];
+
+void rcLatencyFrameReceived(timeUs_t frameTimeUs);
+void rcLatencyMark(rcLatencyStage_e stage); // any stage after RC_LATENCY_STAGE_RX_FRAME
+
+const rcLatencyStats_t *rcLatencyGetStats(rcLatencyStage_e stage);
+void rcLatencyReset(void);
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_RC_PREDICTION
+
+#include "common/maths.h"
+
+#include "rc_prediction.h"
+
+void rcPredictionInit(rcPredictionState_t *state)
+{
+    memset(state, 0, sizeof(*state));
+}
+
+static void restartPrediction(rcPredictionState_t *state, const float *values)
+{
+    state->link.frameIntervalUs = 0;
+    state->link.jitterUs = 0;
+    state->link.longIntervals = 0;
+    for (int i = 0; i < RC_PREDICTION_CHANNEL_COUNT; i++) {
+        state->channel[i].value = values[i];
+        state->channel[i].velocity = 0;
+        state->channel[i].offset = 0;
+    }
+}
+
+// Returns the number of transmitter frames the interval spans
+static int updateLinkModel(rcPredictionLink_t *link, timeDelta_t intervalUs)
+{
+    if (link->frameIntervalUs == 0) {
+        link->frameIntervalUs = intervalUs;
+        return 1;
+    }
+
+    const int frames = MAX(lrintf(intervalUs / link->frameIntervalUs), 1);
+    if (frames > 1) {
+        if (++link->longIntervals < RC_PREDICTION_RESYNC_INTERVALS) {
+            link->droppedFrames += frames - 1;
+            return frames;
+        }
+        // the link has slowed down, start over from its new rate
+        link->frameIntervalUs = intervalUs;
+        link->jitterUs = 0;
+        link->longIntervals = 0;
+        return 1;
+    }
+
+    link->longIntervals = 0;
+    const float error = intervalUs - link->frameIntervalUs;
+    link->frameIntervalUs += error / RC_PREDICTION_MODEL_WEIGHT;
+    link->jitterUs += (fabsf(error) - link->jitterUs) / RC_PREDICTION_MODEL_WEIGHT;
+    return 1;
+}
+
+FAST_CODE void rcPredictionFrame(rcPredictionState_t *state, const float *values, timeUs_t frameAtUs)
+{
+    const timeDelta_t intervalUs = cmpTimeUs(frameAtUs, state->lastFrameAtUs);
+    const bool restart = !state->hasFrame || intervalUs <= 0 || intervalUs > RC_PREDICTION_MAX_INTERVAL_US;
+
+    if (restart) {
+        restartPrediction(state, values);
+    } else {
+        float predicted[RC_PREDICTION_CHANNEL_COUNT];
+        for (int i = 0; i < RC_PREDICTION_CHANNEL_COUNT; i++) {
+            predicted[i] = rcPredictionValue(state, i, frameAtUs);
+        }
+
+        const int frames = updateLinkModel(&state->link, intervalUs);
+        const float spanUs = frames * state->link.frameIntervalUs;
+
+        for (int i = 0; i < RC_PREDICTION_CHANNEL_COUNT; i++) {
+            rcPredictionChannel_t *channel = &state->channel[i];
+            channel->velocity = (values[i] - channel->value) / spanUs;
+            channel->offset = predicted[i] - values[i];
+            channel->value = values[i];
+        }
+    }
+
+    state->lastFrameAtUs = frameAtUs;
+    state->hasFrame = true;
+}
+
+FAST_CODE float rcPredictionValue(const rcPredictionState_t *state, int channel, timeUs_t currentTimeUs)
+{
+    const rcPredictionChannel_t *c = &state->channel[channel];
+    const rcPredictionLink_t *link = &state->link;
+
+    if (link->frameIntervalUs == 0) {
+        return c->value;
+    }
+
+    const float elapsedUs = MAX(cmpTimeUs(currentTimeUs, state->lastFrameAtUs), 0);
+    // extrapolate until the next frame is overdue, if it has been lost the last prediction is held
+    const float horizonUs = link->frameIntervalUs + 2 * link->jitterUs;
+    const float blend = 1.0f - elapsedUs / link->frameIntervalUs;
+
+    float value = c->value + c->velocity * MIN(elapsedUs, horizonUs);
+    if (blend > 0) {
+        value += c->offset * blend;
+    }
+    return value;
+}
+#endif // USE_RC_PREDICTION
@@ -0,0 +1,64 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+/*
+ * The RC predictor extrapolates rcCommand between RX frames instead of ramping towards the last frame, so the
+ * setpoint follows the sticks without the frame of delay added by interpolation or a lowpass filter.
+ *
+ * The link model tracks the average interval between frames and its jitter. The stick velocity of each frame is
+ * taken over the transmitter's frame interval, not the jittery arrival interval, and frames that went missing are
+ * counted into it. A frame that does not match the prediction is blended in over one frame interval instead of
+ * stepping the setpoint.
+ */
+#define RC_PREDICTION_CHANNEL_COUNT     4
+#define RC_PREDICTION_MODEL_WEIGHT      16      // the link model follows 1/16 of each new interval
+#define RC_PREDICTION_RESYNC_INTERVALS  8       // long intervals in a row that mean a slower link, not lost frames
+#define RC_PREDICTION_MAX_INTERVAL_US   100000  // frames further apart than this restart the prediction
+
+typedef struct rcPredictionLink_s {
+    float frameIntervalUs;      // average interval between frames, zero until two frames have been received
+    float jitterUs;             // mean absolute deviation from the average interval
+    uint32_t droppedFrames;
+    uint8_t longIntervals;      // consecutive intervals that looked like dropped frames
+} rcPredictionLink_t;
+
+typedef struct rcPredictionChannel_s {
+    float value;                // value in the last frame
+    float velocity;             // change per us
+    float offset;               // prediction minus value when the last frame arrived
+} rcPredictionChannel_t;
+
+typedef struct rcPredictionState_s {
+    rcPredictionLink_t link;
+    rcPredictionChannel_t channel[RC_PREDICTION_CHANNEL_COUNT];
+    timeUs_t lastFrameAtUs;
+    bool hasFrame;
+} rcPredictionState_t;
+
+void rcPredictionInit(rcPredictionState_t *state);
+void rcPredictionFrame(rcPredictionState_t *state, const float *values, timeUs_t frameAtUs);
+float rcPredictionValue(const rcPredictionState_t *state, int channel, timeUs_t currentTimeUs);
@@ -220,15 +220,13 @@ void pidStabilisationState(pidStabilisationState_e pidControllerState)
 
 const angle_index_t rcAliasToAngleIndexMap[] = { AI_ROLL, AI_PITCH };
 
-typedef union dtermLowpass_u {
-    pt1Filter_t pt1Filter;
-    biquadFilter_t biquadFilter;
-} dtermLowpass_t;
-
-static FAST_RAM filterApplyFnPtr dtermNotchApplyFn = nullFilterApply;
-static FAST_RAM_ZERO_INIT biquadFilter_t dtermNotch[3];
-static FAST_RAM filterApplyFnPtr dtermLowpassApplyFn = nullFilterApply;
-static FAST_RAM_ZERO_INIT dtermLowpass_t dtermLowpass[3];
+// the D term filters run on all three axes at once, see pidDtermDelta()
+static FAST_RAM_ZERO_INIT bool dtermNotchEnabled;
+static FAST_RAM_ZERO_INIT biquadFilter3_t dtermNotch;
+static FAST_RAM_ZERO_INIT bool dtermLowpassEnabled;
+static FAST_RAM_ZERO_INIT uint8_t dtermLowpassType;
+static FAST_RAM_ZERO_INIT pt1Filter_t dtermLowpassPt1[XYZ_AXIS_COUNT];
+static FAST_RAM_ZERO_INIT biquadFilter3_t dtermLowpassBiquad;
 #if defined(USE_ITERM_RELAX)
 static FAST_RAM_ZERO_INIT pt1Filter_t windupLpf[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT uint8_t itermRelax;
@@ -249,8 +247,8 @@ static FAST_RAM_ZERO_INIT pt1Filter_t antiGravityThrottleLpf;
 void pidInitFilters(const pidProfile_t *pidProfile)
 {
     BUILD_BUG_ON(FD_YAW != 2); // ensure yaw axis is 2
-    dtermNotchApplyFn = nullFilterApply;
-    dtermLowpassApplyFn = nullFilterApply;
+    dtermNotchEnabled = false;
+    dtermLowpassEnabled = false;
     const uint32_t pidFrequencyNyquist = pidFrequency / 2; // No rounding needed
 
     uint16_t dTermNotchHz;
@@ -265,31 +263,29 @@ void pidInitFilters(const pidProfile_t *pidProfile)
     }
 
     if (dTermNotchHz != 0 && pidProfile->dterm_notch_cutoff != 0) {
-        dtermNotchApplyFn = (filterApplyFnPtr)biquadFilterApply;
+        dtermNotchEnabled = true;
         const float notchQ = filterGetNotchQ(dTermNotchHz, pidProfile->dterm_notch_cutoff);
-        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-            biquadFilterInit(&dtermNotch[axis], dTermNotchHz, targetPidLooptime, notchQ, FILTER_NOTCH);
-        }
+        biquadFilter3Init(&dtermNotch, dTermNotchHz, targetPidLooptime, notchQ, FILTER_NOTCH);
     }
 
 
 
     if (pidProfile->dterm_lowpass_hz && pidProfile->dterm_lowpass_hz <= pidFrequencyNyquist)
     {
-        for (int axis = FD_ROLL; axis <= FD_YAW; axis++)
+        dtermLowpassEnabled = true;
+        switch (pidProfile->dterm_filter_type)
         {
-            switch (pidProfile->dterm_filter_type)
-            {
-            case FILTER_PT1:
-                    dtermLowpassApplyFn = (filterApplyFnPtr)pt1FilterApply;
-                    pt1FilterInit(&dtermLowpass[axis].pt1Filter, pt1FilterGain(pidProfile->dterm_lowpass_hz, dT));
-                break;
-            case FILTER_BIQUAD:
-            default:
-                    dtermLowpassApplyFn = (filterApplyFnPtr)biquadFilterApply;
-                    biquadFilterInitLPF(&dtermLowpass[axis].biquadFilter, pidProfile->dterm_lowpass_hz, targetPidLooptime);
-                break;
+        case FILTER_PT1:
+            dtermLowpassType = FILTER_PT1;
+            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+                pt1FilterInit(&dtermLowpassPt1[axis], pt1FilterGain(pidProfile->dterm_lowpass_hz, dT));
             }
+            break;
+        case FILTER_BIQUAD:
+        default:
+            dtermLowpassType = FILTER_BIQUAD;
+            biquadFilter3InitLPF(&dtermLowpassBiquad, pidProfile->dterm_lowpass_hz, targetPidLooptime);
+            break;
         }
     }
 #if defined(USE_THROTTLE_BOOST)
@@ -352,7 +348,7 @@ typedef struct pidCoefficient_s {
 static FAST_RAM_ZERO_INIT pidCoefficient_t pidCoefficient[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT float maxVelocity[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT float feedForwardTransition;
-static FAST_RAM_ZERO_INIT pidControllerFn activePidController;
+static FAST_RAM_ZERO_INIT bool butteredPidsEnabled;
 static FAST_RAM_ZERO_INIT float levelGain, horizonGain, horizonTransition, horizonCutoffDegrees, horizonFactorRatio;
 static FAST_RAM_ZERO_INIT float ITermWindupPointInv;
 static FAST_RAM_ZERO_INIT uint8_t horizonTiltExpertMode;
@@ -391,9 +387,6 @@ void pidResetITerm(void)
     }
 }
 
-float butteredPids(const pidProfile_t *pidProfile, int axis, float errorRate, float dynCi, float iDT, float currentPidSetpoint);
-float classicPids(const pidProfile_t *pidProfile, int axis, float errorRate, float dynCi, float iDT, float currentPidSetpoint);
-
 #ifdef USE_ACRO_TRAINER
 static FAST_RAM_ZERO_INIT float acroTrainerAngleLimit;
 static FAST_RAM_ZERO_INIT float acroTrainerLookaheadTime;
@@ -469,7 +462,7 @@ void pidInitConfig(const pidProfile_t *pidProfile)
     itermRelaxCutoff = pidProfile->iterm_relax_cutoff;
 #endif
 
-    activePidController = (pidProfile->buttered_pids ? butteredPids : classicPids);
+    butteredPidsEnabled = pidProfile->buttered_pids;
 #ifdef USE_ACRO_TRAINER
     acroTrainerAngleLimit = pidProfile->acro_trainer_angle_limit;
     acroTrainerLookaheadTime = (float)pidProfile->acro_trainer_lookahead_ms / 1000.0f;
@@ -827,14 +820,66 @@ void FAST_CODE applySmartFeedforward(int axis)
 #endif // USE_SMART_FEEDFORWARD
 
 static FAST_RAM_ZERO_INIT float previousRateError[3];
+static FAST_RAM_ZERO_INIT float previousGyroRateDterm[XYZ_AXIS_COUNT];
 static FAST_RAM_ZERO_INIT timeUs_t crashDetectedAtUs;
 static FAST_RAM_ZERO_INIT timeUs_t previousTimeUs;
 
+// throttle PID attenuation, read once per PID loop for all axes
+typedef struct pidAttenuation_s {
+    float kp;
+    float ki;
+    float kd;
+} pidAttenuation_t;
+
+static FAST_CODE void dtermLowpassApply(float *data)
+{
+    if (!dtermLowpassEnabled) {
+        return;
+    }
+    if (dtermLowpassType == FILTER_PT1) {
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            data[axis] = pt1FilterApply(&dtermLowpassPt1[axis], data[axis]);
+        }
+    } else {
+        biquadFilter3Apply(&dtermLowpassBiquad, data);
+    }
+}
+
+// D term input of all axes, it only depends on the measurement so it is filtered for the three axes in one pass
+static FAST_CODE void pidDtermDelta(float iDT, float *dDelta)
+{
+    if (butteredPidsEnabled) {
+        // use measurement and apply filters. mmmm gimme that butter.
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            dDelta[axis] = -((gyro.gyroADCf[axis] - previousRateError[axis]) * iDT);
+            previousRateError[axis] = gyro.gyroADCf[axis];
+        }
+        dtermLowpassApply(dDelta);
+    } else {
+        float gyroRateDterm[XYZ_AXIS_COUNT];
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            gyroRateDterm[axis] = gyro.gyroADCf[axis];
+        }
+        if (dtermNotchEnabled) {
+            biquadFilter3Apply(&dtermNotch, gyroRateDterm);
+        }
+        dtermLowpassApply(gyroRateDterm);
+
+        // Divide rate change by dT to get differential (ie dr/dt).
+        // dT is fixed and calculated from the target PID loop time
+        // This is done to avoid DTerm spikes that occur with dynamically
+        // calculated deltaT whenever another task causes the PID
+        // loop execution to be delayed.
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            dDelta[axis] = - (gyroRateDterm[axis] - previousGyroRateDterm[axis]) * pidFrequency;
+            previousGyroRateDterm[axis] = gyroRateDterm[axis];
+        }
+    }
+}
+
 // Butterflight pid controller which uses measurement instead of error rate to calculate D
-FAST_CODE float butteredPids(const pidProfile_t *pidProfile, int axis, float errorRate, float dynCi, float iDT, float currentPidSetpoint)
+static FAST_CODE void butteredPids(int axis, float errorRate, float dynCi, float dDelta, const pidAttenuation_t *attenuation)
 {
-    (void)(pidProfile);
-    (void)(currentPidSetpoint);
     // -----calculate P component
     pidData[axis].P = (pidCoefficient[axis].Kp * errorRate);
 
@@ -845,33 +890,23 @@ FAST_CODE float butteredPids(const pidProfile_t *pidProfile, int axis, float err
         pidData[axis].I = iterm;
     }
 
-    // use measurement and apply filters. mmmm gimme that butter.
-    float dDelta = dtermLowpassApplyFn((filter_t *) &dtermLowpass[axis], -((gyro.gyroADCf[axis] - previousRateError[axis]) * iDT));
-    previousRateError[axis] = gyro.gyroADCf[axis];
     pidData[axis].D = (pidCoefficient[axis].Kd * dDelta);
 
+    pidData[axis].P = pidData[axis].P * attenuation->kp;
 #if defined(USE_TPA_CURVES)
-    pidData[axis].P = pidData[axis].P * getThrottlePIDAttenuationKp();
-    pidData[axis].I = pidData[axis].I * getThrottlePIDAttenuationKi();
-    pidData[axis].D = pidData[axis].D * getThrottlePIDAttenuationKd();
-#else
-    pidData[axis].P = pidData[axis].P * getThrottlePIDAttenuation();
-    pidData[axis].D = pidData[axis].D * getThrottlePIDAttenuation();
+    pidData[axis].I = pidData[axis].I * attenuation->ki;
 #endif
-    return dDelta;
+    pidData[axis].D = pidData[axis].D * attenuation->kd;
 }
 
 // Betaflight pid controller, which will be maintained in the future with additional features specialised for current (mini) multirotor usage.
 // Based on 2DOF reference design (matlab)
 
-FAST_CODE float classicPids(const pidProfile_t* pidProfile, int axis, float errorRate, float dynCi, float iDT, float currentPidSetpoint)
+static FAST_CODE void classicPids(int axis, float errorRate, float dynCi, float currentPidSetpoint, float dDelta, const pidAttenuation_t *attenuation)
 {
-    UNUSED(pidProfile);
-    UNUSED(iDT);
+#if !defined(USE_ITERM_RELAX) && !defined(USE_ABSOLUTE_CONTROL)
     UNUSED(currentPidSetpoint);
-    float gyroRateDterm[XYZ_AXIS_COUNT];
-    static float previousGyroRateDterm[XYZ_AXIS_COUNT];
-
+#endif
     rotateITermAndAxisError();
     // --------low-level gyro-based PID based on 2DOF PID controller. ----------
     // 2-DOF PID controller with optional filter on derivative term.
@@ -882,12 +917,11 @@ FAST_CODE float classicPids(const pidProfile_t* pidProfile, int axis, float erro
     float acErrorRate;
 #endif
 
-        const float gyroRate = gyro.gyroADCf[axis];
         const float ITerm = pidData[axis].I;
         float itermErrorRate = errorRate;
-
 #if defined(USE_ITERM_RELAX)
     if (itermRelax && (axis < FD_YAW || itermRelax == ITERM_RELAX_RPY || itermRelax == ITERM_RELAX_RPY_INC)) {
+        const float gyroRate = gyro.gyroADCf[axis];
         const float setpointLpf = pt1FilterApply(&windupLpf[axis], currentPidSetpoint);
         const float setpointHpf = fabsf(currentPidSetpoint - setpointLpf);
         const float itermRelaxFactor = 1 - setpointHpf / ITERM_RELAX_SETPOINT_THRESHOLD;
@@ -948,45 +982,25 @@ FAST_CODE float classicPids(const pidProfile_t* pidProfile, int axis, float erro
 #endif
 
         // -----calculate P component and add Dynamic Part based on stick input
-#ifdef USE_TPA_CURVES
-    pidData[axis].P = (pidCoefficient[axis].Kp * errorRate) * getThrottlePIDAttenuationKp();
-#else
-    pidData[axis].P = (pidCoefficient[axis].Kp * errorRate) * getThrottlePIDAttenuation();
-#endif
+    pidData[axis].P = (pidCoefficient[axis].Kp * errorRate) * attenuation->kp;
     // -----calculate I component
     const float ITermNew = constrainf(ITerm + pidCoefficient[axis].Ki * itermErrorRate * dynCi, -itermLimit, itermLimit);
     const bool outputSaturated = mixerIsOutputSaturated(axis, errorRate);
     if (outputSaturated == false || ABS(ITermNew) < ABS(ITerm)) {
         // Only increase ITerm if output is not saturated
 #ifdef USE_TPA_CURVES
-        pidData[axis].I = ITermNew * getThrottlePIDAttenuationKi();
+        pidData[axis].I = ITermNew * attenuation->ki;
 #else
         pidData[axis].I = ITermNew;
 #endif
     }
 
     // -----calculate D component
-    gyroRateDterm[axis] = dtermNotchApplyFn((filter_t *) &dtermNotch[axis], gyroRate);
-    gyroRateDterm[axis] = dtermLowpassApplyFn((filter_t *) &dtermLowpass[axis], gyroRateDterm[axis]);
-    const float delta = - (gyroRateDterm[axis] - previousGyroRateDterm[axis]) * pidFrequency;
     if (pidCoefficient[axis].Kd > 0) {
-
-        // Divide rate change by dT to get differential (ie dr/dt).
-        // dT is fixed and calculated from the target PID loop time
-        // This is done to avoid DTerm spikes that occur with dynamically
-        // calculated deltaT whenever another task causes the PID
-        // loop execution to be delayed.
-
-#ifdef USE_TPA_CURVES
-        pidData[axis].D = pidCoefficient[axis].Kd * delta * getThrottlePIDAttenuationKd();
-#else
-        pidData[axis].D = pidCoefficient[axis].Kd * delta * getThrottlePIDAttenuation();
-#endif
+        pidData[axis].D = pidCoefficient[axis].Kd * dDelta * attenuation->kd;
     } else {
         pidData[axis].D = 0;
     }
-    previousGyroRateDterm[axis] = gyroRateDterm[axis];
-    return delta;
 }
 
 void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *angleTrim, timeUs_t currentTimeUs)
@@ -1011,6 +1025,21 @@ void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *an
     float errorRate;
     float currentPidSetpoint;
 
+    // the throttle attenuation and the D term are the same work for every axis, so do them once
+    pidAttenuation_t attenuation;
+#if defined(USE_TPA_CURVES)
+    attenuation.kp = getThrottlePIDAttenuationKp();
+    attenuation.ki = getThrottlePIDAttenuationKi();
+    attenuation.kd = getThrottlePIDAttenuationKd();
+#else
+    attenuation.kp = getThrottlePIDAttenuation();
+    attenuation.ki = 1.0f;
+    attenuation.kd = attenuation.kp;
+#endif
+
+    float dDelta[XYZ_AXIS_COUNT];
+    pidDtermDelta(iDT, dDelta);
+
     // ----------PID controller----------
     for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
         currentPidSetpoint = getSetpointRate(axis);
@@ -1043,9 +1072,13 @@ void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *an
             pidProfile->crash_recovery, angleTrim, axis, currentTimeUs, errorRate,
             &currentPidSetpoint, &errorRate);
 
-        float dDelta = activePidController(pidProfile, axis, errorRate, dynCi, iDT, currentPidSetpoint);
+        if (butteredPidsEnabled) {
+            butteredPids(axis, errorRate, dynCi, dDelta[axis], &attenuation);
+        } else {
+            classicPids(axis, errorRate, dynCi, currentPidSetpoint, dDelta[axis], &attenuation);
+        }
 
-        detectAndSetCrashRecovery(pidProfile->crash_recovery, axis, currentTimeUs, dDelta, errorRate);
+        detectAndSetCrashRecovery(pidProfile->crash_recovery, axis, currentTimeUs, dDelta[axis], errorRate);
 
         // -----calculate feedforward component
         // Only enable feedforward for rate mode
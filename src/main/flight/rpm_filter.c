@@ -0,0 +1,226 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#ifdef USE_RPM_FILTER
+
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "config/feature.h"
+
+#include "drivers/pwm_output.h"
+
+#include "pg/pg.h"
+#include "pg/pg_ids.h"
+
+#include "flight/mixer.h"
+#include "flight/pid.h"
+#include "flight/rpm_filter.h"
+
+#include "sensors/esc_sensor.h"
+#include "sensors/gyro.h"
+
+#define SECONDS_PER_MINUTE      60.0f
+#define ERPM_PER_LSB            100.0f
+#define MIN_UPDATE_T            0.001f  // every notch gets new coefficients at least once per millisecond
+
+PG_REGISTER_WITH_RESET_TEMPLATE(rpmFilterConfig_t, rpmFilterConfig, PG_RPM_FILTER_CONFIG, 0);
+
+PG_RESET_TEMPLATE(rpmFilterConfig_t, rpmFilterConfig,
+    .gyro_rpm_notch_harmonics = 3,
+    .gyro_rpm_notch_min = 100,
+    .gyro_rpm_notch_q = 500,
+    .rpm_lpf = 150,
+);
+
+typedef struct rpmNotchFilter_s {
+    uint8_t  harmonics;
+    float    minHz;
+    float    maxHz;
+    float    q;
+    uint32_t looptime;
+
+    // coefficients only, the delay lines are in each gyro's rpmFilterGyroState_t
+    biquadFilter_t notch[MAX_SUPPORTED_MOTORS][RPM_FILTER_MAXHARMONICS];
+} rpmNotchFilter_t;
+
+static FAST_RAM_ZERO_INIT pt1Filter_t rpmFilters[MAX_SUPPORTED_MOTORS];
+static FAST_RAM_ZERO_INIT float motorFrequency[MAX_SUPPORTED_MOTORS];
+static FAST_RAM_ZERO_INIT float filteredMotorErpm[MAX_SUPPORTED_MOTORS];
+static FAST_RAM_ZERO_INIT float erpmToHz;
+static FAST_RAM_ZERO_INIT uint8_t numberMotors;
+static FAST_RAM_ZERO_INIT uint8_t filterUpdatesPerIteration;
+
+static FAST_RAM_ZERO_INIT rpmNotchFilter_t gyroFilterState;
+static FAST_RAM_ZERO_INIT rpmNotchFilter_t *gyroFilter;
+
+// position of the next notch to be recalculated by rpmFilterUpdate
+static FAST_RAM_ZERO_INIT uint8_t currentMotor;
+static FAST_RAM_ZERO_INIT uint8_t currentHarmonic;
+
+static void rpmNotchFilterInit(rpmNotchFilter_t *filter, int harmonics, int minHz, int q, uint32_t looptime)
+{
+    filter->harmonics = harmonics;
+    filter->minHz = minHz;
+    filter->maxHz = 0.48f * 1e6f / looptime; // don't go quite to nyquist to avoid oscillations
+    filter->q = q / 100.0f;
+    filter->looptime = looptime;
+
+    for (int motor = 0; motor < numberMotors; motor++) {
+        for (int i = 0; i < harmonics; i++) {
+            biquadFilterInit(&filter->notch[motor][i], filter->minHz * (i + 1), filter->looptime, filter->q, FILTER_NOTCH);
+        }
+    }
+}
+
+static bool isRpmSourceAvailable(void)
+{
+#ifdef USE_DSHOT_TELEMETRY
+    if (useDshotTelemetry) {
+        return true;
+    }
+#endif
+#ifdef USE_ESC_SENSOR
+    return feature(FEATURE_ESC_SENSOR);
+#else
+    return false;
+#endif
+}
+
+// returns the motor eRPM in units of ERPM_PER_LSB, or 0 when no valid reading is available
+static float getMotorErpm(int motor)
+{
+#ifdef USE_DSHOT_TELEMETRY
+    // bidirectional dshot reports every motor on every frame, so it takes precedence over esc sensor telemetry
+    if (useDshotTelemetry) {
+        return isDshotMotorTelemetryActive(motor) ? getDshotTelemetry(motor) : 0.0f;
+    }
+#endif
+#ifdef USE_ESC_SENSOR
+    const escSensorData_t *escData = getEscSensorData(motor);
+    if (escData && escData->dataAge < ESC_DATA_INVALID) {
+        return escData->rpm;
+    }
+#else
+    UNUSED(motor);
+#endif
+    return 0.0f;
+}
+
+void rpmFilterInit(const rpmFilterConfig_t *config)
+{
+    currentMotor = currentHarmonic = 0;
+    gyroFilter = NULL;
+
+    numberMotors = MIN(getMotorCount(), MAX_SUPPORTED_MOTORS);
+    if (!config->gyro_rpm_notch_harmonics || !numberMotors || !isRpmSourceAvailable()) {
+        return;
+    }
+
+    const uint8_t harmonics = MIN(config->gyro_rpm_notch_harmonics, RPM_FILTER_MAXHARMONICS);
+    rpmNotchFilterInit(&gyroFilterState, harmonics, config->gyro_rpm_notch_min, config->gyro_rpm_notch_q, gyro.targetLooptime);
+    gyroFilter = &gyroFilterState;
+
+    // the rpm lowpass and the notch recalculation both run once per pid loop
+    const float pidLooptimeS = targetPidLooptime * 1e-6f;
+    for (int motor = 0; motor < numberMotors; motor++) {
+        pt1FilterInit(&rpmFilters[motor], pt1FilterGain(config->rpm_lpf, pidLooptimeS));
+        filteredMotorErpm[motor] = 0.0f;
+        motorFrequency[motor] = 0.0f;
+    }
+
+    erpmToHz = ERPM_PER_LSB / SECONDS_PER_MINUTE / (motorConfig()->motorPoleCount / 2.0f);
+
+    // spread the coefficient recalculation over as many pid loops as fit into MIN_UPDATE_T
+    const float loopIterationsPerUpdate = MIN_UPDATE_T / pidLooptimeS;
+    const int numberFilters = numberMotors * harmonics;
+    filterUpdatesPerIteration = MAX(1, lrintf(ceilf(numberFilters / MAX(loopIterationsPerUpdate, 1.0f))));
+}
+
+bool isRpmFilterEnabled(void)
+{
+    return gyroFilter != NULL;
+}
+
+FAST_CODE_NOINLINE float rpmFilterGyro(rpmFilterGyroState_t *state, int axis, float value)
+{
+    if (gyroFilter == NULL) {
+        return value;
+    }
+
+    for (int motor = 0; motor < numberMotors; motor++) {
+        for (int i = 0; i < gyroFilter->harmonics; i++) {
+            // direct form 1, as biquadFilterApplyDF1() but with this gyro's delay lines
+            const biquadFilter_t *notch = &gyroFilter->notch[motor][i];
+            rpmNotchState_t *history = &state->notch[axis][motor][i];
+            const float result = notch->b0 * value + notch->b1 * history->x1 + notch->b2 * history->x2 - notch->a1 * history->y1 - notch->a2 * history->y2;
+
+            history->x2 = history->x1;
+            history->x1 = value;
+            history->y2 = history->y1;
+            history->y1 = result;
+
+            value = result;
+        }
+    }
+    return value;
+}
+
+FAST_CODE_NOINLINE void rpmFilterUpdate(void)
+{
+    if (gyroFilter == NULL) {
+        return;
+    }
+
+    for (int motor = 0; motor < numberMotors; motor++) {
+        filteredMotorErpm[motor] = pt1FilterApply(&rpmFilters[motor], getMotorErpm(motor));
+        if (motor < 4) {
+            DEBUG_SET(DEBUG_RPM_FILTER, motor, lrintf(filteredMotorErpm[motor] * erpmToHz));
+        }
+    }
+
+    for (int i = 0; i < filterUpdatesPerIteration; i++) {
+        if (currentHarmonic == 0) {
+            // latch the motor frequency once per motor so all harmonics of a motor are consistent
+            motorFrequency[currentMotor] = erpmToHz * filteredMotorErpm[currentMotor];
+        }
+
+        const float frequency = constrainf((currentHarmonic + 1) * motorFrequency[currentMotor], gyroFilter->minHz, gyroFilter->maxHz);
+        biquadFilterUpdate(&gyroFilter->notch[currentMotor][currentHarmonic], frequency, gyroFilter->looptime, gyroFilter->q, FILTER_NOTCH);
+
+        if (++currentHarmonic == gyroFilter->harmonics) {
+            currentHarmonic = 0;
+            if (++currentMotor == numberMotors) {
+                currentMotor = 0;
+            }
+        }
+    }
+}
+
+#endif // USE_RPM_FILTER
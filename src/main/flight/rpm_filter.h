@@ -0,0 +1,53 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/axis.h"
+
+#include "drivers/pwm_output_counts.h"
+
+#include "pg/pg.h"
+
+#define RPM_FILTER_MAXHARMONICS 3
+
+typedef struct rpmFilterConfig_s {
+    uint8_t  gyro_rpm_notch_harmonics;   // how many harmonics should be covered with notches? 0 means filter off
+    uint8_t  gyro_rpm_notch_min;         // minimum frequency of the notches
+    uint16_t gyro_rpm_notch_q;           // q of the notches, in hundredths
+    uint16_t rpm_lpf;                    // the cutoff of the lpf on reported motor rpm
+} rpmFilterConfig_t;
+
+PG_DECLARE(rpmFilterConfig_t, rpmFilterConfig);
+
+// delay lines of one notch, the coefficients are shared by every gyro
+typedef struct rpmNotchState_s {
+    float x1, x2, y1, y2;
+} rpmNotchState_t;
+
+// notch history of one gyro, each gyro sensor keeps its own
+typedef struct rpmFilterGyroState_s {
+    rpmNotchState_t notch[XYZ_AXIS_COUNT][MAX_SUPPORTED_MOTORS][RPM_FILTER_MAXHARMONICS];
+} rpmFilterGyroState_t;
+
+void rpmFilterInit(const rpmFilterConfig_t *config);
+float rpmFilterGyro(rpmFilterGyroState_t *state, int axis, float value);
+void rpmFilterUpdate(void);
+bool isRpmFilterEnabled(void);
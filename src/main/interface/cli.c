@@ -96,6 +96,7 @@ extern uint8_t __config_end;
 #include "fc/fc_rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/runtime_config.h"
 
 #include "flight/failsafe.h"
@@ -158,6 +159,7 @@ extern uint8_t __config_end;
 #include "sensors/compass.h"
 #include "sensors/esc_sensor.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_capture.h"
 #include "sensors/sensors.h"
 
 #include "telemetry/frsky_hub.h"
@@ -2213,6 +2215,27 @@ static void cliFlashInfo(char *cmdline)
             layout->sectors, layout->sectorSize, layout->pagesPerSector, layout->pageSize, layout->totalSize, flashfsGetOffset());
 }
 
+#ifdef USE_FLASHFS_INDEX
+static void cliFlashLogs(char *cmdline)
+{
+    UNUSED(cmdline);
+
+    flashfsLog_t logs[16];
+    int count = 0;
+    for (int first = 0; first == 0 || first < count; first += ARRAYLEN(logs)) {
+        count = flashfsListLogs(first, logs, ARRAYLEN(logs));
+        if (count < 0) {
+            cliPrintLine("No log index on this flash chip");
+            return;
+        }
+        for (int i = 0; i < MIN((int)ARRAYLEN(logs), count - first); i++) {
+            cliPrintLinef("Log %d: start=%u, end=%u, size=%u", first + i + 1, logs[i].start, logs[i].end, logs[i].end - logs[i].start);
+        }
+    }
+    cliPrintLinef("%d logs, free space starts at %u", count, flashfsIdentifyStartOfFreeSpace());
+}
+#endif
+
 
 static void cliFlashErase(char *cmdline)
 {
@@ -3041,6 +3064,30 @@ static void cliDumpGyroRegisters(char *cmdline)
 }
 #endif
 
+#ifdef USE_GYRO_CAPTURE
+static void cliGyroCapture(char *cmdline)
+{
+    if (strncasecmp(cmdline, "start", 5) == 0) {
+        gyroCaptureStart(gyro.targetLooptime);
+    } else if (strncasecmp(cmdline, "stop", 4) == 0) {
+        gyroCaptureStop();
+    } else if (strncasecmp(cmdline, "dump", 4) == 0) {
+        // raw sensor units, oldest first
+        const int count = gyroCaptureSampleCount();
+        for (int i = 0; i < count; i++) {
+            int16_t sample[XYZ_AXIS_COUNT];
+            gyroCaptureGetSample(i, sample);
+            cliPrintLinef("%d,%d,%d,%d", i, sample[X], sample[Y], sample[Z]);
+        }
+        return;
+    }
+
+    const char * const stateNames[] = { "IDLE", "RUNNING", "STOPPED" };
+    cliPrintLinef("Gyro capture %s, %d of %d samples every %dus", stateNames[gyroCaptureGetState()],
+        gyroCaptureSampleCount(), GYRO_CAPTURE_SAMPLE_COUNT, gyroCaptureSampleIntervalUs());
+}
+#endif
+
 
 static int parseOutputIndex(char *pch, bool allowAllEscs) {
     int outputIndex = atoi(pch);
@@ -4167,9 +4214,45 @@ static void cliStatus(char *cmdline)
 }
 
 #ifndef SKIP_TASK_STATISTICS
+#ifdef USE_TASK_HISTOGRAM
+static void cliPrintTaskHistogram(const char *name, const uint16_t *histogram)
+{
+    cliPrintf("     %s", name);
+    for (int i = 0; i < TASK_HISTOGRAM_BUCKET_COUNT; i++) {
+        cliPrintf(" %5d", histogram[i]);
+    }
+    cliPrintLinefeed();
+}
+
+static void cliTasksHistogram(void)
+{
+    cliPrintLinef("Task histograms in cpu cycles, bucket n counts values below 2^(n+%d), %d cycles/us", TASK_HISTOGRAM_SHIFT, clockMicrosToCycles(1));
+    for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+        cfTaskInfo_t taskInfo;
+        getTaskInfo(taskId, &taskInfo);
+        if (taskInfo.isEnabled) {
+            cfTaskHistogram_t taskHistogram;
+            getTaskHistogram(taskId, &taskHistogram);
+            cliPrintLinef("%02d - (%15s) wcet %d cycles", taskId, taskInfo.taskName, taskHistogram.maxExecutionCycles);
+            cliPrintTaskHistogram("exec  ", taskHistogram.executionHistogram);
+            cliPrintTaskHistogram("jitter", taskHistogram.jitterHistogram);
+
+            schedulerResetTaskHistogram(taskId);
+        }
+    }
+}
+#endif
+
 static void cliTasks(char *cmdline)
 {
+#ifdef USE_TASK_HISTOGRAM
+    if (strncasecmp(cmdline, "histogram", 9) == 0) {
+        cliTasksHistogram();
+        return;
+    }
+#else
     UNUSED(cmdline);
+#endif
     int maxLoadSum = 0;
     int averageLoadSum = 0;
 
@@ -4247,6 +4330,27 @@ static void cliVersion(char *cmdline)
 #endif
 }
 
+#ifdef USE_RC_LATENCY
+static void cliRcLatency(char *cmdline)
+{
+    if (strncasecmp(cmdline, "reset", 5) == 0) {
+        rcLatencyReset();
+        return;
+    }
+
+    cliPrintLinef("RC frame to motor output latency in us, bucket n counts delays below 2^(n+%d) us", RC_LATENCY_HISTOGRAM_SHIFT);
+    for (rcLatencyStage_e stage = 0; stage < RC_LATENCY_STAGE_COUNT; stage++) {
+        const rcLatencyStats_t *stats = rcLatencyGetStats(stage);
+        cliPrintf("%12s count %6d avg %5d max %5d:", rcLatencyStageNames[stage], stats->count,
+            stats->count ? stats->sumUs / stats->count : 0, stats->maxUs);
+        for (int i = 0; i < RC_LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+            cliPrintf(" %5d", stats->histogram[i]);
+        }
+        cliPrintLinefeed();
+    }
+}
+#endif
+
 #ifdef USE_RC_SMOOTHING_FILTER
 static void cliRcSmoothing(char *cmdline)
 {
@@ -4283,6 +4387,19 @@ static void cliRcSmoothing(char *cmdline)
                 cliPrintLine("manual)");
             }
         }
+#ifdef USE_RC_PREDICTION
+    } else if (rxConfig()->rc_smoothing_type == RC_SMOOTHING_TYPE_PREDICTIVE) {
+        cliPrintLine("PREDICTIVE");
+        const int avgRxFrameUs = rcSmoothingGetValue(RC_SMOOTHING_VALUE_AVERAGE_FRAME);
+        cliPrint("# Detected RX frame rate: ");
+        if (avgRxFrameUs == 0) {
+            cliPrintLine("NO SIGNAL");
+        } else {
+            cliPrintLinef("%d.%03dms", avgRxFrameUs / 1000, avgRxFrameUs % 1000);
+            cliPrintLinef("# RX frame jitter: %dus", rcSmoothingGetValue(RC_SMOOTHING_VALUE_FRAME_JITTER));
+        }
+        cliPrintLinef("# Dropped frames: %d", rcSmoothingGetValue(RC_SMOOTHING_VALUE_DROPPED_FRAMES));
+#endif
     } else {
         cliPrintLine("INTERPOLATION");
     }
@@ -5030,6 +5147,9 @@ const clicmd_t cmdTable[] = {
 #ifdef USE_FLASHFS
     CLI_COMMAND_DEF("flash_erase", "erase flash chip", NULL, cliFlashErase),
     CLI_COMMAND_DEF("flash_info", "show flash chip info", NULL, cliFlashInfo),
+#ifdef USE_FLASHFS_INDEX
+    CLI_COMMAND_DEF("flash_logs", "list the logs on the flash chip", NULL, cliFlashLogs),
+#endif
 #ifdef USE_FLASH_TOOLS
     CLI_COMMAND_DEF("flash_read", NULL, "<length> <address>", cliFlashRead),
     CLI_COMMAND_DEF("flash_write", NULL, "<address> <message>", cliFlashWrite),
@@ -5046,6 +5166,9 @@ const clicmd_t cmdTable[] = {
 #ifdef USE_GPS
     CLI_COMMAND_DEF("gpspassthrough", "passthrough gps to serial", NULL, cliGpsPassthrough),
 #endif
+#ifdef USE_GYRO_CAPTURE
+    CLI_COMMAND_DEF("gyro_capture", "capture raw gyro samples to RAM", "[start|stop|dump]", cliGyroCapture),
+#endif
 #if defined(USE_GYRO_REGISTER_DUMP) && !defined(SIMULATOR_BUILD)
     CLI_COMMAND_DEF("gyroregisters", "dump gyro config registers contents", NULL, cliDumpGyroRegisters),
 #endif
@@ -5082,6 +5205,9 @@ const clicmd_t cmdTable[] = {
 #endif
     CLI_COMMAND_DEF("profile", "change profile", "[<index>]", cliProfile),
     CLI_COMMAND_DEF("rateprofile", "change rate profile", "[<index>]", cliRateProfile),
+#ifdef USE_RC_LATENCY
+    CLI_COMMAND_DEF("rc_latency", "show RC frame to motor output latency", "[reset]", cliRcLatency),
+#endif
 #ifdef USE_RC_SMOOTHING_FILTER
     CLI_COMMAND_DEF("rc_smoothing_info", "show rc_smoothing operational settings", NULL, cliRcSmoothing),
 #endif // USE_RC_SMOOTHING_FILTER
@@ -5113,8 +5239,12 @@ const clicmd_t cmdTable[] = {
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
 #ifndef SKIP_TASK_STATISTICS
+#ifdef USE_TASK_HISTOGRAM
+    CLI_COMMAND_DEF("tasks", "show task stats", "[histogram]", cliTasks),
+#else
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
 #endif
+#endif
 #ifdef USE_TIMER_MGMT
     CLI_COMMAND_DEF("timer", "show timer configuration", NULL, cliTimer),
 #endif
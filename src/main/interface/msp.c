@@ -54,6 +54,7 @@
 #include "drivers/serial.h"
 #include "drivers/serial_escserial.h"
 #include "drivers/system.h"
+#include "drivers/time.h"
 #include "drivers/transponder_ir.h"
 #include "drivers/usb_msc.h"
 #include "drivers/vtx_common.h"
@@ -65,6 +66,7 @@
 #include "fc/fc_rc.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/rc_modes.h"
 #include "fc/runtime_config.h"
 
@@ -120,6 +122,7 @@
 #include "sensors/esc_sensor.h"
 #include "sensors/compass.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_capture.h"
 #include "sensors/rangefinder.h"
 #include "sensors/sensors.h"
 
@@ -324,7 +327,7 @@ static void serializeDataflashSummaryReply(sbuf_t *dst)
         const flashGeometry_t *geometry = flashfsGetGeometry();
         sbufWriteU8(dst, flags);
         sbufWriteU32(dst, geometry->sectors);
-        sbufWriteU32(dst, geometry->totalSize);
+        sbufWriteU32(dst, flashfsGetSize()); // Less than the chip size when a sector holds the log index
         sbufWriteU32(dst, flashfsGetOffset()); // Effectively the current number of bytes stored on the volume
     } else
 #endif
@@ -1213,12 +1216,14 @@ bool mspProcessOutCommand(uint8_t cmdMSP, sbuf_t *dst)
         sbufWriteU8(dst, 1); // Rate numerator, not used anymore
         sbufWriteU8(dst, blackboxGetRateDenom());
         sbufWriteU16(dst, blackboxConfig()->p_ratio);
+        sbufWriteU32(dst, blackboxConfig()->fields_disabled_mask);
 #else
         sbufWriteU8(dst, 0); // Blackbox not supported
         sbufWriteU8(dst, 0);
         sbufWriteU8(dst, 0);
         sbufWriteU8(dst, 0);
         sbufWriteU16(dst, 0);
+        sbufWriteU32(dst, 0);
 #endif
         break;
 
@@ -1477,6 +1482,97 @@ static mspResult_e mspFcProcessOutCommandWithArg(uint8_t cmdMSP, sbuf_t *src, sb
         }
 
         break;
+#if defined(USE_TASK_HISTOGRAM) && !defined(SKIP_TASK_STATISTICS)
+    case MSP_TASK_HISTOGRAM:
+        {
+            const cfTaskId_e taskId = sbufBytesRemaining(src) ? sbufReadU8(src) : TASK_GYROPID;
+            if (taskId >= TASK_COUNT) {
+                return MSP_RESULT_ERROR;
+            }
+            cfTaskHistogram_t taskHistogram;
+            getTaskHistogram(taskId, &taskHistogram);
+
+            sbufWriteU8(dst, taskId);
+            sbufWriteU8(dst, TASK_HISTOGRAM_BUCKET_COUNT);
+            sbufWriteU8(dst, TASK_HISTOGRAM_SHIFT);
+            sbufWriteU16(dst, clockMicrosToCycles(1));
+            sbufWriteU32(dst, taskHistogram.maxExecutionCycles);
+            for (int i = 0; i < TASK_HISTOGRAM_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, taskHistogram.executionHistogram[i]);
+            }
+            for (int i = 0; i < TASK_HISTOGRAM_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, taskHistogram.jitterHistogram[i]);
+            }
+        }
+        break;
+#endif
+#ifdef USE_GYRO_CAPTURE
+    case MSP_GYRO_CAPTURE:
+        {
+            // Pages through the capture, oldest sample first, as many samples as fit the reply
+            const int count = gyroCaptureSampleCount();
+            const int start = sbufBytesRemaining(src) >= 2 ? MIN(sbufReadU16(src), count) : 0;
+            const int samples = MIN(MIN(count - start, UINT8_MAX), (sbufBytesRemaining(dst) - 10) / (int)(XYZ_AXIS_COUNT * sizeof(int16_t)));
+
+            sbufWriteU8(dst, gyroCaptureGetState());
+            sbufWriteU16(dst, count);
+            sbufWriteU32(dst, gyroCaptureSampleIntervalUs());
+            sbufWriteU16(dst, start);
+            sbufWriteU8(dst, samples);
+            for (int i = start; i < start + samples; i++) {
+                int16_t sample[XYZ_AXIS_COUNT];
+                gyroCaptureGetSample(i, sample);
+                for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                    sbufWriteU16(dst, sample[axis]);
+                }
+            }
+        }
+        break;
+#endif
+#ifdef USE_FLASHFS_INDEX
+    case MSP_DATAFLASH_LOGS:
+        {
+            // Pages through the logs, oldest first, as many logs as fit the reply
+            const int first = sbufBytesRemaining(src) >= 2 ? sbufReadU16(src) : 0;
+            flashfsLog_t logs[16];
+            const int maxCount = MIN((int)ARRAYLEN(logs), (sbufBytesRemaining(dst) - 5) / (int)(2 * sizeof(uint32_t)));
+            const int count = flashfsListLogs(first, logs, maxCount);
+            if (count < 0) {
+                return MSP_RESULT_ERROR;
+            }
+            const int listed = constrain(count - first, 0, maxCount);
+
+            sbufWriteU16(dst, count);
+            sbufWriteU16(dst, first);
+            sbufWriteU8(dst, listed);
+            for (int i = 0; i < listed; i++) {
+                sbufWriteU32(dst, logs[i].start);
+                sbufWriteU32(dst, logs[i].end);
+            }
+        }
+        break;
+#endif
+#ifdef USE_RC_LATENCY
+    case MSP_RC_LATENCY:
+        {
+            const rcLatencyStage_e stage = sbufBytesRemaining(src) ? sbufReadU8(src) : RC_LATENCY_STAGE_RX_FRAME;
+            if (stage >= RC_LATENCY_STAGE_COUNT) {
+                return MSP_RESULT_ERROR;
+            }
+            const rcLatencyStats_t *stats = rcLatencyGetStats(stage);
+
+            sbufWriteU8(dst, stage);
+            sbufWriteU8(dst, RC_LATENCY_HISTOGRAM_BUCKET_COUNT);
+            sbufWriteU8(dst, RC_LATENCY_HISTOGRAM_SHIFT);
+            sbufWriteU32(dst, stats->count);
+            sbufWriteU32(dst, stats->count ? stats->sumUs / stats->count : 0);
+            sbufWriteU32(dst, stats->maxUs);
+            for (int i = 0; i < RC_LATENCY_HISTOGRAM_BUCKET_COUNT; i++) {
+                sbufWriteU16(dst, stats->histogram[i]);
+            }
+        }
+        break;
+#endif
     default:
         return MSP_RESULT_CMD_UNKNOWN;
     }
@@ -1504,6 +1600,53 @@ static void mspFcDataFlashReadCommand(sbuf_t *dst, sbuf_t *src)
 
     serializeDataflashReadReply(dst, readAddress, readLength, useLegacyFormat, allowCompression);
 }
+
+static uint32_t dataflashStreamAddress;
+static uint32_t dataflashStreamRemaining;
+static bool dataflashStreamEnded;
+
+// Each frame holds the address followed by as much data as the frame allows, a frame with no data ends the stream
+static bool mspFcDataFlashStreamFrame(sbuf_t *dst)
+{
+    if (dataflashStreamEnded) {
+        return false;
+    }
+
+    const uint32_t readLength = MIN(dataflashStreamRemaining, (uint32_t)sbufBytesRemaining(dst) - sizeof(uint32_t));
+    sbufWriteU32(dst, dataflashStreamAddress);
+    const int bytesRead = readLength ? flashfsReadAbs(dataflashStreamAddress, sbufPtr(dst), readLength) : 0;
+    sbufAdvance(dst, bytesRead);
+
+    dataflashStreamAddress += bytesRead;
+    dataflashStreamRemaining -= bytesRead;
+    // A read that fails ends the stream early, the host can ask again from the last address
+    dataflashStreamEnded = bytesRead == 0;
+
+    return true;
+}
+
+static void mspFcDataFlashStreamStart(serialPort_t *port)
+{
+    mspSerialStreamStart(port, MSP2_DATAFLASH_STREAM, mspFcDataFlashStreamFrame);
+}
+
+static void mspFcDataFlashStreamCommand(sbuf_t *dst, sbuf_t *src, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    const uint32_t flashfsSize = flashfsGetSize();
+    const uint32_t address = MIN(sbufReadU32(src), flashfsSize);
+    const uint32_t length = MIN(sbufReadU32(src), flashfsSize - address);
+
+    dataflashStreamAddress = address;
+    dataflashStreamRemaining = length;
+    dataflashStreamEnded = false;
+
+    // The frames follow this reply once it has been sent
+    sbufWriteU32(dst, address);
+    sbufWriteU32(dst, length);
+    if (mspPostProcessFn) {
+        *mspPostProcessFn = mspFcDataFlashStreamStart;
+    }
+}
 #endif
 
 #ifdef USE_OSD_SLAVE
@@ -1980,6 +2123,9 @@ mspResult_e mspProcessInCommand(uint8_t cmdMSP, sbuf_t *src)
                 // p_ratio not specified in MSP, so calculate it from old rateNum and rateDenom
                 blackboxConfigMutable()->p_ratio = blackboxCalculatePDenom(rateNum, rateDenom);
             }
+            if (sbufBytesRemaining(src) >= 4) {
+                blackboxConfigMutable()->fields_disabled_mask = sbufReadU32(src);
+            }
         }
         break;
 #endif
@@ -2534,6 +2680,16 @@ mspResult_e mspFcProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostPro
     // initialize reply by default
     reply->cmd = cmd->cmd;
 
+#ifdef USE_FLASHFS
+    if (cmd->cmd == MSP2_DATAFLASH_STREAM) {
+        if (sbufBytesRemaining(src) < 2 * (int)sizeof(uint32_t)) {
+            ret = MSP_RESULT_ERROR;
+        } else {
+            mspFcDataFlashStreamCommand(dst, src, mspPostProcessFn);
+            ret = MSP_RESULT_ACK;
+        }
+    } else
+#endif
     if (mspCommonProcessOutCommand(cmdMSP, dst, mspPostProcessFn)) {
         ret = MSP_RESULT_ACK;
     } else if (mspProcessOutCommand(cmdMSP, dst)) {
@@ -58,6 +58,7 @@ struct serialPort_s;
 typedef void (*mspPostProcessFnPtr)(struct serialPort_s *port); // msp post process function, used for gracefully handling reboots, etc.
 typedef mspResult_e (*mspProcessCommandFnPtr)(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn);
 typedef void (*mspProcessReplyFnPtr)(mspPacket_t *cmd);
+typedef bool (*mspStreamFnPtr)(sbuf_t *dst); // writes the next frame of a stream, returns false once the stream has ended
 
 
 void mspInit(void);
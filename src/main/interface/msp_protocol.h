@@ -337,3 +337,10 @@
 #define MSP_IMUF_CONFIG          227    //out message
 #define MSP_SET_IMUF_CONFIG      228    //in message
 #define MSP_IMUF_INFO            229    //out message
+#define MSP_TASK_HISTOGRAM       230    //out message         Execution time and jitter histograms of one task
+#define MSP_GYRO_CAPTURE         231    //out message         Raw gyro samples held by the RAM capture
+#define MSP_DATAFLASH_LOGS       232    //out message         Start and end offsets of the logs in the dataflash index
+#define MSP_RC_LATENCY           233    //out message         Latency statistics of one stage from RC frame to motor output
+
+// MSPv2 only, the command ids don't fit a MSPv1 frame
+#define MSP2_DATAFLASH_STREAM    0x3000 //out message         Dataflash contents sent as a stream of frames without a request for each frame
@@ -117,6 +117,9 @@ typedef enum {
     TABLE_RC_SMOOTHING_INPUT_TYPE,
     TABLE_RC_SMOOTHING_DERIVATIVE_TYPE,
 #endif // USE_RC_SMOOTHING_FILTER
+#ifdef USE_DYN_NOTCH_SDFT
+    TABLE_DYN_NOTCH_ANALYSER,
+#endif
     LOOKUP_TABLE_COUNT
 } lookupTableIndex_e;
 
@@ -58,7 +58,14 @@
     #define ONLY_EXPOSE_FOR_TESTING static
 #endif
 
+#ifndef AFATFS_NUM_CACHE_SECTORS
+#if defined(STM32F4) || defined(STM32F7)
+// Room for a run of file sectors to queue up behind a multi-block write while metadata sectors wait their turn
+#define AFATFS_NUM_CACHE_SECTORS 16
+#else
 #define AFATFS_NUM_CACHE_SECTORS 8
+#endif
+#endif
 
 // FAT filesystems are allowed to differ from these parameters, but we choose not to support those weird filesystems:
 #define AFATFS_SECTOR_SIZE  512
@@ -826,12 +833,13 @@ static int afatfs_allocateCacheSector(uint32_t sectorIndex)
 }
 
 /**
- * Attempt to flush dirty cache pages out to the sdcard, returning true if all flushable data has been flushed.
+ * Flush the oldest flushable sector, or when streaming, the sector that continues the card's multi-block write.
+ *
+ * Returns true if all flushable data has been flushed.
  */
-bool afatfs_flush(void)
+static bool afatfs_flushSectors(bool streaming)
 {
     if (afatfs.cacheDirtyEntries > 0) {
-        // Flush the oldest flushable sector
         uint32_t earliestSectorTime = 0xFFFFFFFF;
         int earliestSectorIndex = -1;
 
@@ -844,6 +852,28 @@ bool afatfs_flush(void)
             }
         }
 
+#ifdef AFATFS_MIN_MULTIPLE_BLOCK_WRITE_COUNT
+        /*
+         * A file appending into a pre-erased supercluster fills the sector the card expects next while it holds it
+         * locked. Writing any other sector would end the multi-block write and lose the pre-erase, so leave the FAT
+         * and directory sectors queued behind it until the cache starts to fill up.
+         */
+        uint32_t multiWriteNextSector;
+        if (streaming && sdcard_getMultiWriteNextBlock(&multiWriteNextSector)) {
+            afatfsCacheBlockDescriptor_t *next = afatfs_findCacheSector(multiWriteNextSector);
+
+            if (next && next->state != AFATFS_CACHE_STATE_EMPTY) {
+                if (next->state == AFATFS_CACHE_STATE_DIRTY && !next->locked) {
+                    earliestSectorIndex = next - afatfs.cacheDescriptor;
+                } else if (next->locked && afatfs.cacheDirtyEntries < AFATFS_NUM_CACHE_SECTORS / 2) {
+                    return false;
+                }
+            }
+        }
+#else
+        UNUSED(streaming);
+#endif
+
         if (earliestSectorIndex > -1) {
             afatfs_cacheFlushSector(earliestSectorIndex);
 
@@ -855,6 +885,14 @@ bool afatfs_flush(void)
     return true;
 }
 
+/**
+ * Attempt to flush dirty cache pages out to the sdcard, returning true if all flushable data has been flushed.
+ */
+bool afatfs_flush(void)
+{
+    return afatfs_flushSectors(false);
+}
+
 /**
  * Returns true if either the freefile or the regular cluster pool has been exhausted during a previous write operation.
  */
@@ -2119,7 +2157,7 @@ afatfsOperationStatus_e afatfs_fseek(afatfsFilePtr_t file, int32_t offset, afatf
         break;
 
         case AFATFS_SEEK_SET:
-            FALLTHROUGH;
+        break;
     }
 
     // Now we have a SEEK_SET with a positive offset. Begin by seeking to the start of the file
@@ -3531,7 +3569,7 @@ void afatfs_poll(void)
 {
     // Only attempt to continue FS operations if the card is present & ready, otherwise we would just be wasting time
     if (sdcard_poll()) {
-        afatfs_flush();
+        afatfs_flushSectors(true);
 
         switch (afatfs.filesystemState) {
             case AFATFS_FILESYSTEM_STATE_INITIALIZATION:
@@ -32,10 +32,16 @@
  * and make calls through that, at the moment flashfs just calls m25p16_* routines explicitly.
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
 
+#include "platform.h"
+
+#include "common/crc.h"
+#include "common/maths.h"
+
 #include "drivers/flash.h"
 
 #include "io/flashfs.h"
@@ -54,6 +60,26 @@ static uint8_t bufferHead = 0, bufferTail = 0;
 // The position of the buffer's tail in the overall flash address space:
 static uint32_t tailAddress = 0;
 
+/* Logs start on a free block boundary, and the free space scan examines the start of each block. We can choose
+ * whatever power of 2 size we like, which determines how much wastage of free space we'll have at the end of the
+ * last written data. But smaller blocksizes will require more searching.
+ */
+#define FLASHFS_FREE_BLOCK_SIZE 2048 // XXX This can't be smaller than page size for underlying flash device.
+
+#ifdef USE_FLASHFS_INDEX
+typedef enum {
+    FLASHFS_INDEX_NONE = 0,     // chip is too small or not NOR, or the index sector holds log data
+    FLASHFS_INDEX_ERASED,       // index sector is erased and gets its header when the next log starts
+    FLASHFS_INDEX_VALID
+} flashfsIndexState_e;
+
+static flashfsIndexState_e indexState = FLASHFS_INDEX_NONE;
+static uint32_t indexNextRecord;    // slot of the next record to program
+static uint32_t indexHeadAddress;   // offset of the last record, the start of free space while no log is open
+
+static void flashfsIndexErased(void);
+#endif
+
 static void flashfsClearBuffer(void)
 {
     bufferTail = bufferHead = 0;
@@ -76,6 +102,10 @@ void flashfsEraseCompletely(void)
     flashfsClearBuffer();
 
     flashfsSetTailAddress(0);
+
+#ifdef USE_FLASHFS_INDEX
+    flashfsIndexErased();
+#endif
 }
 
 /**
@@ -122,6 +152,12 @@ bool flashfsIsSupported(void)
 
 uint32_t flashfsGetSize(void)
 {
+#ifdef USE_FLASHFS_INDEX
+    if (indexState != FLASHFS_INDEX_NONE) {
+        // The last sector holds the index
+        return flashGetGeometry()->totalSize - flashGetGeometry()->sectorSize;
+    }
+#endif
     return flashGetGeometry()->totalSize;
 }
 
@@ -219,29 +255,28 @@ static uint32_t flashfsWriteBuffers(uint8_t const **buffers, uint32_t *bufferSiz
 
         for (i = 0; i < bufferCount; i++) {
             if (bufferSizes[i] > 0) {
-                // Is buffer larger than our write limit? Write our limit out of it
-                if (bufferSizes[i] >= bytesRemainThisIteration) {
-                    flashPageProgramContinue(buffers[i], bytesRemainThisIteration);
+                // Write no more than our limit out of this buffer
+                const uint32_t bytesToWrite = MIN(bufferSizes[i], bytesRemainThisIteration);
+                const uint32_t bytesWritten = flashPageProgramContinue(buffers[i], bytesToWrite);
 
-                    buffers[i] += bytesRemainThisIteration;
-                    bufferSizes[i] -= bytesRemainThisIteration;
+                buffers[i] += bytesWritten;
+                bufferSizes[i] -= bytesWritten;
+                bytesRemainThisIteration -= bytesWritten;
 
-                    bytesRemainThisIteration = 0;
+                // the device took less than asked for, the rest goes into the next page program
+                if (bytesRemainThisIteration == 0 || bytesWritten < bytesToWrite) {
                     break;
-                } else {
-                    // We'll still have more to write after finishing this buffer off
-                    flashPageProgramContinue(buffers[i], bufferSizes[i]);
-
-                    bytesRemainThisIteration -= bufferSizes[i];
-
-                    buffers[i] += bufferSizes[i];
-                    bufferSizes[i] = 0;
                 }
             }
         }
 
         flashPageProgramFinish();
 
+        bytesTotalThisIteration -= bytesRemainThisIteration;
+        if (bytesTotalThisIteration == 0) {
+            break;
+        }
+
         bytesTotalRemaining -= bytesTotalThisIteration;
 
         // Advance the cursor in the file system to match the bytes we wrote
@@ -313,6 +348,9 @@ static void flashfsAdvanceTailInBuffer(uint32_t delta)
 /**
  * If the flash is ready to accept writes, flush the buffer to it.
  *
+ * Drivers that send pages by DMA report busy until the transfer and the chip's program cycle complete, so each call
+ * either hands one page over and returns, or checks the busy state and returns.
+ *
  * Returns true if all data in the buffer has been flushed to the device, or false if
  * there is still data to be written (call flush again later).
  */
@@ -493,39 +531,29 @@ int flashfsReadAbs(uint32_t address, uint8_t *buffer, unsigned int len)
 }
 
 /**
- * Find the offset of the start of the free space on the device (or the size of the device if it is full).
+ * Find the start of the free space in [start...end) by examining the beginning of blocks with a binary search,
+ * looking for ones that appear to be erased. We can achieve this with good accuracy because an erased block
+ * is all bits set to 1, which pretty much never appears in reasonable size substrings of blackbox logs.
+ *
+ * Returns end if there is no free space in the range.
  */
-int flashfsIdentifyStartOfFreeSpace(void)
+static uint32_t flashfsScanForFreeSpace(uint32_t start, uint32_t end)
 {
-    /* Find the start of the free space on the device by examining the beginning of blocks with a binary search,
-     * looking for ones that appear to be erased. We can achieve this with good accuracy because an erased block
-     * is all bits set to 1, which pretty much never appears in reasonable size substrings of blackbox logs.
-     *
-     * To do better we might write a volume header instead, which would mark how much free space remains. But keeping
-     * a header up to date while logging would incur more writes to the flash, which would consume precious write
-     * bandwidth and block more often.
-     */
-
     enum {
-        /* We can choose whatever power of 2 size we like, which determines how much wastage of free space we'll have
-         * at the end of the last written data. But smaller blocksizes will require more searching.
-         */
-        FREE_BLOCK_SIZE = 2048, // XXX This can't be smaller than page size for underlying flash device.
-
         /* We don't expect valid data to ever contain this many consecutive uint32_t's of all 1 bits: */
         FREE_BLOCK_TEST_SIZE_INTS = 4, // i.e. 16 bytes
         FREE_BLOCK_TEST_SIZE_BYTES = FREE_BLOCK_TEST_SIZE_INTS * sizeof(uint32_t)
     };
 
-    STATIC_ASSERT(FREE_BLOCK_SIZE >= FLASH_MAX_PAGE_SIZE, FREE_BLOCK_SIZE_too_small);
+    STATIC_ASSERT(FLASHFS_FREE_BLOCK_SIZE >= FLASH_MAX_PAGE_SIZE, FREE_BLOCK_SIZE_too_small);
 
     union {
         uint8_t bytes[FREE_BLOCK_TEST_SIZE_BYTES];
         uint32_t ints[FREE_BLOCK_TEST_SIZE_INTS];
     } testBuffer;
 
-    int left = 0; // Smallest block index in the search region
-    int right = flashfsGetSize() / FREE_BLOCK_SIZE; // One past the largest block index in the search region
+    int left = start / FLASHFS_FREE_BLOCK_SIZE; // Smallest block index in the search region
+    int right = end / FLASHFS_FREE_BLOCK_SIZE; // One past the largest block index in the search region
     int mid;
     int result = right;
     int i;
@@ -534,7 +562,7 @@ int flashfsIdentifyStartOfFreeSpace(void)
     while (left < right) {
         mid = (left + right) / 2;
 
-        if (flashReadBytes(mid * FREE_BLOCK_SIZE, testBuffer.bytes, FREE_BLOCK_TEST_SIZE_BYTES) < FREE_BLOCK_TEST_SIZE_BYTES) {
+        if (flashReadBytes(mid * FLASHFS_FREE_BLOCK_SIZE, testBuffer.bytes, FREE_BLOCK_TEST_SIZE_BYTES) < FREE_BLOCK_TEST_SIZE_BYTES) {
             // Unexpected timeout from flash, so bail early (reporting the device fuller than it really is)
             break;
         }
@@ -560,7 +588,20 @@ int flashfsIdentifyStartOfFreeSpace(void)
         }
     }
 
-    return result * FREE_BLOCK_SIZE;
+    return result * FLASHFS_FREE_BLOCK_SIZE;
+}
+
+/**
+ * Find the offset of the start of the free space on the device (or the size of the device if it is full).
+ */
+int flashfsIdentifyStartOfFreeSpace(void)
+{
+#ifdef USE_FLASHFS_INDEX
+    if (indexState == FLASHFS_INDEX_VALID) {
+        return indexHeadAddress;
+    }
+#endif
+    return flashfsScanForFreeSpace(0, flashfsGetSize());
 }
 
 /**
@@ -588,11 +629,333 @@ void flashfsClose(void)
     }
 }
 
+#ifdef USE_FLASHFS_INDEX
+/*
+ * The log index is a journal of 8 byte records in the last erase sector of the chip. A header record marks the
+ * sector as an index, then each log appends a start record when it opens and an end record once it is flushed.
+ * NOR flash can program the erased slots that follow without an erase, so the sector is only erased when the
+ * journal fills up. At boot the start of free space is read from the last record, found by a binary search for the
+ * first erased slot, so the cost depends on the journal size rather than the chip size and logs can be listed
+ * without scanning their data.
+ */
+#define FLASHFS_INDEX_MAGIC                 0x58495346 // "FSIX"
+#define FLASHFS_INDEX_VERSION               1
+#define FLASHFS_INDEX_MIN_SECTORS           64 // smaller chips keep the free space scan rather than give up a sector
+#define FLASHFS_INDEX_WRITE_TIMEOUT_MILLIS  10
+#define FLASHFS_INDEX_ERASE_TIMEOUT_MILLIS  5000
+
+typedef enum {
+    FLASHFS_INDEX_RECORD_HEADER = 1,
+    FLASHFS_INDEX_RECORD_LOG_START,
+    FLASHFS_INDEX_RECORD_LOG_END,
+    FLASHFS_INDEX_RECORD_HEAD,          // start of free space carried over when the journal is erased
+} flashfsIndexRecordType_e;
+
+typedef struct flashfsIndexRecord_s {
+    uint32_t offset;
+    uint8_t type;
+    uint8_t version;
+    uint8_t reserved;
+    uint8_t checksum;
+} flashfsIndexRecord_t;
+
+STATIC_ASSERT(sizeof(flashfsIndexRecord_t) == 8, flashfsIndexRecord_size);
+
+static bool flashfsIndexIsSupported(void)
+{
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    return geometry->flashType == FLASH_TYPE_NOR && geometry->sectors >= FLASHFS_INDEX_MIN_SECTORS;
+}
+
+static uint32_t flashfsIndexCapacity(void)
+{
+    return flashGetGeometry()->sectorSize / sizeof(flashfsIndexRecord_t);
+}
+
+static uint32_t flashfsIndexRecordAddress(uint32_t slot)
+{
+    const flashGeometry_t *geometry = flashGetGeometry();
+
+    return geometry->totalSize - geometry->sectorSize + slot * sizeof(flashfsIndexRecord_t);
+}
+
+static uint8_t flashfsIndexChecksum(const flashfsIndexRecord_t *record)
+{
+    return crc8_dvb_s2_update(0, record, offsetof(flashfsIndexRecord_t, checksum));
+}
+
+static bool flashfsIndexRecordIsErased(const flashfsIndexRecord_t *record)
+{
+    const uint8_t *bytes = (const uint8_t *)record;
+
+    for (unsigned i = 0; i < sizeof(*record); i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool flashfsIndexRecordIsValid(const flashfsIndexRecord_t *record)
+{
+    // A record torn by a power loss while it was programmed fails the checksum
+    return record->version == FLASHFS_INDEX_VERSION && record->checksum == flashfsIndexChecksum(record);
+}
+
+static bool flashfsIndexRead(uint32_t slot, flashfsIndexRecord_t *record)
+{
+    return flashReadBytes(flashfsIndexRecordAddress(slot), (uint8_t *)record, sizeof(*record)) == sizeof(*record);
+}
+
+static bool flashfsIndexAppend(flashfsIndexRecordType_e type, uint32_t offset)
+{
+    if (indexNextRecord >= flashfsIndexCapacity() || !flashWaitForReady(FLASHFS_INDEX_WRITE_TIMEOUT_MILLIS)) {
+        return false;
+    }
+
+    flashfsIndexRecord_t record = {
+        .offset = offset,
+        .type = type,
+        .version = FLASHFS_INDEX_VERSION,
+    };
+    record.checksum = flashfsIndexChecksum(&record);
+
+    flashPageProgram(flashfsIndexRecordAddress(indexNextRecord), (const uint8_t *)&record, sizeof(record));
+    indexNextRecord++;
+
+    return true;
+}
+
+// Start a journal in the erased index sector with the given start of free space
+static void flashfsIndexBegin(uint32_t head)
+{
+    indexNextRecord = 0;
+    if (flashfsIndexAppend(FLASHFS_INDEX_RECORD_HEADER, FLASHFS_INDEX_MAGIC) && flashfsIndexAppend(FLASHFS_INDEX_RECORD_HEAD, head)) {
+        indexState = FLASHFS_INDEX_VALID;
+        indexHeadAddress = head;
+    }
+}
+
+// Erase the index sector and start the journal again, blocks until the erase completes
+static void flashfsIndexRestart(uint32_t head)
+{
+    flashEraseSector(flashfsIndexRecordAddress(0));
+    flashWaitForReady(FLASHFS_INDEX_ERASE_TIMEOUT_MILLIS);
+
+    indexState = FLASHFS_INDEX_ERASED;
+    flashfsIndexBegin(head);
+}
+
+static void flashfsIndexErased(void)
+{
+    indexState = flashfsIndexIsSupported() ? FLASHFS_INDEX_ERASED : FLASHFS_INDEX_NONE;
+    indexNextRecord = 0;
+    indexHeadAddress = 0;
+}
+
+// Find the start of free space from the last record of the journal, returns false if the index can't be trusted
+static bool flashfsIndexLoad(void)
+{
+    flashfsIndexRecord_t record;
+
+    // Records are only ever appended, so the first erased slot follows the last record
+    uint32_t left = 1;
+    uint32_t right = flashfsIndexCapacity();
+    while (left < right) {
+        const uint32_t mid = (left + right) / 2;
+        if (!flashfsIndexRead(mid, &record)) {
+            return false;
+        }
+        if (flashfsIndexRecordIsErased(&record)) {
+            right = mid;
+        } else {
+            left = mid + 1;
+        }
+    }
+
+    if (!flashfsIndexRead(left - 1, &record) || !flashfsIndexRecordIsValid(&record)) {
+        return false;
+    }
+
+    const uint32_t indexAddress = flashfsIndexRecordAddress(0);
+    indexNextRecord = left;
+
+    switch (record.type) {
+    case FLASHFS_INDEX_RECORD_LOG_END:
+    case FLASHFS_INDEX_RECORD_HEAD:
+        indexHeadAddress = record.offset;
+        break;
+    case FLASHFS_INDEX_RECORD_LOG_START:
+        // The log was never closed, so look for its end and close it now
+        if (record.offset > indexAddress) {
+            return false;
+        }
+        indexHeadAddress = flashfsScanForFreeSpace(record.offset, indexAddress);
+        flashfsIndexAppend(FLASHFS_INDEX_RECORD_LOG_END, indexHeadAddress);
+        break;
+    default:
+        return false;
+    }
+
+    if (indexHeadAddress > indexAddress) {
+        return false;
+    }
+
+    // Data past the head means something wrote to the chip without updating the index
+    if (indexHeadAddress < indexAddress) {
+        uint8_t probe[16];
+        if (flashReadBytes(indexHeadAddress, probe, sizeof(probe)) < (int)sizeof(probe)) {
+            return false;
+        }
+        for (unsigned i = 0; i < sizeof(probe); i++) {
+            if (probe[i] != 0xFF) {
+                return false;
+            }
+        }
+    }
+
+    indexState = FLASHFS_INDEX_VALID;
+
+    // Make room for the next log while we can still block
+    if (indexNextRecord + 2 > flashfsIndexCapacity()) {
+        flashfsIndexRestart(indexHeadAddress);
+    }
+
+    return true;
+}
+
+static void flashfsIndexInit(void)
+{
+    indexState = FLASHFS_INDEX_NONE;
+    indexNextRecord = 0;
+
+    if (!flashfsIndexIsSupported()) {
+        return;
+    }
+
+    flashfsIndexRecord_t header;
+    if (!flashfsIndexRead(0, &header)) {
+        return;
+    }
+
+    if (flashfsIndexRecordIsValid(&header) && header.type == FLASHFS_INDEX_RECORD_HEADER && header.offset == FLASHFS_INDEX_MAGIC
+        && flashfsIndexLoad()) {
+        return;
+    }
+
+    /* The chip was written without an index or the index is corrupt, so fall back to scanning the log data. The index
+     * can only take the last sector back if no log reaches into it.
+     */
+    indexState = FLASHFS_INDEX_NONE;
+    const uint32_t head = flashfsScanForFreeSpace(0, flashGetGeometry()->totalSize);
+    if (head <= flashfsIndexRecordAddress(0)) {
+        if (flashfsIndexRecordIsErased(&header)) {
+            indexState = FLASHFS_INDEX_ERASED;
+            flashfsIndexBegin(head);
+        } else {
+            flashfsIndexRestart(head);
+        }
+    }
+}
+
+/**
+ * Record the start of a log at the current offset. Logs start on a free block boundary so that they can still be
+ * found by scanning the data.
+ */
+void flashfsLogStart(void)
+{
+    uint32_t start = (flashfsGetOffset() + FLASHFS_FREE_BLOCK_SIZE - 1) & ~(FLASHFS_FREE_BLOCK_SIZE - 1);
+    if (start > flashfsGetSize()) {
+        start = flashfsGetSize();
+    }
+    if (start != flashfsGetOffset()) {
+        flashfsSeekAbs(start);
+    }
+
+    if (indexState == FLASHFS_INDEX_ERASED) {
+        flashfsIndexBegin(start);
+    }
+    if (indexState == FLASHFS_INDEX_VALID && flashfsIndexAppend(FLASHFS_INDEX_RECORD_LOG_START, start)) {
+        indexHeadAddress = start;
+    }
+}
+
+/**
+ * Flush the log and record its end. Call once logging has stopped, this may block to erase the index sector when the
+ * journal is full.
+ */
+void flashfsLogEnd(void)
+{
+    if (indexState != FLASHFS_INDEX_VALID) {
+        return;
+    }
+
+    flashfsFlushSync();
+
+    if (flashfsIndexAppend(FLASHFS_INDEX_RECORD_LOG_END, tailAddress)) {
+        indexHeadAddress = tailAddress;
+    }
+
+    if (indexNextRecord + 2 > flashfsIndexCapacity()) {
+        flashfsIndexRestart(tailAddress);
+    }
+}
+
+/**
+ * Fill logs with up to maxCount logs, oldest first, skipping the first `first` logs. A log that is still being
+ * written ends at the current offset. Logs from before the journal was last erased are not listed.
+ *
+ * Returns the total number of logs, or -1 if the chip has no index.
+ */
+int flashfsListLogs(int first, flashfsLog_t *logs, int maxCount)
+{
+    if (indexState == FLASHFS_INDEX_NONE) {
+        return -1;
+    }
+
+    int count = 0;
+    bool logOpen = false;
+    uint32_t logStart = 0;
+
+    for (uint32_t slot = 1; slot <= indexNextRecord; slot++) {
+        flashfsIndexRecord_t record;
+
+        if (slot == indexNextRecord) {
+            // Close the log being written
+            record.type = FLASHFS_INDEX_RECORD_LOG_END;
+            record.offset = flashfsGetOffset();
+        } else if (!flashfsIndexRead(slot, &record) || !flashfsIndexRecordIsValid(&record)) {
+            continue;
+        }
+
+        // A start with no end belongs to a log that was cut short by the next one
+        if (logOpen && record.offset > logStart
+            && (record.type == FLASHFS_INDEX_RECORD_LOG_START || record.type == FLASHFS_INDEX_RECORD_LOG_END)) {
+            if (count >= first && count - first < maxCount) {
+                logs[count - first].start = logStart;
+                logs[count - first].end = record.offset;
+            }
+            count++;
+        }
+
+        logOpen = record.type == FLASHFS_INDEX_RECORD_LOG_START;
+        logStart = record.offset;
+    }
+
+    return count;
+}
+#endif // USE_FLASHFS_INDEX
+
 /**
  * Call after initializing the flash chip in order to set up the filesystem.
  */
 void flashfsInit(void)
 {
+#ifdef USE_FLASHFS_INDEX
+    flashfsIndexInit();
+#endif
+
     // If we have a flash chip present at all
     if (flashfsGetSize() > 0) {
         // Start the file pointer off at the beginning of free space so caller can start writing immediately
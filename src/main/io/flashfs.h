@@ -26,6 +26,11 @@
 // Automatically trigger a flush when this much data is in the buffer
 #define FLASHFS_WRITE_BUFFER_AUTO_FLUSH_LEN 64
 
+typedef struct flashfsLog_s {
+    uint32_t start;
+    uint32_t end;
+} flashfsLog_t;
+
 void flashfsEraseCompletely(void);
 void flashfsEraseRange(uint32_t start, uint32_t end);
 
@@ -54,3 +59,9 @@ bool flashfsIsSupported(void);
 
 bool flashfsIsReady(void);
 bool flashfsIsEOF(void);
+
+#ifdef USE_FLASHFS_INDEX
+void flashfsLogStart(void);
+void flashfsLogEnd(void);
+int flashfsListLogs(int first, flashfsLog_t *logs, int maxCount);
+#endif
@@ -26,6 +26,7 @@
 
 #include "build/debug.h"
 
+#include "common/maths.h"
 #include "common/streambuf.h"
 #include "common/utils.h"
 #include "common/crc.h"
@@ -47,6 +48,46 @@
 
 static mspPort_t mspPorts[MAX_MSP_PORT_COUNT];
 
+// The payload is written at MSP_MAX_HEADER_SIZE, the header is then written in front of it and the checksums behind it
+typedef struct mspFrame_s {
+    uint8_t data[MSP_MAX_HEADER_SIZE + MSP_PORT_OUTBUF_SIZE + MSP_MAX_CHECKSUM_SIZE];
+    volatile bool inUse;
+} mspFrame_t;
+
+static mspFrame_t mspFramePool[MSP_FRAME_POOL_SIZE];
+
+static mspFrame_t *mspFrameAcquire(void)
+{
+    for (int i = 0; i < MSP_FRAME_POOL_SIZE; i++) {
+        if (!mspFramePool[i].inUse) {
+            mspFramePool[i].inUse = true;
+            return &mspFramePool[i];
+        }
+    }
+    return NULL;
+}
+
+static bool mspFrameAvailable(void)
+{
+    for (int i = 0; i < MSP_FRAME_POOL_SIZE; i++) {
+        if (!mspFramePool[i].inUse) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Called by the serial port once it has sent a frame, possibly from an interrupt
+static void mspFrameRelease(void *frame)
+{
+    ((mspFrame_t *)frame)->inUse = false;
+}
+
+static uint8_t *mspFramePayload(mspFrame_t *frame)
+{
+    return frame->data + MSP_MAX_HEADER_SIZE;
+}
+
 static void resetMspPort(mspPort_t *mspPortToReset, serialPort_t *serialPort, bool sharedWithTelemetry)
 {
     memset(mspPortToReset, 0, sizeof(mspPort_t));
@@ -273,6 +314,9 @@ static uint8_t mspSerialChecksumBuf(uint8_t checksum, const uint8_t *data, int l
 }
 
 #define JUMBO_FRAME_SIZE_LIMIT 255
+#define STREAM_FRAME_OVERHEAD (MSP_MAX_HEADER_SIZE + MSP_MAX_CHECKSUM_SIZE)
+// Stream frames wait for at least this much payload space in the transmit buffer
+#define STREAM_FRAME_MIN_PAYLOAD_SIZE 64
 static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, const uint8_t * data, int dataLen, const uint8_t * crc, int crcLen)
 {
     // We are allowed to send out the response if
@@ -293,7 +337,29 @@ static int mspSerialSendFrame(mspPort_t *msp, const uint8_t * hdr, int hdrLen, c
     return totalFrameLength;
 }
 
-static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e mspVersion)
+/*
+ * Complete the frame around the payload already in it and hand it to the port, which sends it without copying if
+ * it can. The frame is released once it has been sent.
+ */
+static int mspSerialSendPooledFrame(mspPort_t *msp, mspFrame_t *frame, const uint8_t * hdr, int hdrLen, int dataLen, const uint8_t * crc, int crcLen)
+{
+    uint8_t *payload = mspFramePayload(frame);
+    uint8_t *frameStart = payload - hdrLen;
+    memcpy(frameStart, hdr, hdrLen);
+    memcpy(payload + dataLen, crc, crcLen);
+
+    const int totalFrameLength = hdrLen + dataLen + crcLen;
+    if (serialWriteFrame(msp->port, frameStart, totalFrameLength, mspFrameRelease, frame)) {
+        return totalFrameLength;
+    }
+
+    const int written = mspSerialSendFrame(msp, frameStart, hdrLen, payload, dataLen, payload + dataLen, crcLen);
+    mspFrameRelease(frame);
+    return written;
+}
+
+// frame is the pool frame holding the payload, or NULL if the payload belongs to the caller
+static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e mspVersion, mspFrame_t *frame)
 {
     static const uint8_t mspMagic[MSP_VERSION_COUNT] = MSP_VERSION_MAGIC_INITIALIZER;
     const int dataLen = sbufBytesRemaining(&packet->buf);
@@ -383,15 +449,20 @@ static int mspSerialEncode(mspPort_t *msp, mspPacket_t *packet, mspVersion_e msp
     }
 
     // Send the frame
+    if (frame) {
+        return mspSerialSendPooledFrame(msp, frame, hdrBuf, hdrLen, dataLen, crcBuf, crcLen);
+    }
     return mspSerialSendFrame(msp, hdrBuf, hdrLen, sbufPtr(&packet->buf), dataLen, crcBuf, crcLen);
 }
 
+// Called with a frame available in the pool, see mspSerialProcess()
 static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspProcessCommandFnPtr mspProcessCommandFn)
 {
-    static uint8_t outBuf[MSP_PORT_OUTBUF_SIZE];
+    mspFrame_t *frame = mspFrameAcquire();
+    uint8_t *payload = mspFramePayload(frame);
 
     mspPacket_t reply = {
-        .buf = { .ptr = outBuf, .end = ARRAYEND(outBuf), },
+        .buf = { .ptr = payload, .end = payload + MSP_PORT_OUTBUF_SIZE, },
         .cmd = -1,
         .flags = 0,
         .result = 0,
@@ -412,7 +483,9 @@ static mspPostProcessFnPtr mspSerialProcessReceivedCommand(mspPort_t *msp, mspPr
 
     if (status != MSP_RESULT_NO_REPLY) {
         sbufSwitchToReader(&reply.buf, outBufHead); // change streambuf direction
-        mspSerialEncode(msp, &reply, msp->mspVersion);
+        mspSerialEncode(msp, &reply, msp->mspVersion, frame);
+    } else {
+        mspFrameRelease(frame);
     }
 
     return mspPostProcessFn;
@@ -461,6 +534,43 @@ static void mspProcessPendingRequest(mspPort_t * mspPort)
     }
 }
 
+/*
+ * Send the next frames of a stream for as long as they fit in the transmit buffer, so the transfer is paced by the
+ * port rather than by a request for each frame.
+ */
+static void mspSerialProcessStream(mspPort_t *msp)
+{
+    while (msp->streamFn) {
+        const int payloadSize = MIN((int)serialTxBytesFree(msp->port) - STREAM_FRAME_OVERHEAD, MSP_PORT_OUTBUF_SIZE);
+        if (payloadSize < STREAM_FRAME_MIN_PAYLOAD_SIZE) {
+            break;
+        }
+
+        mspFrame_t *poolFrame = mspFrameAcquire();
+        if (!poolFrame) {
+            break;
+        }
+        uint8_t *payload = mspFramePayload(poolFrame);
+
+        mspPacket_t frame = {
+            .buf = { .ptr = payload, .end = payload + payloadSize, },
+            .cmd = msp->streamCmd,
+            .flags = 0,
+            .result = MSP_RESULT_ACK,
+            .direction = MSP_DIRECTION_REPLY,
+        };
+
+        if (!msp->streamFn(&frame.buf)) {
+            msp->streamFn = NULL;
+            mspFrameRelease(poolFrame);
+            break;
+        }
+
+        sbufSwitchToReader(&frame.buf, payload);
+        mspSerialEncode(msp, &frame, msp->mspVersion, poolFrame);
+    }
+}
+
 static void mspSerialProcessReceivedReply(mspPort_t *msp, mspProcessReplyFnPtr mspProcessReplyFn)
 {
     mspPacket_t reply = {
@@ -493,9 +603,15 @@ void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessComm
         mspPostProcessFnPtr mspPostProcessFn = NULL;
 
         if (!mspPort->pendingRequest && serialRxBytesWaiting(mspPort->port)) {
-            // There are bytes incoming - abort pending request
+            if (!mspFrameAvailable()) {
+                // Every frame is still being sent, leave the request in the receive buffer until one is released
+                continue;
+            }
+
+            // There are bytes incoming - abort pending request and any stream
             mspPort->lastActivityMs = millis();
             mspPort->pendingRequest = MSP_PENDING_NONE;
+            mspPort->streamFn = NULL;
 
             while (serialRxBytesWaiting(mspPort->port)) {
                 const uint8_t c = serialRead(mspPort->port);
@@ -522,6 +638,9 @@ void mspSerialProcess(mspEvaluateNonMspData_e evaluateNonMspData, mspProcessComm
                 mspPostProcessFn(mspPort->port);
             }
         }
+        else if (mspPort->streamFn) {
+            mspSerialProcessStream(mspPort);
+        }
         else {
             mspProcessPendingRequest(mspPort);
         }
@@ -571,7 +690,7 @@ int mspSerialPush(uint8_t cmd, uint8_t *data, int datalen, mspDirection_e direct
             .direction = direction,
         };
 
-        ret = mspSerialEncode(mspPort, &push, MSP_V1);
+        ret = mspSerialEncode(mspPort, &push, MSP_V1, NULL);
     }
     return ret; // return the number of bytes written
 }
@@ -600,3 +719,21 @@ uint32_t mspSerialTxBytesFree(void)
 
     return ret;
 }
+
+/*
+ * Start sending frames from streamFn on the MSP port using serialPort, replacing any stream already running. The
+ * stream stops when streamFn returns false or when anything is received on the port.
+ */
+void mspSerialStreamStart(serialPort_t *serialPort, uint16_t cmd, mspStreamFnPtr streamFn)
+{
+    for (int portIndex = 0; portIndex < MAX_MSP_PORT_COUNT; portIndex++) {
+        mspPort_t * const mspPort = &mspPorts[portIndex];
+
+        if (mspPort->port && mspPort->port == serialPort) {
+            mspPort->streamCmd = cmd;
+            mspPort->streamFn = streamFn;
+        } else {
+            mspPort->streamFn = NULL;
+        }
+    }
+}
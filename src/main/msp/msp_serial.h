@@ -91,7 +91,18 @@ typedef struct __attribute__((packed)) {
     uint16_t size;
 } mspHeaderV2_t;
 
-#define MSP_MAX_HEADER_SIZE     9
+// MSPv2 over a MSPv1 jumbo frame has the largest header, and two checksums
+#define MSP_MAX_HEADER_SIZE     12
+#define MSP_MAX_CHECKSUM_SIZE   2
+
+// Replies are built in place in frames from a pool shared by all ports, a frame is in use until its port has sent it
+#ifndef MSP_FRAME_POOL_SIZE
+#if defined(STM32F1) || defined(STM32F3)
+#define MSP_FRAME_POOL_SIZE     1
+#else
+#define MSP_FRAME_POOL_SIZE     2
+#endif
+#endif
 
 struct serialPort_s;
 typedef struct mspPort_s {
@@ -109,6 +120,8 @@ typedef struct mspPort_s {
     uint8_t checksum1;
     uint8_t checksum2;
     bool sharedWithTelemetry;
+    mspStreamFnPtr streamFn;    // null when no stream is being sent
+    uint16_t streamCmd;
 } mspPort_t;
 
 void mspSerialInit(void);
@@ -119,3 +132,4 @@ void mspSerialReleasePortIfAllocated(struct serialPort_s *serialPort);
 void mspSerialReleaseSharedTelemetryPorts(void);
 int mspSerialPush(uint8_t cmd, uint8_t *data, int datalen, mspDirection_e direction);
 uint32_t mspSerialTxBytesFree(void);
+void mspSerialStreamStart(struct serialPort_s *serialPort, uint16_t cmd, mspStreamFnPtr streamFn);
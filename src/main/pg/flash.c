@@ -33,7 +33,7 @@
 
 #include "flash.h"
 
-PG_REGISTER_WITH_RESET_FN(flashConfig_t, flashConfig, PG_FLASH_CONFIG, 0);
+PG_REGISTER_WITH_RESET_FN(flashConfig_t, flashConfig, PG_FLASH_CONFIG, 1);
 
 void pgResetFn_flashConfig(flashConfig_t *flashConfig)
 {
@@ -43,5 +43,6 @@ void pgResetFn_flashConfig(flashConfig_t *flashConfig)
     flashConfig->csTag = IO_TAG_NONE;
 #endif
     flashConfig->spiDevice = SPI_DEV_TO_CFG(spiDeviceByInstance(FLASH_SPI_INSTANCE));
+    flashConfig->spiDma = false;
 }
 #endif
@@ -29,6 +29,7 @@
 typedef struct flashConfig_s {
     ioTag_t csTag;
     uint8_t spiDevice;
+    uint8_t spiDma;
 } flashConfig_t;
 
 PG_DECLARE(flashConfig_t, flashConfig);
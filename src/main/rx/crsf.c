@@ -57,6 +57,7 @@
 #define CRSF_PAYLOAD_OFFSET offsetof(crsfFrameDef_t, type)
 
 STATIC_UNIT_TESTED bool crsfFrameDone = false;
+static timeUs_t crsfFrameDoneAtUs = 0;
 STATIC_UNIT_TESTED crsfFrame_t crsfFrame;
 STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
@@ -124,13 +125,9 @@ STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
     return crc;
 }
 
-// Receive ISR callback, called back from serial port
-STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
+static void crsfProcessByte(uint8_t c, timeUs_t currentTimeUs)
 {
-    UNUSED(data);
-
     static uint8_t crsfFramePosition = 0;
-    const uint32_t currentTimeUs = micros();
 
 #ifdef DEBUG_CRSF_PACKETS
     debug[2] = currentTimeUs - crsfFrameStartAtUs;
@@ -154,8 +151,14 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
         crsfFrameDone = crsfFramePosition < fullFrameLength ? false : true;
         if (crsfFrameDone) {
             crsfFramePosition = 0;
-            if (crsfFrame.frame.type != CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
-                const uint8_t crc = crsfFrameCRC();
+            const uint8_t crc = crsfFrameCRC();
+            if (crsfFrame.frame.type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
+                // only a valid RC frame moves the frame time used to align the RC data
+                if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
+                    crsfFrameDoneAtUs = currentTimeUs;
+                    rxSignalFrameComplete();
+                }
+            } else {
                 if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
                     switch (crsfFrame.frame.type)
                     {
@@ -188,6 +191,31 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
     }
 }
 
+// Receive ISR callback, called back from serial port
+STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *data)
+{
+    UNUSED(data);
+
+    crsfProcessByte(c, micros());
+}
+
+// Idle line ISR callback, called back from serial port with the bytes received by DMA
+STATIC_UNIT_TESTED void crsfFrameReceive(const uint8_t *data, int length, timeUs_t frameTimeUs, void *callbackData)
+{
+    UNUSED(callbackData);
+
+    for (int i = 0; i < length; i++) {
+        crsfProcessByte(data[i], frameTimeUs);
+    }
+}
+
+STATIC_UNIT_TESTED timeUs_t crsfFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    UNUSED(rxRuntimeConfig);
+
+    return crsfFrameDoneAtUs;
+}
+
 STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
@@ -265,6 +293,7 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = crsfReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = crsfFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = crsfFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -280,6 +309,10 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
         CRSF_PORT_OPTIONS | (rxConfig->serialrx_inverted ? SERIAL_INVERTED : 0)
         );
 
+    if (serialPort) {
+        serialSetRxFrameCallback(serialPort, crsfFrameReceive);
+    }
+
     return serialPort != NULL;
 }
 
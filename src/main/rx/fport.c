@@ -130,6 +130,7 @@ static const smartPortPayload_t emptySmartPortFrame = { .frameId = 0, .valueId =
 typedef struct fportBuffer_s {
     uint8_t data[BUFFER_SIZE];
     uint8_t length;
+    timeUs_t receivedAtUs;
 } fportBuffer_t;
 
 static fportBuffer_t rxBuffer[NUM_RX_BUFFERS];
@@ -144,6 +145,7 @@ static volatile uint8_t framePosition = 0;
 
 static smartPortPayload_t *mspPayload = NULL;
 static timeUs_t lastRcFrameReceivedMs = 0;
+static timeUs_t lastRcFrameReceivedUs = 0;
 
 static serialPort_t *fportPort;
 #ifdef USE_TELEMETRY_SMARTPORT
@@ -159,18 +161,13 @@ static void reportFrameError(uint8_t errorReason) {
     DEBUG_SET(DEBUG_FPORT, DEBUG_FPORT_FRAME_LAST_ERROR, errorReason);
 }
 
-// Receive ISR callback
-static void fportDataReceive(uint16_t c, void *data)
+static void fportProcessByte(uint8_t c, timeUs_t currentTimeUs)
 {
-    UNUSED(data);
-
     static timeUs_t frameStartAt = 0;
     static bool escapedCharacter = false;
     static timeUs_t lastFrameReceivedUs = 0;
     static bool telemetryFrame = false;
 
-    const timeUs_t currentTimeUs = micros();
-
     clearToSend = false;
 
     if (framePosition > 1 && cmpTimeUs(currentTimeUs, frameStartAt) > FPORT_TIME_NEEDED_PER_FRAME_US + 500) {
@@ -186,6 +183,7 @@ static void fportDataReceive(uint16_t c, void *data)
             const uint8_t nextWriteIndex = (rxBufferWriteIndex + 1) % NUM_RX_BUFFERS;
             if (nextWriteIndex != rxBufferReadIndex) {
                 rxBuffer[rxBufferWriteIndex].length = framePosition - 1;
+                rxBuffer[rxBufferWriteIndex].receivedAtUs = currentTimeUs;
                 rxBufferWriteIndex = nextWriteIndex;
             }
 
@@ -228,6 +226,24 @@ static void fportDataReceive(uint16_t c, void *data)
     }
 }
 
+// Receive ISR callback
+static void fportDataReceive(uint16_t c, void *data)
+{
+    UNUSED(data);
+
+    fportProcessByte(c, micros());
+}
+
+// Idle line ISR callback, called with the bytes received by DMA
+static void fportFrameReceive(const uint8_t *data, int length, timeUs_t frameTimeUs, void *callbackData)
+{
+    UNUSED(callbackData);
+
+    for (int i = 0; i < length; i++) {
+        fportProcessByte(data[i], frameTimeUs);
+    }
+}
+
 #if defined(USE_TELEMETRY_SMARTPORT)
 static void smartPortWriteFrameFport(const smartPortPayload_t *payload)
 {
@@ -285,6 +301,7 @@ static uint8_t fportFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
                         setRssi(scaleRange(frame->data.controlData.rssi, 0, 100, 0, RSSI_MAX_VALUE), RSSI_SOURCE_RX_PROTOCOL);
 
                         lastRcFrameReceivedMs = millis();
+                        lastRcFrameReceivedUs = rxBuffer[rxBufferReadIndex].receivedAtUs;
                     }
 
                     break;
@@ -389,6 +406,13 @@ static bool fportProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
     return true;
 }
 
+static timeUs_t fportFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    UNUSED(rxRuntimeConfig);
+
+    return lastRcFrameReceivedUs;
+}
+
 bool fportRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 {
     static uint16_t sbusChannelData[SBUS_MAX_CHANNEL];
@@ -400,6 +424,7 @@ bool fportRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcFrameStatusFn = fportFrameStatus;
     rxRuntimeConfig->rcProcessFrameFn = fportProcessFrame;
+    rxRuntimeConfig->rcFrameTimeUsFn = fportFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -416,6 +441,8 @@ bool fportRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     );
 
     if (fportPort) {
+        serialSetRxFrameCallback(fportPort, fportFrameReceive);
+
 #if defined(USE_TELEMETRY_SMARTPORT)
         telemetryEnabled = initSmartPortTelemetryExternal(smartPortWriteFrameFport);
 #endif
@@ -42,6 +42,7 @@
 
 #include "fc/config.h"
 #include "fc/rc_controls.h"
+#include "fc/rc_latency.h"
 #include "fc/rc_modes.h"
 
 #include "flight/failsafe.h"
@@ -67,6 +68,8 @@
 #include "rx/rx_spi.h"
 #include "rx/targetcustomserial.h"
 
+#include "scheduler/scheduler.h"
+
 
 const char rcChannelLetters[] = "AERT12345678abcdefgh";
 
@@ -379,6 +382,9 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
             if (signalReceived) {
                 needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
             }
+#ifdef USE_RC_LATENCY
+            rcLatencyFrameReceived(rxRuntimeConfig.rcFrameTimeUsFn ? rxRuntimeConfig.rcFrameTimeUsFn(&rxRuntimeConfig) : currentTimeUs);
+#endif
 
             if (frameStatus & (RX_FRAME_FAILSAFE | RX_FRAME_DROPPED)) {
             	// No (0%) signal
@@ -545,6 +551,15 @@ static void detectAndApplySignalLossBehaviour(void)
     DEBUG_SET(DEBUG_RX_SIGNAL_LOSS, 3, rcData[THROTTLE]);
 }
 
+/*
+ * Called from interrupt context by receivers that detect the end of a frame. The RX task then runs once the frame
+ * is complete rather than polling the receiver on every scheduler pass.
+ */
+void rxSignalFrameComplete(void)
+{
+    schedulerSignalTask(TASK_RX);
+}
+
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
 {
     if (auxiliaryProcessingRequired) {
@@ -568,6 +583,9 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
     }
 
     readRxChannelsApplyRanges();
+#ifdef USE_RC_LATENCY
+    rcLatencyMark(RC_LATENCY_STAGE_RX_CHANNELS);
+#endif
     detectAndApplySignalLossBehaviour();
 
     rcSampleIndex++;
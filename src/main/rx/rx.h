@@ -124,6 +124,7 @@ struct rxRuntimeConfig_s;
 typedef uint16_t (*rcReadRawDataFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig, uint8_t chan); // used by receiver driver to return channel data
 typedef uint8_t (*rcFrameStatusFnPtr)(struct rxRuntimeConfig_s *rxRuntimeConfig);
 typedef bool (*rcProcessFrameFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig);
+typedef timeUs_t (*rcFrameTimeUsFnPtr)(const struct rxRuntimeConfig_s *rxRuntimeConfig); // time the last complete frame finished arriving
 
 typedef struct rxRuntimeConfig_s {
     uint8_t             channelCount; // number of RC channels as reported by current input driver
@@ -131,6 +132,7 @@ typedef struct rxRuntimeConfig_s {
     rcReadRawDataFnPtr  rcReadRawFn;
     rcFrameStatusFnPtr  rcFrameStatusFn;
     rcProcessFrameFnPtr rcProcessFrameFn;
+    rcFrameTimeUsFnPtr  rcFrameTimeUsFn; // optional
     uint16_t            *channelData;
     void                *frameData;
 } rxRuntimeConfig_t;
@@ -153,6 +155,7 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs);
 bool rxIsReceivingSignal(void);
 bool rxAreFlightChannelsValid(void);
 bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs);
+void rxSignalFrameComplete(void);
 
 struct rxConfig_s;
 
@@ -102,19 +102,15 @@ typedef union sbusFrame_u {
 typedef struct sbusFrameData_s {
     sbusFrame_t frame;
     uint32_t startAtUs;
+    timeUs_t doneAtUs;
     uint16_t stateFlags;
     uint8_t position;
     bool done;
 } sbusFrameData_t;
 
 
-// Receive ISR callback
-static void sbusDataReceive(uint16_t c, void *data)
+static void sbusProcessByte(uint8_t c, timeUs_t nowUs, sbusFrameData_t *sbusFrameData)
 {
-    sbusFrameData_t *sbusFrameData = data;
-
-    const uint32_t nowUs = micros();
-
     const int32_t sbusFrameTime = nowUs - sbusFrameData->startAtUs;
 
     if (sbusFrameTime > (long)(SBUS_TIME_NEEDED_PER_FRAME + 500)) {
@@ -134,11 +130,27 @@ static void sbusDataReceive(uint16_t c, void *data)
             sbusFrameData->done = false;
         } else {
             sbusFrameData->done = true;
+            sbusFrameData->doneAtUs = nowUs;
+            rxSignalFrameComplete();
             DEBUG_SET(DEBUG_SBUS, DEBUG_SBUS_FRAME_TIME, sbusFrameTime);
         }
     }
 }
 
+// Receive ISR callback
+static void sbusDataReceive(uint16_t c, void *data)
+{
+    sbusProcessByte(c, micros(), data);
+}
+
+// Idle line ISR callback, called with the bytes received by DMA
+static void sbusFrameReceive(const uint8_t *data, int length, timeUs_t frameTimeUs, void *callbackData)
+{
+    for (int i = 0; i < length; i++) {
+        sbusProcessByte(data[i], frameTimeUs, callbackData);
+    }
+}
+
 static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
@@ -163,6 +175,12 @@ static uint8_t sbusFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
     return sbusChannelsDecode(rxRuntimeConfig, &sbusFrameData->frame.frame.channels);
 }
 
+static timeUs_t sbusFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    const sbusFrameData_t *sbusFrameData = rxRuntimeConfig->frameData;
+    return sbusFrameData->doneAtUs;
+}
+
 bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 {
     static uint16_t sbusChannelData[SBUS_MAX_CHANNEL];
@@ -176,6 +194,7 @@ bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     rxRuntimeConfig->rxRefreshRate = 11000;
 
     rxRuntimeConfig->rcFrameStatusFn = sbusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = sbusFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -197,6 +216,10 @@ bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
         SBUS_PORT_OPTIONS | (rxConfig->serialrx_inverted ? 0 : SERIAL_INVERTED) | (rxConfig->halfDuplex ? SERIAL_BIDIR : 0)
         );
 
+    if (sBusPort) {
+        serialSetRxFrameCallback(sBusPort, sbusFrameReceive);
+    }
+
     if (rxConfig->rssi_src_frame_errors) {
         rssiSource = RSSI_SOURCE_FRAME_ERRORS;
     }
@@ -62,6 +62,7 @@ uint8_t rssi_channel;
 static uint8_t spek_chan_shift;
 static uint8_t spek_chan_mask;
 static bool rcFrameComplete = false;
+static timeUs_t rcFrameCompleteAtUs = 0;
 static bool spekHiRes = false;
 
 static volatile uint8_t spekFrame[SPEK_FRAME_SIZE];
@@ -74,16 +75,12 @@ static uint8_t telemetryBuf[SRXL_FRAME_SIZE_MAX];
 static uint8_t telemetryBufLen = 0;
 #endif
 
-// Receive ISR callback
-static void spektrumDataReceive(uint16_t c, void *data)
+static void spektrumProcessByte(uint8_t c, timeUs_t spekTime)
 {
-    UNUSED(data);
-
-    uint32_t spekTime, spekTimeInterval;
+    uint32_t spekTimeInterval;
     static uint32_t spekTimeLast = 0;
     static uint8_t spekFramePosition = 0;
 
-    spekTime = micros();
     spekTimeInterval = spekTime - spekTimeLast;
     spekTimeLast = spekTime;
 
@@ -97,13 +94,42 @@ static void spektrumDataReceive(uint16_t c, void *data)
             rcFrameComplete = false;
         } else {
             rcFrameComplete = true;
+            rcFrameCompleteAtUs = spekTime;
+            // SRXL telemetry is sent a fixed delay after the frame, which needs the RX task to keep polling
+            if (!srxlEnabled) {
+                rxSignalFrameComplete();
+            }
         }
     }
 }
 
+// Receive ISR callback
+static void spektrumDataReceive(uint16_t c, void *data)
+{
+    UNUSED(data);
+
+    spektrumProcessByte(c, micros());
+}
+
+// Idle line ISR callback, called with the bytes received by DMA
+static void spektrumFrameReceive(const uint8_t *data, int length, timeUs_t frameTimeUs, void *callbackData)
+{
+    UNUSED(callbackData);
+
+    for (int i = 0; i < length; i++) {
+        spektrumProcessByte(data[i], frameTimeUs);
+    }
+}
 
 uint32_t spekChannelData[SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT];
 
+static timeUs_t spektrumFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig)
+{
+    UNUSED(rxRuntimeConfig);
+
+    return rcFrameCompleteAtUs;
+}
+
 static uint8_t spektrumFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
@@ -383,6 +409,7 @@ bool spektrumInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig
 
     rxRuntimeConfig->rcReadRawFn = spektrumReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = spektrumFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = spektrumFrameTimeUs;
 #if defined(USE_TELEMETRY_SRXL)
     rxRuntimeConfig->rcProcessFrameFn = spektrumProcessFrame;
 #endif
@@ -395,6 +422,11 @@ bool spektrumInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig
         portShared || srxlEnabled ? MODE_RXTX : MODE_RX,
         (rxConfig->serialrx_inverted ? SERIAL_INVERTED : 0) | ((srxlEnabled || rxConfig->halfDuplex) ? SERIAL_BIDIR : 0)
         );
+
+    if (serialPort) {
+        serialSetRxFrameCallback(serialPort, spektrumFrameReceive);
+    }
+
 #if defined(USE_TELEMETRY_SRXL)
     if (portShared) {
         telemetrySharedPort = serialPort;
@@ -51,6 +51,7 @@ static FAST_RAM_ZERO_INIT uint32_t totalWaitingTasks;
 static FAST_RAM_ZERO_INIT uint32_t totalWaitingTasksSamples;
 
 static FAST_RAM_ZERO_INIT bool calculateTaskStatistics;
+static FAST_RAM_ZERO_INIT bool deadlineScheduling;
 FAST_RAM_ZERO_INIT uint16_t averageSystemLoadPercent = 0;
 
 
@@ -163,6 +164,47 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->averageExecutionTime = cfTasks[taskId].movingSumExecutionTime / MOVING_SUM_COUNT;
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
 }
+
+void getTaskHistogram(cfTaskId_e taskId, cfTaskHistogram_t *taskHistogram)
+{
+    taskHistogram->maxExecutionCycles = cfTasks[taskId].maxExecutionCycles;
+#ifdef USE_TASK_HISTOGRAM
+    memcpy(taskHistogram->executionHistogram, cfTasks[taskId].executionHistogram, sizeof(taskHistogram->executionHistogram));
+    memcpy(taskHistogram->jitterHistogram, cfTasks[taskId].jitterHistogram, sizeof(taskHistogram->jitterHistogram));
+#else
+    memset(taskHistogram->executionHistogram, 0, sizeof(taskHistogram->executionHistogram));
+    memset(taskHistogram->jitterHistogram, 0, sizeof(taskHistogram->jitterHistogram));
+#endif
+}
+
+#define WCET_DECAY_SHIFT 10 // the worst case execution time loses 1/1024 of its value on every invocation
+
+#ifdef USE_TASK_HISTOGRAM
+static void taskHistogramAdd(uint16_t *histogram, uint32_t cycles)
+{
+    const uint32_t scaledCycles = cycles >> TASK_HISTOGRAM_SHIFT;
+    const int bucket = scaledCycles ? MIN(32 - __builtin_clz(scaledCycles), TASK_HISTOGRAM_BUCKET_COUNT - 1) : 0;
+    if (histogram[bucket] < UINT16_MAX) {
+        histogram[bucket]++;
+    }
+}
+#endif
+
+static void taskUpdateExecutionCycles(cfTask_t *task, uint32_t startedAtCycles, uint32_t executionCycles)
+{
+    const uint32_t decayedMaxExecutionCycles = task->maxExecutionCycles - (task->maxExecutionCycles >> WCET_DECAY_SHIFT);
+    task->maxExecutionCycles = MAX(decayedMaxExecutionCycles, executionCycles);
+    task->worstExecutionTime = clockCyclesToMicros(task->maxExecutionCycles) + 1;
+#ifdef USE_TASK_HISTOGRAM
+    taskHistogramAdd(task->executionHistogram, executionCycles);
+    // event driven tasks have no fixed period to measure jitter against
+    if (!task->checkFunc && task->lastStartedAtCycles) {
+        const int32_t jitterCycles = (int32_t)(startedAtCycles - task->lastStartedAtCycles - clockMicrosToCycles(task->desiredPeriod));
+        taskHistogramAdd(task->jitterHistogram, ABS(jitterCycles));
+    }
+#endif
+    task->lastStartedAtCycles = startedAtCycles;
+}
 #endif
 
 void rescheduleTask(cfTaskId_e taskId, uint32_t newPeriodMicros)
@@ -204,6 +246,11 @@ void schedulerSetCalulateTaskStatistics(bool calculateTaskStatisticsToUse)
     calculateTaskStatistics = calculateTaskStatisticsToUse;
 }
 
+void schedulerSetDeadlineScheduling(bool deadlineSchedulingToUse)
+{
+    deadlineScheduling = deadlineSchedulingToUse;
+}
+
 void schedulerResetTaskStatistics(cfTaskId_e taskId)
 {
 #ifdef SKIP_TASK_STATISTICS
@@ -234,6 +281,32 @@ void schedulerResetTaskMaxExecutionTime(cfTaskId_e taskId)
 #endif
 }
 
+void schedulerResetTaskHistogram(cfTaskId_e taskId)
+{
+#ifdef USE_TASK_HISTOGRAM
+    if (taskId == TASK_SELF || taskId < TASK_COUNT) {
+        cfTask_t *task = taskId == TASK_SELF ? currentTask : &cfTasks[taskId];
+        memset(task->executionHistogram, 0, sizeof(task->executionHistogram));
+        memset(task->jitterHistogram, 0, sizeof(task->jitterHistogram));
+    }
+#else
+    UNUSED(taskId);
+#endif
+}
+
+/*
+ * Tell an event driven task that its event has happened, so its checkFunc is run on the next scheduler pass
+ * rather than polled on every pass. Safe to call from interrupt context.
+ */
+void schedulerSignalTask(cfTaskId_e taskId)
+{
+    if (taskId < TASK_COUNT) {
+        cfTask_t *task = &cfTasks[taskId];
+        task->signalDriven = true;
+        task->executeNow = true;
+    }
+}
+
 void schedulerInit(void)
 {
     calculateTaskStatistics = true;
@@ -246,9 +319,9 @@ FAST_CODE void scheduler(void)
     // Cache currentTime
     const timeUs_t currentTimeUs = micros();
 
-    // Check for realtime tasks
+    // Check for realtime tasks, a trigger task such as a data ready driven gyro/PID loop counts as realtime
     bool outsideRealtimeGuardInterval = true;
-    for (const cfTask_t *task = queueFirst(); task != NULL && task->staticPriority == TASK_PRIORITY_REALTIME; task = queueNext()) {
+    for (const cfTask_t *task = queueFirst(); task != NULL && task->staticPriority >= TASK_PRIORITY_REALTIME; task = queueNext()) {
         const timeUs_t nextExecuteAt = task->lastExecutedAt + task->desiredPeriod;
         if ((timeDelta_t)(currentTimeUs - nextExecuteAt) >= 0) {
             outsideRealtimeGuardInterval = false;
@@ -260,6 +333,14 @@ FAST_CODE void scheduler(void)
     cfTask_t *selectedTask = NULL;
     uint16_t selectedTaskDynamicPriority = 0;
 
+#ifndef SKIP_TASK_STATISTICS
+    // Earliest deadline first candidate, only used if no realtime task is selected
+    cfTask_t *deadlineTask = NULL;
+    timeUs_t deadlineTaskDeadline = 0;
+    // Time until the next realtime task is due, realtime tasks are first in the queue so this is known before any other task is considered
+    timeDelta_t realtimeSlack = INT32_MAX;
+#endif
+
     // Update task dynamic priorities
     uint16_t waitingTasks = 0;
     for (cfTask_t *task = queueFirst(); task != NULL; task = queueNext()) {
@@ -288,26 +369,37 @@ FAST_CODE void scheduler(void)
             else if (task->dynamicPriority > 0) 
             {
                 task->taskAgeCycles = 1 + ((currentTimeUs - task->lastSignaledAt) / task->desiredPeriod);
-                task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
+                if (!task->signalDriven) {
+                    task->dynamicPriority = 1 + task->staticPriority * task->taskAgeCycles;
+                }
                 waitingTasks++;
-            } else if (task->checkFunc(currentTimeBeforeCheckFuncCall, currentTimeBeforeCheckFuncCall - task->lastExecutedAt)) {
+            } else if (task->signalDriven && !task->executeNow && cmpTimeUs(currentTimeUs, task->lastCheckedAt) < task->desiredPeriod) {
+                // nothing signalled, the periodic poll is only needed to catch timeouts
+                task->taskAgeCycles = 0;
+            } else {
+                // clear the signal before the check, an event arriving during the check is then seen on the next pass
+                task->executeNow = false;
+                task->lastCheckedAt = currentTimeUs;
+                if (task->checkFunc(currentTimeBeforeCheckFuncCall, currentTimeBeforeCheckFuncCall - task->lastExecutedAt)) {
 #if defined(SCHEDULER_DEBUG)
-                DEBUG_SET(DEBUG_SCHEDULER, 3, micros() - currentTimeBeforeCheckFuncCall);
+                    DEBUG_SET(DEBUG_SCHEDULER, 3, micros() - currentTimeBeforeCheckFuncCall);
 #endif
 #ifndef SKIP_TASK_STATISTICS
-                if (calculateTaskStatistics) {
-                    const uint32_t checkFuncExecutionTime = micros() - currentTimeBeforeCheckFuncCall;
-                    checkFuncMovingSumExecutionTime += checkFuncExecutionTime - checkFuncMovingSumExecutionTime / MOVING_SUM_COUNT;
-                    checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
-                    checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
-                }
+                    if (calculateTaskStatistics) {
+                        const uint32_t checkFuncExecutionTime = micros() - currentTimeBeforeCheckFuncCall;
+                        checkFuncMovingSumExecutionTime += checkFuncExecutionTime - checkFuncMovingSumExecutionTime / MOVING_SUM_COUNT;
+                        checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
+                        checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
+                    }
 #endif
-                task->lastSignaledAt = currentTimeBeforeCheckFuncCall;
-                task->taskAgeCycles = 1;
-                task->dynamicPriority = 1 + task->staticPriority;
-                waitingTasks++;
-            } else {
-                task->taskAgeCycles = 0;
+                    task->lastSignaledAt = currentTimeBeforeCheckFuncCall;
+                    task->taskAgeCycles = 1;
+                    // a signalled task starts at the top priority, the realtime guard interval still keeps it behind a due realtime or trigger task
+                    task->dynamicPriority = task->signalDriven ? TASK_PRIORITY_MAX : 1 + task->staticPriority;
+                    waitingTasks++;
+                } else {
+                    task->taskAgeCycles = 0;
+                }
             }
         } else {
             // Task is time-driven, dynamicPriority is last execution age (measured in desiredPeriods)
@@ -319,11 +411,33 @@ FAST_CODE void scheduler(void)
             }
         }
 
+#ifndef SKIP_TASK_STATISTICS
+        if (deadlineScheduling) {
+            if (task->staticPriority >= TASK_PRIORITY_REALTIME) {
+                realtimeSlack = MIN(realtimeSlack, cmpTimeUs(task->lastExecutedAt + task->desiredPeriod, currentTimeUs));
+            } else {
+                if (task->dynamicPriority > 0 && !(task->staticPriority == TASK_PRIORITY_IDLE && deadlineTask)) {
+                    // a signalled task is due as soon as it is ready
+                    const timeUs_t deadline = task->signalDriven ? task->lastSignaledAt
+                        : (task->checkFunc ? task->lastSignaledAt : task->lastExecutedAt) + task->desiredPeriod;
+                    // only start a task if its worst case execution time ends before the next realtime slot,
+                    // a task that is a whole period late is started anyway so a worst case longer than the slot can't starve it
+                    const bool finishesBeforeRealtimeTask = (timeDelta_t)task->worstExecutionTime < realtimeSlack || task->taskAgeCycles > 1;
+                    if (finishesBeforeRealtimeTask && (!deadlineTask || cmpTimeUs(deadline, deadlineTaskDeadline) < 0)) {
+                        deadlineTask = task;
+                        deadlineTaskDeadline = deadline;
+                    }
+                }
+                continue;
+            }
+        }
+#endif
+
         if (task->dynamicPriority > selectedTaskDynamicPriority) {
             const bool taskCanBeChosenForScheduling =
                 (outsideRealtimeGuardInterval) ||
                 (task->taskAgeCycles > 1) ||
-                (task->staticPriority == TASK_PRIORITY_REALTIME);
+                (task->staticPriority >= TASK_PRIORITY_REALTIME);
             if (taskCanBeChosenForScheduling) {
                 selectedTaskDynamicPriority = task->dynamicPriority;
                 selectedTask = task;
@@ -331,6 +445,13 @@ FAST_CODE void scheduler(void)
         }
     }
 
+#ifndef SKIP_TASK_STATISTICS
+    if (!selectedTask && deadlineTask) {
+        selectedTask = deadlineTask;
+        selectedTaskDynamicPriority = deadlineTask->dynamicPriority;
+    }
+#endif
+
     totalWaitingTasksSamples++;
     totalWaitingTasks += waitingTasks;
 
@@ -346,10 +467,12 @@ FAST_CODE void scheduler(void)
 #ifdef SKIP_TASK_STATISTICS
         selectedTask->taskFunc(currentTimeUs);
 #else
-        if (calculateTaskStatistics) {
+        if (calculateTaskStatistics || deadlineScheduling) {
+            const uint32_t cyclesBeforeTaskCall = ticks();
             const timeUs_t currentTimeBeforeTaskCall = micros();
             selectedTask->taskFunc(currentTimeBeforeTaskCall);
             const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
+            taskUpdateExecutionCycles(selectedTask, cyclesBeforeTaskCall, ticks() - cyclesBeforeTaskCall);
             selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / MOVING_SUM_COUNT;
             selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
             selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
@@ -26,6 +26,9 @@
 #define TASK_PERIOD_MS(ms) ((ms) * 1000)
 #define TASK_PERIOD_US(us) (us)
 
+// task histogram bucket n counts samples below 2^(n + TASK_HISTOGRAM_SHIFT) cpu cycles, the last bucket counts everything above
+#define TASK_HISTOGRAM_BUCKET_COUNT 16
+#define TASK_HISTOGRAM_SHIFT 7
 
 typedef enum {
     TASK_PRIORITY_IDLE = 0,     // Disables dynamic scheduling, task is executed only if no other task is active this cycle
@@ -56,6 +59,12 @@ typedef struct {
     timeUs_t     averageExecutionTime;
 } cfTaskInfo_t;
 
+typedef struct {
+    uint32_t     maxExecutionCycles;                                // decaying worst case execution time, as used by deadline scheduling
+    uint16_t     executionHistogram[TASK_HISTOGRAM_BUCKET_COUNT];   // execution time in cpu cycles
+    uint16_t     jitterHistogram[TASK_HISTOGRAM_BUCKET_COUNT];      // deviation of the start-to-start interval from desiredPeriod in cpu cycles
+} cfTaskHistogram_t;
+
 typedef enum {
     /* Actual tasks */
     TASK_SYSTEM = 0,
@@ -152,19 +161,28 @@ typedef struct {
     void (*taskFunc)(timeUs_t currentTimeUs);
     timeDelta_t desiredPeriod;      // target period of execution
     const uint8_t staticPriority;   // dynamicPriority grows in steps of this size, shouldn't be zero
-    bool executeNow;
+    volatile bool executeNow;       // set by schedulerSignalTask(), possibly from interrupt context
     // Scheduling
     uint16_t dynamicPriority;       // measurement of how old task was last executed, used to avoid task starvation
     uint16_t taskAgeCycles;
     timeDelta_t taskLatestDeltaTime;
     timeUs_t lastExecutedAt;        // last time of invocation
     timeUs_t lastSignaledAt;        // time of invocation event for event-driven tasks
+    timeUs_t lastCheckedAt;         // last time checkFunc was called
+    bool signalDriven;              // once signalled, checkFunc is only polled every desiredPeriod
 
 #ifndef SKIP_TASK_STATISTICS
     // Statistics
     timeUs_t movingSumExecutionTime;  // moving sum over 32 samples
     timeUs_t maxExecutionTime;
     timeUs_t totalExecutionTime;    // total time consumed by task since boot
+    uint32_t maxExecutionCycles;    // worst case execution time in cpu cycles, decays slowly so one-off stalls are forgotten
+    timeUs_t worstExecutionTime;    // maxExecutionCycles rounded up to microseconds
+    uint32_t lastStartedAtCycles;   // cycle counter at the last invocation
+#ifdef USE_TASK_HISTOGRAM
+    uint16_t executionHistogram[TASK_HISTOGRAM_BUCKET_COUNT];
+    uint16_t jitterHistogram[TASK_HISTOGRAM_BUCKET_COUNT];
+#endif
 #endif
 } cfTask_t;
 
@@ -173,12 +191,16 @@ extern uint16_t averageSystemLoadPercent;
 
 void getCheckFuncInfo(cfCheckFuncInfo_t *checkFuncInfo);
 void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t *taskInfo);
+void getTaskHistogram(cfTaskId_e taskId, cfTaskHistogram_t *taskHistogram);
 void rescheduleTask(cfTaskId_e taskId, uint32_t newPeriodMicros);
 void setTaskEnabled(cfTaskId_e taskId, bool newEnabledState);
 timeDelta_t getTaskDeltaTime(cfTaskId_e taskId);
 void schedulerSetCalulateTaskStatistics(bool calculateTaskStatistics);
 void schedulerResetTaskStatistics(cfTaskId_e taskId);
 void schedulerResetTaskMaxExecutionTime(cfTaskId_e taskId);
+void schedulerResetTaskHistogram(cfTaskId_e taskId);
+void schedulerSetDeadlineScheduling(bool deadlineScheduling);
+void schedulerSignalTask(cfTaskId_e taskId);
 
 void schedulerInit(void);
 void scheduler(void);
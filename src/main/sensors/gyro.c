@@ -74,6 +74,8 @@
 #include "fc/config.h"
 #include "fc/runtime_config.h"
 
+#include "flight/rpm_filter.h"
+
 #include "io/beeper.h"
 #include "io/statusindicator.h"
 
@@ -84,6 +86,7 @@
 #ifdef USE_GYRO_DATA_ANALYSE
 #include "sensors/gyroanalyse.h"
 #endif
+#include "sensors/gyro_capture.h"
 #include "sensors/sensors.h"
 #ifdef USE_GYRO_IMUF9001
 
@@ -150,15 +153,20 @@ typedef struct gyroSensor_s {
     filterApplyFnPtr lowpass2FilterApplyFn;
     gyroLowpassFilter_t lowpass2Filter[XYZ_AXIS_COUNT];
 
-    // notch filters
-    filterApplyFnPtr notchFilter1ApplyFn;
-    biquadFilter_t notchFilter1[XYZ_AXIS_COUNT];
+    // static notch filters, applied to all three axes in one call
+    bool notchFilter1Enabled;
+    biquadFilter3_t notchFilter1;
 
-    filterApplyFnPtr notchFilter2ApplyFn;
-    biquadFilter_t notchFilter2[XYZ_AXIS_COUNT];
+    bool notchFilter2Enabled;
+    biquadFilter3_t notchFilter2;
 
     filterApplyFnPtr notchFilterDynApplyFn;
-    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT];
+    uint8_t notchFilterDynCount;
+    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+
+#ifdef USE_RPM_FILTER
+    rpmFilterGyroState_t rpmFilterState;
+#endif
 
     // overflow and recovery
     timeUs_t overflowTimeUs;
@@ -171,6 +179,13 @@ typedef struct gyroSensor_s {
 #ifdef USE_GYRO_DATA_ANALYSE
     gyroAnalyseState_t gyroAnalyseState;
 #endif
+
+#ifdef USE_GYRO_FILTER_VARIANTS
+    // filter chain resolved from the lowpass apply functions, see gyroFilterVariants
+    void (*filterFn)(struct gyroSensor_s *gyroSensor);
+    int8_t filterVariant;
+    bool compareRunGeneric;     // DEBUG_GYRO_FILTER_CYCLES alternates between the chains on each sample of this sensor
+#endif
 } gyroSensor_t;
 
 STATIC_UNIT_TESTED FAST_RAM_ZERO_INIT gyroSensor_t gyroSensor1;
@@ -178,6 +193,11 @@ STATIC_UNIT_TESTED FAST_RAM_ZERO_INIT gyroSensor_t gyroSensor1;
 STATIC_UNIT_TESTED FAST_RAM_ZERO_INIT gyroSensor_t gyroSensor2;
 #endif
 
+#ifdef USE_GYRO_CAPTURE
+// Only one sensor is captured when both are in use
+static FAST_RAM_ZERO_INIT gyroSensor_t *captureSensor;
+#endif
+
 #ifdef UNIT_TEST
 STATIC_UNIT_TESTED gyroSensor_t * const gyroSensorPtr = &gyroSensor1;
 STATIC_UNIT_TESTED gyroDev_t * const gyroDevPtr = &gyroSensor1.gyroDev;
@@ -186,6 +206,9 @@ STATIC_UNIT_TESTED gyroDev_t * const gyroDevPtr = &gyroSensor1.gyroDev;
 #ifndef USE_GYRO_IMUF9001
 static void gyroInitSensorFilters(gyroSensor_t *gyroSensor);
 static void gyroInitLowpassFilterLpf(gyroSensor_t *gyroSensor, int slot, int type, uint16_t lpfHz);
+#ifdef USE_GYRO_FILTER_VARIANTS
+static void gyroInitFilterVariant(gyroSensor_t *gyroSensor);
+#endif
 #endif
 
 #define DEBUG_GYRO_CALIBRATION 3
@@ -202,7 +225,7 @@ static void gyroInitLowpassFilterLpf(gyroSensor_t *gyroSensor, int slot, int typ
 #define GYRO_OVERFLOW_TRIGGER_THRESHOLD 31980  // 97.5% full scale (1950dps for 2000dps gyro)
 #define GYRO_OVERFLOW_RESET_THRESHOLD 30340    // 92.5% full scale (1850dps for 2000dps gyro)
 
-PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 4);
+PG_REGISTER_WITH_RESET_TEMPLATE(gyroConfig_t, gyroConfig, PG_GYRO_CONFIG, 8);
 
 #ifndef GYRO_CONFIG_USE_GYRO_DEFAULT
 #define GYRO_CONFIG_USE_GYRO_DEFAULT GYRO_CONFIG_USE_GYRO_1
@@ -240,6 +263,10 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .imuf_pitch_lpf_cutoff_hz = IMUF_DEFAULT_LPF_HZ,
     .imuf_yaw_lpf_cutoff_hz = IMUF_DEFAULT_LPF_HZ,
     .gyro_offset_yaw = 0,
+    .dyn_notch_analyser = DYN_NOTCH_ANALYSER_FFT,
+    .dyn_notch_count = 1,
+    .gyro_spi_dma = false,
+    .gyro_capture = false,
 );
 #else //USE_GYRO_IMUF9001
 PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
@@ -268,6 +295,10 @@ PG_RESET_TEMPLATE(gyroConfig_t, gyroConfig,
     .yaw_spin_threshold = 1950,
     .dyn_notch_quality = 70,
     .dyn_notch_width_percent = 50,
+    .dyn_notch_analyser = DYN_NOTCH_ANALYSER_FFT,
+    .dyn_notch_count = 1,
+    .gyro_spi_dma = false,
+    .gyro_capture = false,
 );
 #endif //USE_GYRO_IMUF9001
 
@@ -545,6 +576,9 @@ static bool gyroInitSensor(gyroSensor_t *gyroSensor)
     gyro.targetLooptime = gyroSetSampleRate(&gyroSensor->gyroDev, gyroConfig()->gyro_hardware_lpf, gyroConfig()->gyro_sync_denom, gyroConfig()->gyro_use_32khz);
     gyroSensor->gyroDev.hardware_lpf = gyroConfig()->gyro_hardware_lpf;
     gyroSensor->gyroDev.hardware_32khz_lpf = gyroConfig()->gyro_32khz_hardware_lpf;
+#ifdef USE_SPI_DMA_READ
+    gyroSensor->gyroDev.useSpiDma = gyroConfig()->gyro_spi_dma;
+#endif
     gyroSensor->gyroDev.initFn(&gyroSensor->gyroDev);
 
 
@@ -607,6 +641,9 @@ bool gyroInit(void)
     case DEBUG_GYRO_RAW:
     case DEBUG_GYRO_SCALED:
     case DEBUG_GYRO_FILTERED:
+#ifdef USE_GYRO_FILTER_VARIANTS
+    case DEBUG_GYRO_FILTER_CYCLES:
+#endif
         gyroDebugMode = debugMode;
         break;
     default:
@@ -620,6 +657,15 @@ bool gyroInit(void)
     memset(&gyro, 0, sizeof(gyro));
     gyroToUse = gyroConfig()->gyro_to_use;
 
+#ifdef USE_GYRO_CAPTURE
+    captureSensor = &gyroSensor1;
+#ifdef USE_DUAL_GYRO
+    if (gyroToUse == GYRO_CONFIG_USE_GYRO_2) {
+        captureSensor = &gyroSensor2;
+    }
+#endif
+#endif
+
 #if defined(USE_DUAL_GYRO) && defined(GYRO_1_CS_PIN)
     if (gyroToUse == GYRO_CONFIG_USE_GYRO_1 || gyroToUse == GYRO_CONFIG_USE_GYRO_BOTH) {
         gyroSensor1.gyroDev.bus.busdev_u.spi.csnPin = IOGetByTag(IO_TAG(GYRO_1_CS_PIN));
@@ -790,31 +836,27 @@ void gyroInitSlewLimiter(gyroSensor_t *gyroSensor) {
 
 static void gyroInitFilterNotch1(gyroSensor_t *gyroSensor, uint16_t notchHz, uint16_t notchCutoffHz)
 {
-    gyroSensor->notchFilter1ApplyFn = nullFilterApply;
+    gyroSensor->notchFilter1Enabled = false;
 
     notchHz = calculateNyquistAdjustedNotchHz(notchHz, notchCutoffHz);
 
     if (notchHz != 0 && notchCutoffHz != 0) {
-        gyroSensor->notchFilter1ApplyFn = (filterApplyFnPtr)biquadFilterApply;
+        gyroSensor->notchFilter1Enabled = true;
         const float notchQ = filterGetNotchQ(notchHz, notchCutoffHz);
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyroSensor->notchFilter1[axis], notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
-        }
+        biquadFilter3Init(&gyroSensor->notchFilter1, notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
     }
 }
 
 static void gyroInitFilterNotch2(gyroSensor_t *gyroSensor, uint16_t notchHz, uint16_t notchCutoffHz)
 {
-    gyroSensor->notchFilter2ApplyFn = nullFilterApply;
+    gyroSensor->notchFilter2Enabled = false;
 
     notchHz = calculateNyquistAdjustedNotchHz(notchHz, notchCutoffHz);
 
     if (notchHz != 0 && notchCutoffHz != 0) {
-        gyroSensor->notchFilter2ApplyFn = (filterApplyFnPtr)biquadFilterApply;
+        gyroSensor->notchFilter2Enabled = true;
         const float notchQ = filterGetNotchQ(notchHz, notchCutoffHz);
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyroSensor->notchFilter2[axis], notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
-        }
+        biquadFilter3Init(&gyroSensor->notchFilter2, notchHz, gyro.targetLooptime, notchQ, FILTER_NOTCH);
     }
 }
 
@@ -827,12 +869,15 @@ static bool isDynamicFilterActive(void)
 static void gyroInitFilterDynamicNotch(gyroSensor_t *gyroSensor)
 {
     gyroSensor->notchFilterDynApplyFn = nullFilterApply;
+    gyroSensor->notchFilterDynCount = constrain(gyroConfig()->dyn_notch_count, 1, DYN_NOTCH_COUNT_MAX);
 
     if (isDynamicFilterActive()) {
         gyroSensor->notchFilterDynApplyFn = (filterApplyFnPtr)biquadFilterApplyDF1; // must be this function, not DF2
         const float notchQ = filterGetNotchQ(400, 390); //just any init value
         for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterInit(&gyroSensor->notchFilterDyn[axis], 400, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+            for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+                biquadFilterInit(&gyroSensor->notchFilterDyn[axis][i], 400, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+            }
         }
     }
 }
@@ -864,6 +909,9 @@ static void gyroInitSensorFilters(gyroSensor_t *gyroSensor)
 #ifdef USE_GYRO_DATA_ANALYSE
     gyroInitFilterDynamicNotch(gyroSensor);
 #endif
+#ifdef USE_GYRO_FILTER_VARIANTS
+    gyroInitFilterVariant(gyroSensor);
+#endif
 }
 
 void gyroInitFilters(void)
@@ -1106,6 +1154,11 @@ static FAST_CODE void checkForYawSpin(gyroSensor_t *gyroSensor, timeUs_t current
 #endif // USE_YAW_SPIN_RECOVERY
 
 #ifndef USE_GYRO_IMUF9001
+// filter stages called through the apply functions chosen at init
+#define GYRO_FILTER_LOWPASS(filter, value)   gyroSensor->lowpassFilterApplyFn((filter_t *)(filter), value)
+#define GYRO_FILTER_LOWPASS2(filter, value)  gyroSensor->lowpass2FilterApplyFn((filter_t *)(filter), value)
+#define GYRO_FILTER_NOTCH_DYN(filter, value) gyroSensor->notchFilterDynApplyFn((filter_t *)(filter), value)
+
 #define GYRO_FILTER_FUNCTION_NAME filterGyro
 #define GYRO_FILTER_DEBUG_SET(...)
 #include "gyro_filter_impl.h"
@@ -1117,8 +1170,131 @@ static FAST_CODE void checkForYawSpin(gyroSensor_t *gyroSensor, timeUs_t current
 #include "gyro_filter_impl.h"
 #undef GYRO_FILTER_FUNCTION_NAME
 #undef GYRO_FILTER_DEBUG_SET
+
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+#undef GYRO_FILTER_NOTCH_DYN
+
+#ifdef USE_GYRO_FILTER_VARIANTS
+/*
+ * Copies of filterGyro for the common lowpass configurations, with every stage called directly.
+ * This removes the indirect calls, and the calls to nullFilterApply for disabled stages, from the gyro loop.
+ */
+#define GYRO_LOWPASS_OFF(filter, value)      (value)
+#define GYRO_LOWPASS_PT1(filter, value)      pt1FilterApply(&(filter)->pt1FilterState, value)
+#define GYRO_LOWPASS_BIQUAD(filter, value)   biquadFilterApply(&(filter)->biquadFilterState, value)
+#define GYRO_LOWPASS_KALMAN(filter, value)   fastKalmanUpdate(&(filter)->kalmanFilterState, value)
+#define GYRO_FILTER_NOTCH_DYN(filter, value) biquadFilterApplyDF1(filter, value)
+#define GYRO_FILTER_DEBUG_SET(...)
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroOffOff
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_OFF
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_OFF
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroOffBiquad
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_OFF
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_BIQUAD
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Off
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_PT1
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_OFF
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Pt1
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_PT1
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_PT1
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroPt1Biquad
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_PT1
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_BIQUAD
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#define GYRO_FILTER_FUNCTION_NAME filterGyroKalmanBiquad
+#define GYRO_FILTER_LOWPASS  GYRO_LOWPASS_KALMAN
+#define GYRO_FILTER_LOWPASS2 GYRO_LOWPASS_BIQUAD
+#include "gyro_filter_impl.h"
+#undef GYRO_FILTER_FUNCTION_NAME
+#undef GYRO_FILTER_LOWPASS
+#undef GYRO_FILTER_LOWPASS2
+
+#undef GYRO_FILTER_NOTCH_DYN
+#undef GYRO_FILTER_DEBUG_SET
+
+typedef struct gyroFilterVariant_s {
+    filterApplyFnPtr lowpassFilterApplyFn;
+    filterApplyFnPtr lowpass2FilterApplyFn;
+    void (*filterFn)(gyroSensor_t *gyroSensor);
+} gyroFilterVariant_t;
+
+static const gyroFilterVariant_t gyroFilterVariants[] = {
+    { nullFilterApply,                     nullFilterApply,                        filterGyroOffOff },
+    { nullFilterApply,                     (filterApplyFnPtr)biquadFilterApply,    filterGyroOffBiquad },
+    { (filterApplyFnPtr)pt1FilterApply,    nullFilterApply,                        filterGyroPt1Off },
+    { (filterApplyFnPtr)pt1FilterApply,    (filterApplyFnPtr)pt1FilterApply,       filterGyroPt1Pt1 },
+    { (filterApplyFnPtr)pt1FilterApply,    (filterApplyFnPtr)biquadFilterApply,    filterGyroPt1Biquad },
+    { (filterApplyFnPtr)fastKalmanUpdate,  (filterApplyFnPtr)biquadFilterApply,    filterGyroKalmanBiquad },
+};
+
+static void gyroInitFilterVariant(gyroSensor_t *gyroSensor)
+{
+    gyroSensor->filterFn = filterGyro;
+    gyroSensor->filterVariant = -1;
+
+#ifdef USE_GYRO_DATA_ANALYSE
+    // the variants call the dynamic notch directly, so they are only valid for the apply function they were built for
+    if (gyroSensor->notchFilterDynApplyFn != nullFilterApply && gyroSensor->notchFilterDynApplyFn != (filterApplyFnPtr)biquadFilterApplyDF1) {
+        return;
+    }
 #endif
 
+    for (unsigned i = 0; i < ARRAYLEN(gyroFilterVariants); i++) {
+        if (gyroFilterVariants[i].lowpassFilterApplyFn == gyroSensor->lowpassFilterApplyFn
+            && gyroFilterVariants[i].lowpass2FilterApplyFn == gyroSensor->lowpass2FilterApplyFn) {
+            gyroSensor->filterFn = gyroFilterVariants[i].filterFn;
+            gyroSensor->filterVariant = i;
+            return;
+        }
+    }
+}
+
+// runs the specialised and the generic filter chain on alternate samples and logs the cycles each one took
+static FAST_CODE_NOINLINE void filterGyroCompareCycles(gyroSensor_t *gyroSensor)
+{
+    const bool runGeneric = gyroSensor->compareRunGeneric;
+
+    const uint32_t startCycles = ticks();
+    if (runGeneric) {
+        filterGyro(gyroSensor);
+    } else {
+        gyroSensor->filterFn(gyroSensor);
+    }
+    const uint32_t cycles = ticks() - startCycles;
+
+    DEBUG_SET(DEBUG_GYRO_FILTER_CYCLES, runGeneric ? 1 : 0, cycles);
+    DEBUG_SET(DEBUG_GYRO_FILTER_CYCLES, 2, gyroSensor->filterVariant);
+    gyroSensor->compareRunGeneric = !runGeneric;
+}
+#endif // USE_GYRO_FILTER_VARIANTS
+#endif // USE_GYRO_IMUF9001
+
 static FAST_CODE_NOINLINE void gyroUpdateSensor(gyroSensor_t* gyroSensor, timeUs_t currentTimeUs)
 {
     #ifndef USE_DMA_SPI_DEVICE
@@ -1151,6 +1327,12 @@ static FAST_CODE_NOINLINE void gyroUpdateSensor(gyroSensor_t* gyroSensor, timeUs
     }
 #else
     if (isGyroSensorCalibrationComplete(gyroSensor)) {
+#ifdef USE_GYRO_CAPTURE
+        if (gyroSensor == captureSensor) {
+            gyroCaptureSample(gyroSensor->gyroDev.gyroADCRaw);
+        }
+#endif
+
         // move 16-bit gyro data into 32-bit variables to avoid overflows in calculations
 
 #if defined(USE_GYRO_SLEW_LIMITER)
@@ -1173,7 +1355,15 @@ static FAST_CODE_NOINLINE void gyroUpdateSensor(gyroSensor_t* gyroSensor, timeUs
 
 #ifndef USE_GYRO_IMUF9001
     if (gyroDebugMode == DEBUG_NONE) {
+#ifdef USE_GYRO_FILTER_VARIANTS
+        gyroSensor->filterFn(gyroSensor);
+#else
         filterGyro(gyroSensor);
+#endif
+#ifdef USE_GYRO_FILTER_VARIANTS
+    } else if (gyroDebugMode == DEBUG_GYRO_FILTER_CYCLES) {
+        filterGyroCompareCycles(gyroSensor);
+#endif
     } else {
         filterGyroDebug(gyroSensor);
     }
@@ -1385,6 +1575,22 @@ int16_t gyroRateDps(int axis)
 #endif
 }
 
+// rate before the gyro filters, IMU-F only provides the filtered rate
+int16_t gyroRateUnfilteredDps(int axis)
+{
+#ifdef USE_DUAL_GYRO
+    if (gyroToUse == GYRO_CONFIG_USE_GYRO_2) {
+        return lrintf(gyroSensor2.gyroDev.gyroADC[axis] * gyroSensor2.gyroDev.scale);
+    } else {
+        return lrintf(gyroSensor1.gyroDev.gyroADC[axis] * gyroSensor1.gyroDev.scale);
+    }
+#elif defined(USE_GYRO_IMUF9001)
+    return lrintf(gyro.gyroADCf[axis]);
+#else
+    return lrintf(gyroSensor1.gyroDev.gyroADC[axis] * gyroSensor1.gyroDev.scale);
+#endif
+}
+
 bool gyroOverflowDetected(void)
 {
 #ifdef USE_GYRO_OVERFLOW_CHECK
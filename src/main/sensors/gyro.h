@@ -61,6 +61,14 @@ typedef enum {
     GYRO_OVERFLOW_CHECK_ALL_AXES
 } gyroOverflowCheck_e;
 
+// dynamic notches per axis
+#define DYN_NOTCH_COUNT_MAX 3
+
+typedef enum {
+    DYN_NOTCH_ANALYSER_FFT = 0,
+    DYN_NOTCH_ANALYSER_SDFT
+} dynNotchAnalyser_e;
+
 #define GYRO_CONFIG_USE_GYRO_1      0
 #define GYRO_CONFIG_USE_GYRO_2      1
 #define GYRO_CONFIG_USE_GYRO_BOTH   2
@@ -111,6 +119,10 @@ typedef struct gyroConfig_s {
     uint16_t gyroCalibrationDuration;  // Gyro calibration duration in 1/100 second
     uint8_t dyn_notch_quality; // bandpass quality factor, 100 for steep sided bandpass
     uint8_t dyn_notch_width_percent;
+    uint8_t dyn_notch_analyser;        // FFT or sliding DFT, see dynNotchAnalyser_e
+    uint8_t dyn_notch_count;           // dynamic notches per axis, each following one spectral peak
+    uint8_t gyro_spi_dma;              // read the gyro with SPI DMA started from the data ready interrupt
+    uint8_t gyro_capture;              // keep the raw gyro samples of each flight in RAM, see gyro_capture.h
 #if defined(USE_GYRO_IMUF9001)
     uint16_t imuf_mode;
     uint16_t imuf_rate;
@@ -149,6 +161,7 @@ bool isGyroCalibrationComplete(void);
 void gyroReadTemperature(void);
 int16_t gyroGetTemperature(void);
 int16_t gyroRateDps(int axis);
+int16_t gyroRateUnfilteredDps(int axis);
 bool gyroOverflowDetected(void);
 bool gyroYawSpinDetected(void);
 uint16_t gyroAbsRateDps(int axis);
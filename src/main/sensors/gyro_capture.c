@@ -0,0 +1,100 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_GYRO_CAPTURE
+
+#include "common/utils.h"
+
+#include "gyro_capture.h"
+
+STATIC_ASSERT((GYRO_CAPTURE_SAMPLE_COUNT & (GYRO_CAPTURE_SAMPLE_COUNT - 1)) == 0, gyro_capture_sample_count_not_power_of_two);
+
+// CCM on F4 and DTCM on F7, only the CPU touches the buffer
+static FAST_RAM_ZERO_INIT int16_t captureBuffer[GYRO_CAPTURE_SAMPLE_COUNT][XYZ_AXIS_COUNT];
+static FAST_RAM_ZERO_INIT uint16_t captureHead;
+static FAST_RAM_ZERO_INIT uint16_t captureCount;
+static FAST_RAM_ZERO_INIT uint8_t captureState;
+static uint32_t captureSampleIntervalUs;
+
+/*
+ * Start a new capture, discarding the previous one. Samples are kept until the capture is stopped, the oldest
+ * being overwritten once the buffer is full.
+ */
+void gyroCaptureStart(uint32_t sampleIntervalUs)
+{
+    captureHead = 0;
+    captureCount = 0;
+    captureSampleIntervalUs = sampleIntervalUs;
+    captureState = GYRO_CAPTURE_RUNNING;
+}
+
+void gyroCaptureStop(void)
+{
+    if (captureState == GYRO_CAPTURE_RUNNING) {
+        captureState = GYRO_CAPTURE_STOPPED;
+    }
+}
+
+// Called for every gyro sample
+FAST_CODE void gyroCaptureSample(const int16_t *sample)
+{
+    if (captureState != GYRO_CAPTURE_RUNNING) {
+        return;
+    }
+
+    int16_t *slot = captureBuffer[captureHead];
+    slot[X] = sample[X];
+    slot[Y] = sample[Y];
+    slot[Z] = sample[Z];
+
+    captureHead = (captureHead + 1) & (GYRO_CAPTURE_SAMPLE_COUNT - 1);
+    if (captureCount < GYRO_CAPTURE_SAMPLE_COUNT) {
+        captureCount++;
+    }
+}
+
+gyroCaptureState_e gyroCaptureGetState(void)
+{
+    return captureState;
+}
+
+int gyroCaptureSampleCount(void)
+{
+    return captureCount;
+}
+
+uint32_t gyroCaptureSampleIntervalUs(void)
+{
+    return captureSampleIntervalUs;
+}
+
+// Index 0 is the oldest sample held
+void gyroCaptureGetSample(int index, int16_t *sample)
+{
+    const int16_t *slot = captureBuffer[(captureHead - captureCount + index) & (GYRO_CAPTURE_SAMPLE_COUNT - 1)];
+    memcpy(sample, slot, sizeof(captureBuffer[0]));
+}
+
+#endif // USE_GYRO_CAPTURE
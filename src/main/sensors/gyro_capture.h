@@ -0,0 +1,48 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/axis.h"
+
+/*
+ * Raw gyro capture keeps the most recent unfiltered gyro samples, at the full gyro rate, in a RAM ring buffer
+ * so they can be downloaded for spectral analysis after the flight.
+ */
+#ifndef GYRO_CAPTURE_SAMPLE_COUNT
+#define GYRO_CAPTURE_SAMPLE_COUNT 2048 // must be a power of two
+#endif
+
+typedef enum {
+    GYRO_CAPTURE_IDLE = 0,
+    GYRO_CAPTURE_RUNNING,
+    GYRO_CAPTURE_STOPPED
+} gyroCaptureState_e;
+
+void gyroCaptureStart(uint32_t sampleIntervalUs);
+void gyroCaptureStop(void);
+void gyroCaptureSample(const int16_t *sample);
+
+gyroCaptureState_e gyroCaptureGetState(void);
+int gyroCaptureSampleCount(void);
+uint32_t gyroCaptureSampleIntervalUs(void);
+void gyroCaptureGetSample(int index, int16_t *sample);
@@ -1,31 +1,48 @@
 static FAST_CODE void GYRO_FILTER_FUNCTION_NAME(gyroSensor_t *gyroSensor)
 {
+    float gyroADCScaled[XYZ_AXIS_COUNT];
+
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_RAW, axis, gyroSensor->gyroDev.gyroADCRaw[axis]);
         // scale gyro output to degrees per second
-        float gyroADCf = gyroSensor->gyroDev.gyroADC[axis] * gyroSensor->gyroDev.scale;
+        gyroADCScaled[axis] = gyroSensor->gyroDev.gyroADC[axis] * gyroSensor->gyroDev.scale;
         // DEBUG_GYRO_SCALED records the unfiltered, scaled gyro output
-        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_SCALED, axis, lrintf(gyroADCf));
+        GYRO_FILTER_DEBUG_SET(DEBUG_GYRO_SCALED, axis, lrintf(gyroADCScaled[axis]));
+    }
 
 #ifdef USE_GYRO_DATA_ANALYSE
-        if (isDynamicFilterActive()) {
-            if (axis == X) {
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 0, lrintf(gyroADCf)); // store raw data
-                GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 3, lrintf(gyroADCf)); // store raw data
-            }
-        }
+    if (isDynamicFilterActive()) {
+        GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 0, lrintf(gyroADCScaled[X])); // store raw data
+        GYRO_FILTER_DEBUG_SET(DEBUG_FFT_FREQ, 3, lrintf(gyroADCScaled[X])); // store raw data
+    }
 #endif
 
-        // apply static notch filters and software lowpass filters
-        gyroADCf = gyroSensor->notchFilter1ApplyFn((filter_t *)&gyroSensor->notchFilter1[axis], gyroADCf);
-        gyroADCf = gyroSensor->notchFilter2ApplyFn((filter_t *)&gyroSensor->notchFilter2[axis], gyroADCf);
-        gyroADCf = gyroSensor->lowpassFilterApplyFn((filter_t *)&gyroSensor->lowpassFilter[axis], gyroADCf);
-        gyroADCf = gyroSensor->lowpass2FilterApplyFn((filter_t *)&gyroSensor->lowpass2Filter[axis], gyroADCf);
+    // apply static notch filters, all axes at once
+    if (gyroSensor->notchFilter1Enabled) {
+        biquadFilter3Apply(&gyroSensor->notchFilter1, gyroADCScaled);
+    }
+    if (gyroSensor->notchFilter2Enabled) {
+        biquadFilter3Apply(&gyroSensor->notchFilter2, gyroADCScaled);
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        float gyroADCf = gyroADCScaled[axis];
+
+        // apply software lowpass filters
+        gyroADCf = GYRO_FILTER_LOWPASS(&gyroSensor->lowpassFilter[axis], gyroADCf);
+        gyroADCf = GYRO_FILTER_LOWPASS2(&gyroSensor->lowpass2Filter[axis], gyroADCf);
+
+#ifdef USE_RPM_FILTER
+        // motor harmonic notches, centred on the current motor rpm
+        gyroADCf = rpmFilterGyro(&gyroSensor->rpmFilterState, axis, gyroADCf);
+#endif
 
 #ifdef USE_GYRO_DATA_ANALYSE
         if (isDynamicFilterActive()) {
             gyroDataAnalysePush(&gyroSensor->gyroAnalyseState, axis, gyroADCf);
-            gyroADCf = gyroSensor->notchFilterDynApplyFn((filter_t *)&gyroSensor->notchFilterDyn[axis], gyroADCf);
+            for (int i = 0; i < gyroSensor->notchFilterDynCount; i++) {
+                gyroADCf = GYRO_FILTER_NOTCH_DYN(&gyroSensor->notchFilterDyn[axis][i], gyroADCf);
+            }
             if (axis == X) {
                 GYRO_FILTER_DEBUG_SET(DEBUG_FFT, 1, lrintf(gyroADCf)); // store data after dynamic notch
             }
@@ -23,7 +23,10 @@
  * coding assistance and advice from DieHertz, Rav, eTracer
  * test pilots icr4sh, UAV Tech, Flint723
  */
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -60,6 +63,15 @@
 #define DYN_NOTCH_MIN_CUTOFF_HZ   105
 // we need 4 steps for each axis
 #define DYN_NOTCH_CALC_TICKS      (XYZ_AXIS_COUNT * 4)
+// band maintained by the sliding DFT
+#define SDFT_MIN_HZ               100
+#define SDFT_MAX_HZ               600
+// a peak must stand this far above the mean power of the band, the coarse FFT bins leave no room for more margin
+#define FFT_PEAK_THRESHOLD        1.0f
+#define SDFT_PEAK_THRESHOLD       2.0f
+// notch Q limits when the notch width follows the measured peak width
+#define DYN_NOTCH_Q_MIN           1.5f
+#define DYN_NOTCH_Q_MAX           8.0f
 
 static uint16_t FAST_RAM_ZERO_INIT fftSamplingRateHz;
 // centre frequency of bandpass that constrains input to FFT
@@ -73,6 +85,12 @@ static uint8_t  FAST_RAM_ZERO_INIT fftBinOffset;
 // Hanning window, see https://en.wikipedia.org/wiki/Window_function#Hann_.28Hanning.29_window
 static FAST_RAM_ZERO_INIT float hanningWindow[FFT_WINDOW_SIZE];
 static FAST_RAM_ZERO_INIT float dynamicNotchCutoff;
+static uint8_t  FAST_RAM_ZERO_INIT dynNotchCount;
+#ifdef USE_DYN_NOTCH_SDFT
+static uint8_t  FAST_RAM_ZERO_INIT dynNotchAnalyser;
+// Hz per sliding DFT bin
+static float FAST_RAM_ZERO_INIT    sdftResolution;
+#endif
 
 void gyroDataAnalyseInit(uint32_t targetLooptimeUs)
 {
@@ -104,6 +122,11 @@ void gyroDataAnalyseInit(uint32_t targetLooptimeUs)
     }
 
     dynamicNotchCutoff = (100.0f - gyroConfig()->dyn_notch_width_percent) / 100;
+    dynNotchCount = constrain(gyroConfig()->dyn_notch_count, 1, DYN_NOTCH_COUNT_MAX);
+
+#ifdef USE_DYN_NOTCH_SDFT
+    dynNotchAnalyser = gyroConfig()->dyn_notch_analyser;
+#endif
 }
 
 void gyroDataAnalyseStateInit(gyroAnalyseState_t *state, uint32_t targetLooptimeUs)
@@ -111,7 +134,11 @@ void gyroDataAnalyseStateInit(gyroAnalyseState_t *state, uint32_t targetLooptime
     // initialise even if FEATURE_DYNAMIC_FILTER not set, since it may be set later
     gyroDataAnalyseInit(targetLooptimeUs);
 
-    const uint16_t samplingFrequency = 1000000 / targetLooptimeUs;
+    // start from empty buffers and step state, gyroInit() may run again after the config changed
+    memset(state, 0, sizeof(*state));
+
+    // round like gyroDataAnalyseInit, otherwise 375us gives 2 samples per 889Hz analyser sample
+    const uint16_t samplingFrequency = lrintf(1e6f / targetLooptimeUs);
     state->maxSampleCount = samplingFrequency / fftSamplingRateHz;
     state->maxSampleCountRcp = 1.f / state->maxSampleCount;
 
@@ -127,6 +154,29 @@ void gyroDataAnalyseStateInit(gyroAnalyseState_t *state, uint32_t targetLooptime
         biquadFilterInit(&state->gyroBandpassFilter[axis], fftBpfHz, 1000000 / fftSamplingRateHz, 0.01f * gyroConfig()->dyn_notch_quality, FILTER_BPF);
         biquadFilterInitLPF(&state->detectedFrequencyFilter[axis], DYN_NOTCH_SMOOTH_FREQ_HZ, looptime);
     }
+
+    // peaks of an axis are found once per FFT of that axis, or with every sample of the sliding DFT
+    float peakUpdatePeriodS = looptime * 1e-6f;
+#ifdef USE_DYN_NOTCH_SDFT
+    if (dynNotchAnalyser == DYN_NOTCH_ANALYSER_SDFT) {
+        peakUpdatePeriodS = 1.0f / fftSamplingRateHz;
+    }
+
+    // the sliding DFT runs at the downsampled rate, with finer bins than the FFT
+    sdftResolution = (float)fftSamplingRateHz / SDFT_SAMPLE_SIZE;
+    const int sdftStartBin = lrintf(SDFT_MIN_HZ / sdftResolution);
+    const int sdftEndBin = lrintf(SDFT_MAX_HZ / sdftResolution);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        sdftInit(&state->sdft[axis], sdftStartBin, sdftEndBin);
+    }
+#endif
+
+    const float peakSmoothingGain = pt1FilterGain(DYN_NOTCH_SMOOTH_FREQ_HZ, peakUpdatePeriodS);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+            pt1FilterInit(&state->peakFrequencyFilter[axis][i], peakSmoothingGain);
+        }
+    }
 }
 
 void gyroDataAnalysePush(gyroAnalyseState_t *state, const int axis, const float sample)
@@ -134,12 +184,147 @@ void gyroDataAnalysePush(gyroAnalyseState_t *state, const int axis, const float
     state->oversampledGyroAccumulator[axis] += sample;
 }
 
-static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn);
+static void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX]);
+#ifdef USE_DYN_NOTCH_SDFT
+static void gyroDataAnalyseSdft(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX]);
+#endif
+
+// single dynamic notch, centred on centerFreq with a width set by dyn_notch_width_percent
+static FAST_CODE void dynNotchUpdate(const gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX], int axis)
+{
+    // calculate cutoffFreq and notch Q, update notch filter
+    const float cutoffFreq = fmax(state->centerFreq[axis] * dynamicNotchCutoff, DYN_NOTCH_MIN_CUTOFF_HZ);
+    const float notchQ = filterGetNotchQ(state->centerFreq[axis], cutoffFreq);
+    biquadFilterUpdate(&notchFilterDyn[axis][0], state->centerFreq[axis], gyro.targetLooptime, notchQ, FILTER_NOTCH);
+}
 
 /*
- * Collect gyro data, to be analysed in gyroDataAnalyseUpdate function
+ * Notch cascade, each notch follows one tracked peak with a width matching the measured peak width.
+ * Only one notch is recalculated per call to bound the time spent in the gyro task.
  */
-void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn)
+static FAST_CODE void dynNotchUpdateNext(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
+{
+    const int axis = state->notchUpdateIdx / dynNotchCount;
+    const int i = state->notchUpdateIdx % dynNotchCount;
+    if (++state->notchUpdateIdx == XYZ_AXIS_COUNT * dynNotchCount) {
+        state->notchUpdateIdx = 0;
+    }
+
+    const dynNotchPeak_t *peak = &state->peaks[axis][i];
+    if (!peak->frequency) {
+        // nothing was found for this slot yet, leave the notch at its initial frequency
+        return;
+    }
+
+    const float centerFreq = constrainf(peak->frequency, DYN_NOTCH_MIN_CENTRE_HZ, dynNotchMaxCentreHz);
+    const float notchQ = constrainf(centerFreq / MAX(peak->width, 1.0f), DYN_NOTCH_Q_MIN, DYN_NOTCH_Q_MAX);
+    biquadFilterUpdate(&notchFilterDyn[axis][i], centerFreq, gyro.targetLooptime, notchQ, FILTER_NOTCH);
+}
+
+/*
+ * Find the local maxima of data[startBin + 1 .. endBin - 1] that stand threshold times above the mean power.
+ * The strongest DYN_NOTCH_COUNT_MAX are returned in descending order of power, with their frequency refined
+ * by quadratic interpolation and their -3dB width measured from the neighbouring bins.
+ */
+static FAST_CODE int dynNotchFindPeaks(const float *data, int startBin, int endBin, float resolution, float threshold, dynNotchPeak_t *peaks)
+{
+    float meanPower = 0;
+    for (int k = startBin; k <= endBin; k++) {
+        meanPower += data[k];
+    }
+    meanPower /= endBin - startBin + 1;
+
+    int peakCount = 0;
+    for (int k = startBin + 1; k < endBin; k++) {
+        const float power = data[k];
+        if (power <= data[k - 1] || power < data[k + 1] || power <= meanPower * threshold) {
+            continue;
+        }
+        if (peakCount == DYN_NOTCH_COUNT_MAX && power <= peaks[DYN_NOTCH_COUNT_MAX - 1].power) {
+            continue;
+        }
+
+        // quadratic interpolation over the bin magnitudes gives a resolution well below the bin width
+        const float y0 = sqrtf(data[k - 1]);
+        const float y1 = sqrtf(power);
+        const float y2 = sqrtf(data[k + 1]);
+        const float denominator = y0 - 2 * y1 + y2;
+        const float offset = denominator ? 0.5f * (y0 - y2) / denominator : 0.0f;
+
+        // half power points, interpolated between the bins on either side
+        const float halfPower = 0.5f * power;
+        int left = k - 1;
+        while (left > startBin && data[left] > halfPower) {
+            left--;
+        }
+        int right = k + 1;
+        while (right < endBin && data[right] > halfPower) {
+            right++;
+        }
+        const float leftEdge = left + constrainf((halfPower - data[left]) / (data[left + 1] - data[left]), 0.0f, 1.0f);
+        const float rightEdge = right - constrainf((halfPower - data[right]) / (data[right - 1] - data[right]), 0.0f, 1.0f);
+
+        int i = (peakCount < DYN_NOTCH_COUNT_MAX) ? peakCount++ : DYN_NOTCH_COUNT_MAX - 1;
+        for (; i > 0 && peaks[i - 1].power < power; i--) {
+            peaks[i] = peaks[i - 1];
+        }
+        peaks[i].frequency = (k + offset) * resolution;
+        peaks[i].power = power;
+        peaks[i].width = (rightEdge - leftEdge) * resolution;
+    }
+
+    return peakCount;
+}
+
+/*
+ * Assign the peaks found in this update to the tracked slots, strongest first, each to the nearest free slot.
+ * maxHz is the top of the analysed band, an empty slot counts as that far away from any peak.
+ * Slots keep their identity over time, so each one can be smoothed and can drive its own notch.
+ * Returns the slot of the strongest peak, or -1 if there was none.
+ */
+static FAST_CODE int dynNotchTrackPeaks(gyroAnalyseState_t *state, int axis, const dynNotchPeak_t *found, int count, float maxHz)
+{
+    bool slotMatched[DYN_NOTCH_COUNT_MAX] = { false };
+    int strongestSlot = -1;
+
+    for (int i = 0; i < count; i++) {
+        int slot = -1;
+        float slotDistance = 0;
+        for (int j = 0; j < DYN_NOTCH_COUNT_MAX; j++) {
+            if (slotMatched[j]) {
+                continue;
+            }
+            // an empty slot is only used when no tracked peak is closer than the whole band
+            const float distance = state->peaks[axis][j].frequency ? fabsf(state->peaks[axis][j].frequency - found[i].frequency) : maxHz;
+            if (slot < 0 || distance < slotDistance) {
+                slot = j;
+                slotDistance = distance;
+            }
+        }
+
+        slotMatched[slot] = true;
+        if (i == 0) {
+            strongestSlot = slot;
+        }
+        dynNotchPeak_t *peak = &state->peaks[axis][slot];
+        if (!peak->frequency) {
+            state->peakFrequencyFilter[axis][slot].state = found[i].frequency;
+        }
+        peak->frequency = pt1FilterApply(&state->peakFrequencyFilter[axis][slot], found[i].frequency);
+        peak->power = found[i].power;
+        peak->width = found[i].width;
+    }
+
+    for (int j = 0; j < DYN_NOTCH_COUNT_MAX; j++) {
+        if (!slotMatched[j]) {
+            state->peaks[axis][j].power = 0.0f;
+        }
+    }
+
+    return strongestSlot;
+}
+
+static FAST_CODE_NOINLINE void gyroDataAnalyseFft(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
 {
     // samples should have been pushed by `gyroDataAnalysePush`
     // if gyro sampling is > 1kHz, accumulate multiple samples
@@ -175,6 +360,25 @@ void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn)
     }
 }
 
+/*
+ * Collect gyro data, to be analysed in gyroDataAnalyseUpdate or gyroDataAnalyseSdft
+ */
+void gyroDataAnalyse(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
+{
+#ifdef USE_DYN_NOTCH_SDFT
+    if (dynNotchAnalyser == DYN_NOTCH_ANALYSER_SDFT) {
+        gyroDataAnalyseSdft(state, notchFilterDyn);
+    } else
+#endif
+    {
+        gyroDataAnalyseFft(state, notchFilterDyn);
+    }
+
+    if (dynNotchCount > 1) {
+        dynNotchUpdateNext(state, notchFilterDyn);
+    }
+}
+
 void stage_rfft_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut);
 void arm_cfft_radix8by2_f32(arm_cfft_instance_f32 *S, float32_t *p1);
 void arm_cfft_radix8by4_f32(arm_cfft_instance_f32 *S, float32_t *p1);
@@ -184,7 +388,7 @@ void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t
 /*
  * Analyse last gyro data from the last FFT_WINDOW_SIZE milliseconds
  */
-static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t *notchFilterDyn)
+static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
 {
     enum {
         STEP_ARM_CFFT_F32,
@@ -297,6 +501,16 @@ static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state,
             if (state->updateAxis == 0) {
                DEBUG_SET(DEBUG_FFT, 3, lrintf(fftMeanIndex * 100));
             }
+
+            if (dynNotchCount > 1) {
+                // peak search works on power, the bins hold magnitudes
+                for (int i = fftBinOffset; i < FFT_BIN_COUNT; i++) {
+                    state->fftData[i] *= state->fftData[i];
+                }
+                dynNotchPeak_t found[DYN_NOTCH_COUNT_MAX];
+                const int peakCount = dynNotchFindPeaks(state->fftData, fftBinOffset, FFT_BIN_COUNT - 1, fftResolution, FFT_PEAK_THRESHOLD, found);
+                dynNotchTrackPeaks(state, state->updateAxis, found, peakCount, dynNotchMaxCentreHz);
+            }
             DEBUG_SET(DEBUG_FFT_FREQ, state->updateAxis, state->centerFreq[state->updateAxis]);
             DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
             break;
@@ -304,10 +518,9 @@ static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state,
         case STEP_UPDATE_FILTERS:
         {
             // 7us
-            // calculate cutoffFreq and notch Q, update notch filter
-            const float cutoffFreq = fmax(state->centerFreq[state->updateAxis] * dynamicNotchCutoff, DYN_NOTCH_MIN_CUTOFF_HZ);
-            const float notchQ = filterGetNotchQ(state->centerFreq[state->updateAxis], cutoffFreq);
-            biquadFilterUpdate(&notchFilterDyn[state->updateAxis], state->centerFreq[state->updateAxis], gyro.targetLooptime, notchQ, FILTER_NOTCH);
+            if (dynNotchCount == 1) {
+                dynNotchUpdate(state, notchFilterDyn, state->updateAxis);
+            }
             DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
 
             state->updateAxis = (state->updateAxis + 1) % XYZ_AXIS_COUNT;
@@ -331,4 +544,65 @@ static FAST_CODE_NOINLINE void gyroDataAnalyseUpdate(gyroAnalyseState_t *state,
 
     state->updateStep = (state->updateStep + 1) % STEP_COUNT;
 }
+
+#ifdef USE_DYN_NOTCH_SDFT
+static FAST_CODE_NOINLINE void sdftUpdateAxis(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX], int axis)
+{
+    sdft_t *sdft = &state->sdft[axis];
+
+    sdftPush(sdft, state->sdftSample[axis]);
+    sdftWinSq(sdft, state->sdftData);
+
+    dynNotchPeak_t found[DYN_NOTCH_COUNT_MAX];
+    const int peakCount = dynNotchFindPeaks(state->sdftData, sdft->startBin, sdft->endBin, sdftResolution, SDFT_PEAK_THRESHOLD, found);
+    const int strongestSlot = dynNotchTrackPeaks(state, axis, found, peakCount, SDFT_MAX_HZ);
+
+    // the single dynamic notch follows the strongest peak, and stays put while there is none
+    if (strongestSlot >= 0) {
+        const float centerFreq = state->peaks[axis][strongestSlot].frequency;
+        state->centerFreq[axis] = constrain(lrintf(centerFreq), DYN_NOTCH_MIN_CENTRE_HZ, dynNotchMaxCentreHz);
+        if (dynNotchCount == 1) {
+            dynNotchUpdate(state, notchFilterDyn, axis);
+        }
+    }
+    DEBUG_SET(DEBUG_FFT_FREQ, axis, state->centerFreq[axis]);
+}
+
+/*
+ * Sliding DFT analyser, every bin is updated with every downsampled sample.
+ * One axis is processed per gyro tick, so the cost per tick is small and constant.
+ */
+static FAST_CODE_NOINLINE void gyroDataAnalyseSdft(gyroAnalyseState_t *state, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX])
+{
+    state->sampleCount++;
+
+    if (state->sampleCount == state->maxSampleCount) {
+        state->sampleCount = 0;
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            state->sdftSample[axis] = state->oversampledGyroAccumulator[axis] * state->maxSampleCountRcp;
+            state->oversampledGyroAccumulator[axis] = 0;
+        }
+        DEBUG_SET(DEBUG_FFT, 2, lrintf(state->sdftSample[X]));
+
+        // maxSampleCount is at least 3, so every axis is done before the next sample arrives
+        state->updateAxis = 0;
+        state->updateTicks = XYZ_AXIS_COUNT;
+    }
+
+    if (state->updateTicks > 0) {
+        uint32_t startTime = 0;
+        if (debugMode == (DEBUG_FFT_TIME)) {
+            startTime = micros();
+        }
+
+        sdftUpdateAxis(state, notchFilterDyn, state->updateAxis);
+
+        DEBUG_SET(DEBUG_FFT_TIME, 0, state->updateAxis);
+        DEBUG_SET(DEBUG_FFT_TIME, 1, micros() - startTime);
+        state->updateAxis++;
+        --state->updateTicks;
+    }
+}
+#endif // USE_DYN_NOTCH_SDFT
 #endif // USE_GYRO_DATA_ANALYSE
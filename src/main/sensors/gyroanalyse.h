@@ -24,10 +24,19 @@
 
 #include "common/time.h"
 #include "common/filter.h"
+#include "common/sdft.h"
+
+#include "sensors/gyro.h"
 
 // max for F3 targets
 #define FFT_WINDOW_SIZE 32
 
+typedef struct dynNotchPeak_s {
+    float frequency;  // smoothed, 0 while the slot has never seen a peak
+    float power;      // windowed bin power of the latest match, 0 if the peak was not seen in the last update
+    float width;      // -3dB width in Hz of the latest match
+} dynNotchPeak_t;
+
 typedef struct gyroAnalyseState_s {
     // accumulator for oversampled data => no aliasing and less noise
     uint8_t sampleCount;
@@ -53,10 +62,23 @@ typedef struct gyroAnalyseState_s {
 
     biquadFilter_t detectedFrequencyFilter[XYZ_AXIS_COUNT];
     uint16_t centerFreq[XYZ_AXIS_COUNT];
+
+    // strongest spectral peaks per axis, each slot drives one notch of the dynamic notch cascade
+    pt1Filter_t peakFrequencyFilter[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    dynNotchPeak_t peaks[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    // next notch of the cascade to be recalculated, as axis * notch count + notch
+    uint8_t notchUpdateIdx;
+
+#ifdef USE_DYN_NOTCH_SDFT
+    // latest downsampled sample per axis, pushed into the sliding DFT one axis per tick
+    float sdftSample[XYZ_AXIS_COUNT];
+    sdft_t sdft[XYZ_AXIS_COUNT];
+    float sdftData[SDFT_BIN_COUNT];
+#endif
 } gyroAnalyseState_t;
 
 STATIC_ASSERT(FFT_WINDOW_SIZE <= (uint8_t) -1, window_size_greater_than_underlying_type);
 
 void gyroDataAnalyseStateInit(gyroAnalyseState_t *gyroAnalyse, uint32_t targetLooptime);
 void gyroDataAnalysePush(gyroAnalyseState_t *gyroAnalyse, int axis, float sample);
-void gyroDataAnalyse(gyroAnalyseState_t *gyroAnalyse, biquadFilter_t *notchFilterDyn);
+void gyroDataAnalyse(gyroAnalyseState_t *gyroAnalyse, biquadFilter_t (*notchFilterDyn)[DYN_NOTCH_COUNT_MAX]);
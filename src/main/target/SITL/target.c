@@ -329,6 +329,23 @@ uint32_t millis(void) {
     return millis64() & 0xFFFFFFFF;
 }
 
+// there is no cycle counter in SITL, so a cycle is one microsecond
+uint32_t ticks(void) {
+    return micros();
+}
+
+timeDelta_t ticks_diff_us(uint32_t begin, uint32_t end) {
+    return end - begin;
+}
+
+uint32_t clockCyclesToMicros(uint32_t clockCycles) {
+    return clockCycles;
+}
+
+uint32_t clockMicrosToCycles(uint32_t micros) {
+    return micros;
+}
+
 void microsleep(uint32_t usec) {
     struct timespec ts;
     ts.tv_sec = 0;
@@ -177,3 +177,31 @@
 #if defined(USE_RX_CX10)
 #define USE_RX_XN297
 #endif
+
+// The IMU-F DMA SPI path owns the gyro bus and its DMA streams
+#if defined(USE_DMA_SPI_DEVICE) || !defined(USE_SPI)
+#undef USE_SPI_DMA_READ
+#endif
+
+#if !defined(USE_SPI_DMA_READ) || !defined(USE_FLASH_M25P16)
+#undef USE_FLASH_SPI_DMA
+#endif
+
+// Blackbox compression codes flash logs with the Huffman encoder
+#if !defined(USE_HUFFMAN) || !defined(USE_FLASHFS)
+#undef USE_BLACKBOX_COMPRESSION
+#endif
+
+#ifndef USE_FLASHFS
+#undef USE_FLASHFS_INDEX
+#endif
+
+// Predictive RC smoothing is selected through rc_smoothing_type
+#ifndef USE_RC_SMOOTHING_FILTER
+#undef USE_RC_PREDICTION
+#endif
+
+// The IMU-F filters on board and never hands us raw samples
+#if defined(USE_GYRO_IMUF9001)
+#undef USE_GYRO_CAPTURE
+#endif
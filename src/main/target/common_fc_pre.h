@@ -36,7 +36,7 @@
 
 #ifdef STM32F1
 #define MINIMAL_CLI
-// Using RX DMA disables the use of receive callbacks
+// Using RX DMA disables the use of receive callbacks, CRSF, SBUS, Spektrum and FPort receive whole frames instead
 #define USE_UART1_RX_DMA
 #define USE_UART1_TX_DMA
 #endif
@@ -51,10 +51,15 @@
 #define USE_SRAM2
 #if defined(STM32F40_41xxx)
 #define USE_FAST_RAM
+#define USE_GYRO_CAPTURE
 #endif
 #define USE_DSHOT
+#define USE_DSHOT_TELEMETRY
 #define I2C3_OVERCLOCK true
 #define USE_GYRO_DATA_ANALYSE
+#define USE_DYN_NOTCH_SDFT
+#define USE_SPI_DMA_READ
+#define USE_FLASH_SPI_DMA
 #define USE_ADC
 #define USE_ADC_INTERNAL
 #define USE_USB_CDC_HID
@@ -70,10 +75,12 @@
 #define USE_SRAM2
 #define USE_ITCM_RAM
 #define USE_FAST_RAM
+#define USE_GYRO_CAPTURE
 #define USE_DSHOT
 #define I2C3_OVERCLOCK true
 #define I2C4_OVERCLOCK true
 #define USE_GYRO_DATA_ANALYSE
+#define USE_DYN_NOTCH_SDFT
 #define USE_OVERCLOCK
 #define USE_ADC_INTERNAL
 #define USE_USB_CDC_HID
@@ -184,6 +191,14 @@
 #define USE_GYRO_LPF2
 #define USE_ESC_SENSOR
 #define USE_ESC_SENSOR_INFO
+#define USE_RPM_FILTER
+#define USE_GYRO_FILTER_VARIANTS
+#define USE_TASK_HISTOGRAM
+#define USE_BLACKBOX_HIGH_RATE
+#define USE_BLACKBOX_COMPRESSION
+#define USE_FLASHFS_INDEX
+#define USE_RC_LATENCY
+#define USE_RC_PREDICTION
 #define USE_CRSF_CMS_TELEMETRY
 #define USE_BOARD_INFO
 #define USE_SMART_FEEDFORWARD
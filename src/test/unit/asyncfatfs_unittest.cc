@@ -0,0 +1,377 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+
+    #include "drivers/sdcard.h"
+
+    #include "io/asyncfatfs/asyncfatfs.h"
+    #include "io/asyncfatfs/fat_standard.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_SECTOR_SIZE        512
+#define TEST_PARTITION_START    1
+#define TEST_RESERVED_SECTORS   1
+#define TEST_FAT_SECTORS        33
+#define TEST_ROOT_ENTRIES       512
+#define TEST_CLUSTERS           8192
+#define TEST_TOTAL_SECTORS      (TEST_RESERVED_SECTORS + 2 * TEST_FAT_SECTORS + TEST_ROOT_ENTRIES * 32 / TEST_SECTOR_SIZE + TEST_CLUSTERS)
+#define TEST_ROOT_START         (TEST_PARTITION_START + TEST_RESERVED_SECTORS + 2 * TEST_FAT_SECTORS)
+#define TEST_DATA_START         (TEST_ROOT_START + TEST_ROOT_ENTRIES * 32 / TEST_SECTOR_SIZE)
+
+typedef enum {
+    CARD_READY,
+    CARD_WRITING_MULTIPLE_BLOCKS,
+    CARD_READING,
+    CARD_SENDING_WRITE
+} cardState_e;
+
+// sparse card image, unwritten blocks read back as zeros
+static std::map<uint32_t, std::vector<uint8_t> > cardBlocks;
+
+static struct {
+    cardState_e state;
+    bool multiWrite;
+    uint32_t multiWriteNextBlock;
+    uint32_t multiWriteBlocksRemain;
+
+    uint32_t pendingBlockIndex;
+    uint8_t *pendingBuffer;
+    sdcard_operationCompleteCallback_c pendingCallback;
+    uint32_t pendingCallbackData;
+    int busyPolls;
+} card;
+
+// polls a block write keeps the card busy for, so the log can get ahead of the card
+#define TEST_WRITE_BUSY_POLLS   4
+
+// multi-block writes that were ended before all of their pre-erased blocks were written
+static int abandonedMultiWrites;
+static int multiWriteBlocks;
+
+static uint8_t *cardBlock(uint32_t blockIndex)
+{
+    std::vector<uint8_t> &block = cardBlocks[blockIndex];
+    block.resize(TEST_SECTOR_SIZE);
+    return block.data();
+}
+
+static void endMultiWrite(void)
+{
+    if (card.multiWriteBlocksRemain > 0) {
+        abandonedMultiWrites++;
+    }
+    card.multiWriteBlocksRemain = 0;
+    card.state = CARD_READY;
+}
+
+static void formatCard(void)
+{
+    cardBlocks.clear();
+    memset(&card, 0, sizeof(card));
+    abandonedMultiWrites = 0;
+    multiWriteBlocks = 0;
+
+    uint8_t *mbr = cardBlock(0);
+    mbrPartitionEntry_t *partition = (mbrPartitionEntry_t *) (mbr + 446);
+    partition->type = MBR_PARTITION_TYPE_FAT16;
+    partition->lbaBegin = TEST_PARTITION_START;
+    partition->numSectors = TEST_TOTAL_SECTORS;
+    mbr[510] = 0x55;
+    mbr[511] = 0xAA;
+
+    uint8_t *volumeSector = cardBlock(TEST_PARTITION_START);
+    fatVolumeID_t *volume = (fatVolumeID_t *) volumeSector;
+    volume->bytesPerSector = TEST_SECTOR_SIZE;
+    volume->sectorsPerCluster = 1;
+    volume->reservedSectorCount = TEST_RESERVED_SECTORS;
+    volume->numFATs = 2;
+    volume->rootEntryCount = TEST_ROOT_ENTRIES;
+    volume->totalSectors16 = TEST_TOTAL_SECTORS;
+    volume->FATSize16 = TEST_FAT_SECTORS;
+    volumeSector[510] = FAT_VOLUME_ID_SIGNATURE_1;
+    volumeSector[511] = FAT_VOLUME_ID_SIGNATURE_2;
+
+    // clusters 0 and 1 are reserved in both FATs
+    for (int fat = 0; fat < 2; fat++) {
+        uint16_t *entries = (uint16_t *) cardBlock(TEST_PARTITION_START + TEST_RESERVED_SECTORS + fat * TEST_FAT_SECTORS);
+        entries[0] = 0xFFF8;
+        entries[1] = 0xFFFF;
+    }
+}
+
+static void pollUntil(bool (*done)(void))
+{
+    for (int i = 0; i < 1000000 && !done(); i++) {
+        afatfs_poll();
+    }
+}
+
+static bool filesystemReady(void)
+{
+    return afatfs_getFilesystemState() == AFATFS_FILESYSTEM_STATE_READY;
+}
+
+static afatfsFilePtr_t logFile;
+static bool logFileClosed;
+
+static void logFileCreated(afatfsFilePtr_t file)
+{
+    logFile = file;
+}
+
+static void logFileClose(void)
+{
+    logFileClosed = true;
+}
+
+static afatfsFilePtr_t notesFile;
+
+static void notesFileCreated(afatfsFilePtr_t file)
+{
+    notesFile = file;
+}
+
+static bool logFileOpen(void)
+{
+    return logFile != NULL;
+}
+
+static bool logFileDone(void)
+{
+    return logFileClosed;
+}
+
+static bool cacheFlushed(void)
+{
+    return afatfs_flush();
+}
+
+static const fatDirectoryEntry_t *findRootEntry(const char *filename)
+{
+    for (uint32_t sector = TEST_ROOT_START; sector < TEST_DATA_START; sector++) {
+        const fatDirectoryEntry_t *entries = (const fatDirectoryEntry_t *) cardBlock(sector);
+
+        for (unsigned i = 0; i < TEST_SECTOR_SIZE / sizeof(fatDirectoryEntry_t); i++) {
+            if (memcmp(entries[i].filename, filename, FAT_FILENAME_LENGTH) == 0) {
+                return &entries[i];
+            }
+        }
+    }
+    return NULL;
+}
+
+static uint8_t logByte(uint32_t offset)
+{
+    return (offset * 7 + offset / TEST_SECTOR_SIZE) & 0xFF;
+}
+
+TEST(AsyncFatFsTest, StreamedLogKeepsMultiBlockWriteOpen)
+{
+    formatCard();
+
+    afatfs_init();
+    pollUntil(filesystemReady);
+    ASSERT_EQ(AFATFS_FILESYSTEM_STATE_READY, afatfs_getFilesystemState());
+
+    logFile = NULL;
+    notesFile = NULL;
+    logFileClosed = false;
+    afatfs_fopen("LOG00001.BFL", "as", logFileCreated);
+    pollUntil(logFileOpen);
+    ASSERT_TRUE(logFile != NULL);
+
+    // logs arrive a little at a time, as from the blackbox
+    const uint32_t logSize = 512 * 1024;
+    uint8_t chunk[100];
+    uint32_t written = 0;
+
+    abandonedMultiWrites = 0;
+    multiWriteBlocks = 0;
+
+    for (int i = 0; i < 1000000 && written < logSize; i++) {
+        const uint32_t length = MIN((uint32_t)sizeof(chunk), logSize - written);
+        for (uint32_t j = 0; j < length; j++) {
+            chunk[j] = logByte(written + j);
+        }
+        written += afatfs_fwrite(logFile, chunk, length);
+        afatfs_poll();
+
+        if (i == 300) {
+            // dirties the root directory sector partway through the log's pre-erased supercluster
+            afatfs_fopen("NOTES.TXT", "w", notesFileCreated);
+        }
+    }
+    ASSERT_EQ(logSize, written);
+    EXPECT_TRUE(notesFile != NULL);
+
+    // every data sector continues the card's multi-block write, the directory sector waits behind them
+    EXPECT_EQ(0, abandonedMultiWrites);
+    EXPECT_EQ((int)(logSize / TEST_SECTOR_SIZE), multiWriteBlocks);
+
+    afatfs_fclose(logFile, logFileClose);
+    pollUntil(logFileDone);
+    ASSERT_TRUE(logFileClosed);
+    pollUntil(cacheFlushed);
+
+    const fatDirectoryEntry_t *entry = findRootEntry("LOG00001BFL");
+    ASSERT_TRUE(entry != NULL);
+    EXPECT_EQ(logSize, entry->fileSize);
+
+    // the log was carved from the freefile so its clusters are contiguous
+    const uint32_t firstSector = TEST_DATA_START + entry->firstClusterLow - FAT_SMALLEST_LEGAL_CLUSTER_NUMBER;
+    for (uint32_t offset = 0; offset < logSize; offset++) {
+        if (cardBlock(firstSector + offset / TEST_SECTOR_SIZE)[offset % TEST_SECTOR_SIZE] != logByte(offset)) {
+            FAIL() << "log byte " << offset << " differs";
+        }
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+bool sdcard_poll(void)
+{
+    sdcard_operationCompleteCallback_c callback = card.pendingCallback;
+
+    if (card.busyPolls > 0) {
+        card.busyPolls--;
+        return false;
+    }
+
+    switch (card.state) {
+        case CARD_READING:
+            card.state = CARD_READY;
+            card.pendingCallback = NULL;
+            memcpy(card.pendingBuffer, cardBlock(card.pendingBlockIndex), TEST_SECTOR_SIZE);
+            callback(SDCARD_BLOCK_OPERATION_READ, card.pendingBlockIndex, card.pendingBuffer, card.pendingCallbackData);
+        break;
+        case CARD_SENDING_WRITE:
+            card.state = CARD_READY;
+            if (card.multiWrite) {
+                card.multiWriteNextBlock++;
+                card.multiWriteBlocksRemain--;
+                if (card.multiWriteBlocksRemain > 0) {
+                    card.state = CARD_WRITING_MULTIPLE_BLOCKS;
+                }
+            }
+            card.pendingCallback = NULL;
+            if (callback) {
+                callback(SDCARD_BLOCK_OPERATION_WRITE, card.pendingBlockIndex, card.pendingBuffer, card.pendingCallbackData);
+            }
+        break;
+        default:
+        break;
+    }
+
+    return true;
+}
+
+bool sdcard_readBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData)
+{
+    if (card.state == CARD_WRITING_MULTIPLE_BLOCKS) {
+        endMultiWrite();
+    }
+    if (card.state != CARD_READY) {
+        return false;
+    }
+
+    card.state = CARD_READING;
+    card.pendingBlockIndex = blockIndex;
+    card.pendingBuffer = buffer;
+    card.pendingCallback = callback;
+    card.pendingCallbackData = callbackData;
+
+    return true;
+}
+
+sdcardOperationStatus_e sdcard_beginWriteBlocks(uint32_t blockIndex, uint32_t blockCount)
+{
+    if (card.state == CARD_WRITING_MULTIPLE_BLOCKS) {
+        if (blockIndex == card.multiWriteNextBlock) {
+            return SDCARD_OPERATION_SUCCESS;
+        }
+        endMultiWrite();
+    }
+    if (card.state != CARD_READY) {
+        return SDCARD_OPERATION_BUSY;
+    }
+
+    card.state = CARD_WRITING_MULTIPLE_BLOCKS;
+    card.multiWriteNextBlock = blockIndex;
+    card.multiWriteBlocksRemain = blockCount;
+
+    return SDCARD_OPERATION_SUCCESS;
+}
+
+sdcardOperationStatus_e sdcard_writeBlock(uint32_t blockIndex, uint8_t *buffer, sdcard_operationCompleteCallback_c callback, uint32_t callbackData)
+{
+    if (card.state == CARD_WRITING_MULTIPLE_BLOCKS && blockIndex != card.multiWriteNextBlock) {
+        endMultiWrite();
+    }
+    if (card.state != CARD_READY && card.state != CARD_WRITING_MULTIPLE_BLOCKS) {
+        return SDCARD_OPERATION_BUSY;
+    }
+
+    card.multiWrite = card.state == CARD_WRITING_MULTIPLE_BLOCKS;
+    if (card.multiWrite) {
+        multiWriteBlocks++;
+    }
+
+    memcpy(cardBlock(blockIndex), buffer, TEST_SECTOR_SIZE);
+
+    card.state = CARD_SENDING_WRITE;
+    card.busyPolls = TEST_WRITE_BUSY_POLLS;
+    card.pendingBlockIndex = blockIndex;
+    card.pendingBuffer = buffer;
+    card.pendingCallback = callback;
+    card.pendingCallbackData = callbackData;
+
+    return SDCARD_OPERATION_IN_PROGRESS;
+}
+
+bool sdcard_getMultiWriteNextBlock(uint32_t *blockIndex)
+{
+    if (card.state != CARD_WRITING_MULTIPLE_BLOCKS) {
+        return false;
+    }
+    *blockIndex = card.multiWriteNextBlock;
+    return true;
+}
+
+void sdcard_setProfilerCallback(sdcard_profilerCallback_c callback)
+{
+    UNUSED(callback);
+}
+
+}
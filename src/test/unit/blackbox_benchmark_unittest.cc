@@ -0,0 +1,356 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a deterministic flight through the blackbox frame writers and each of the field encoders. The encoded
+ * output is checked against golden sizes and hashes so that any change to the log format is deliberate, and the
+ * cost per frame is reported to catch CPU regressions. When a format change is intended, run the test and copy the
+ * new values from the failure messages.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_encoding.h"
+    #include "blackbox/blackbox_io.h"
+    #include "build/debug.h"
+    #include "common/utils.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+    #include "pg/rx.h"
+
+    #include "drivers/serial.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+
+    #include "fc/rc_controls.h"
+    #include "fc/rc_modes.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+
+    void blackboxStart(void);
+    void blackboxLogIteration(timeUs_t currentTimeUs);
+    void blackboxAdvanceIterationTimers(void);
+    bool blackboxShouldLogIFrame(void);
+    bool blackboxShouldLogPFrame(void);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FLIGHT_ITERATIONS 16000
+
+static std::vector<uint8_t> logOutput;
+static serialPortConfig_t blackboxPortConfig;
+static pidProfile_t pidProfile;
+
+static uint32_t corpusSeed;
+
+// Integer only, so the corpus and the golden values are the same on every host
+static int32_t corpusNoise(int32_t range)
+{
+    corpusSeed = corpusSeed * 1103515245 + 12345;
+    return (int32_t)((corpusSeed >> 16) % (2 * range + 1)) - range;
+}
+
+static int32_t triangleWave(int iteration, int period, int32_t amplitude)
+{
+    const int phase = iteration % period;
+    const int half = period / 2;
+    return (phase < half ? phase : period - phase) * 2 * amplitude / half - amplitude;
+}
+
+// Load the flight state the blackbox samples on each PID loop
+static void loadFlightState(int i)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const int32_t rate = triangleWave(i, 400 + axis * 170, 300 + axis * 100);
+        gyro.gyroADCf[axis] = rate + corpusNoise(6);
+        acc.accADC[axis] = (axis == Z ? 2048 : 0) + triangleWave(i, 900, 200) + corpusNoise(30);
+        mag.magADC[axis] = 300 - axis * 200 + corpusNoise(2);
+        pidData[axis].P = -rate / 3 + corpusNoise(4);
+        pidData[axis].I = triangleWave(i, 5000, 40);
+        pidData[axis].D = corpusNoise(25);
+        pidData[axis].F = triangleWave(i + 50, 400 + axis * 170, 60);
+        rcCommand[axis] = triangleWave(i + 100, 2000 + axis * 300, 400);
+    }
+    rcCommand[THROTTLE] = 1400 + triangleWave(i, 3000, 300);
+
+    for (int m = 0; m < 4; m++) {
+        motor[m] = 1400 + triangleWave(i + m * 30, 3000, 300) + corpusNoise(20);
+    }
+    for (int d = 0; d < DEBUG16_VALUE_COUNT; d++) {
+        debug[d] = d == 0 ? corpusNoise(1000) : 0;
+    }
+    baro.BaroAlt = 1000 + i / 100;
+}
+
+static uint32_t fnv1a(const uint8_t *data, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+TEST(BlackboxBenchmarkTest, FlightFrames)
+{
+    // 8kHz PID loop, 2kHz logging
+    targetPidLooptime = 125;
+    blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+    blackboxConfigMutable()->p_ratio = 64;
+    blackboxConfigMutable()->record_acc = 1;
+    debugMode = DEBUG_GYRO_SCALED;
+    pidProfile.pid[PID_ROLL].D = 25;
+    pidProfile.pid[PID_PITCH].D = 27;
+    blackboxPortConfig.identifier = SERIAL_PORT_USART1;
+    blackboxPortConfig.blackbox_baudrateIndex = BAUD_2000000;
+    blackboxInit();
+    blackboxStart();
+
+    corpusSeed = 1;
+    logOutput.clear();
+    logOutput.reserve(1 << 20);
+
+    int frames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FLIGHT_ITERATIONS; i++) {
+        loadFlightState(i);
+        if (blackboxShouldLogIFrame() || blackboxShouldLogPFrame()) {
+            frames++;
+        }
+        blackboxLogIteration(i * targetPidLooptime);
+        blackboxAdvanceIterationTimers();
+    }
+    const double ns = elapsedNs(start);
+
+    printf("blackbox frames: %d frames, %.1f bytes/frame, %.0f ns/frame\n",
+        frames, (double)logOutput.size() / frames, ns / frames);
+
+    EXPECT_EQ(4000, frames);
+    EXPECT_EQ(131068u, logOutput.size());
+    EXPECT_EQ(0x01a05ceau, fnv1a(logOutput.data(), logOutput.size()));
+}
+
+typedef void (*encoderFn)(int iteration);
+
+typedef struct encoderCase_s {
+    const char *name;
+    encoderFn encode;
+    size_t bytes;
+    uint32_t hash;
+} encoderCase_t;
+
+static int32_t corpusValue(int i, int32_t amplitude)
+{
+    return triangleWave(i, 640, amplitude) + corpusNoise(amplitude / 16 + 1);
+}
+
+static void encodeUnsignedVB(int i) { blackboxWriteUnsignedVB(corpusValue(i, 1 << 20) + (1 << 20)); }
+static void encodeSignedVB(int i) { blackboxWriteSignedVB(corpusValue(i, 1 << 14)); }
+static void encodeS16(int i) { blackboxWriteS16(corpusValue(i, INT16_MAX)); }
+static void encodeU32(int i) { blackboxWriteU32(corpusValue(i, INT32_MAX / 2)); }
+
+static void encodeSignedVBArray(int i)
+{
+    int32_t values[4];
+    for (int j = 0; j < 4; j++) {
+        values[j] = corpusValue(i + j * 7, 3000);
+    }
+    blackboxWriteSignedVBArray(values, 4);
+}
+
+static void encodeSigned16VBArray(int i)
+{
+    int16_t values[4];
+    for (int j = 0; j < 4; j++) {
+        values[j] = corpusValue(i + j * 7, 3000);
+    }
+    blackboxWriteSigned16VBArray(values, 4);
+}
+
+static void encodeTag2_3S32(int i)
+{
+    int32_t values[3];
+    for (int j = 0; j < 3; j++) {
+        values[j] = corpusValue(i + j * 11, 1 << (i % 12));
+    }
+    blackboxWriteTag2_3S32(values);
+}
+
+static void encodeTag2_3SVariable(int i)
+{
+    int32_t values[3];
+    for (int j = 0; j < 3; j++) {
+        values[j] = corpusValue(i + j * 11, 1 << (i % 20));
+    }
+    blackboxWriteTag2_3SVariable(values);
+}
+
+static void encodeTag8_4S16(int i)
+{
+    int32_t values[4];
+    for (int j = 0; j < 4; j++) {
+        values[j] = corpusValue(i + j * 5, 1 << (i % 15));
+    }
+    blackboxWriteTag8_4S16(values);
+}
+
+static void encodeTag8_8SVB(int i)
+{
+    int32_t values[8];
+    for (int j = 0; j < 8; j++) {
+        values[j] = (i + j) % 3 ? 0 : corpusValue(i + j, 1 << (i % 16));
+    }
+    blackboxWriteTag8_8SVB(values, 1 + i % 8);
+}
+
+TEST(BlackboxBenchmarkTest, Encoders)
+{
+    blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+
+    const encoderCase_t cases[] = {
+        { "UnsignedVB",         encodeUnsignedVB,        48380, 0x90fc3b3fu },
+        { "SignedVB",           encodeSignedVB,          39961, 0xfe0d05ccu },
+        { "S16",                encodeS16,               32000, 0x090b33d4u },
+        { "U32",                encodeU32,               64000, 0x695dc331u },
+        { "SignedVBArray",      encodeSignedVBArray,    126619, 0x839dbcadu },
+        { "Signed16VBArray",    encodeSigned16VBArray,  126619, 0x839dbcadu },
+        { "Tag2_3S32",          encodeTag2_3S32,         58644, 0xc1e80498u },
+        { "Tag2_3SVariable",    encodeTag2_3SVariable,   85119, 0xd5aeb6fau },
+        { "Tag8_4S16",          encodeTag8_4S16,         94408, 0x41621354u },
+        { "Tag8_8SVB",          encodeTag8_8SVB,         55056, 0x103416e3u },
+    };
+
+    for (const encoderCase_t &test : cases) {
+        corpusSeed = 1;
+        logOutput.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < FLIGHT_ITERATIONS; i++) {
+            test.encode(i);
+            if (i % 16 == 15) {
+                blackboxDeviceFlush();
+            }
+        }
+        blackboxDeviceFlush();
+        const double ns = elapsedNs(start);
+
+        printf("blackboxWrite%s: %.2f bytes/call, %.1f ns/call\n",
+            test.name, (double)logOutput.size() / FLIGHT_ITERATIONS, ns / FLIGHT_ITERATIONS);
+
+        EXPECT_EQ(test.bytes, logOutput.size()) << test.name;
+        EXPECT_EQ(test.hash, fnv1a(logOutput.data(), logOutput.size())) << test.name;
+    }
+}
+
+// STUBS
+extern "C" {
+
+PG_REGISTER(flight3DConfig_t, flight3DConfig, PG_MOTOR_3D_CONFIG, 0);
+PG_REGISTER(mixerConfig_t, mixerConfig, PG_MIXER_CONFIG, 0);
+PG_REGISTER(motorConfig_t, motorConfig, PG_MOTOR_CONFIG, 0);
+PG_REGISTER(batteryConfig_t, batteryConfig, PG_BATTERY_CONFIG, 0);
+PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
+PG_REGISTER_ARRAY(modeActivationCondition_t, MAX_MODE_ACTIVATION_CONDITION_COUNT, modeActivationConditions, PG_MODE_ACTIVATION_PROFILE, 0);
+
+uint8_t armingFlags;
+uint8_t stateFlags;
+const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
+        400000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2470000}; // see baudRate_e
+uint8_t debugMode;
+gpsSolutionData_t gpsSol;
+int32_t GPS_home[2];
+
+gyro_t gyro;
+acc_t acc;
+mag_t mag;
+baro_t baro;
+pidAxisData_t pidData[3];
+float rcCommand[4];
+int16_t debug[DEBUG16_VALUE_COUNT];
+float motor[MAX_SUPPORTED_MOTORS];
+
+float motorOutputHigh, motorOutputLow;
+float motor_disarmed[MAX_SUPPORTED_MOTORS];
+pidProfile_t *currentPidProfile = &pidProfile;
+uint32_t targetPidLooptime;
+
+boxBitmask_t rcModeActivationMask;
+
+static serialPort_t blackboxSerialPort;
+
+void mspSerialAllocatePorts(void) {}
+uint32_t getArmingBeepTimeMicros(void) {return 0;}
+uint16_t getBatteryVoltageLatest(void) {return 1680;}
+int32_t getAmperageLatest(void) {return 1200;}
+uint16_t getRssi(void) {return 1023;}
+uint8_t getMotorCount(void) {return 4;}
+bool areMotorsRunning(void) { return true; }
+bool IS_RC_MODE_ACTIVE(boxId_e) {return false;}
+bool isModeActivationConditionPresent(boxId_e) {return false;}
+uint32_t millis(void) {return 0;}
+bool sensors(uint32_t) {return true;}
+void serialWrite(serialPort_t *, uint8_t ch) { logOutput.push_back(ch); }
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+{
+    logOutput.insert(logOutput.end(), data, data + count);
+}
+uint32_t serialTxBytesFree(const serialPort_t *) {return UINT16_MAX;}
+bool isSerialTransmitBufferEmpty(const serialPort_t *) {return true;}
+bool feature(uint32_t) {return false;}
+void mspSerialReleasePortIfAllocated(serialPort_t *) {}
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return &blackboxPortConfig;}
+serialPort_t *findSharedSerialPort(uint16_t , serialPortFunction_e ) {return NULL;}
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return &blackboxSerialPort;}
+void closeSerialPort(serialPort_t *) {}
+portSharing_e determinePortSharing(const serialPortConfig_t *, serialPortFunction_e ) {return PORTSHARING_NOT_SHARED;}
+failsafePhase_e failsafePhase(void) {return FAILSAFE_IDLE;}
+bool rxAreFlightChannelsValid(void) {return true;}
+bool rxIsReceivingSignal(void) {return true;}
+bool isRssiConfigured(void) {return true;}
+
+}
@@ -0,0 +1,189 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "blackbox/blackbox_compact.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_MOTOR_COUNT 4
+#define TEST_FIELD_COUNT (BLACKBOX_COMPACT_FIELD_MOTOR + TEST_MOTOR_COUNT)
+
+static blackboxCompactState_t encoder;
+static blackboxCompactState_t decoder;
+
+static void resetStates(void)
+{
+    blackboxCompactInit(&encoder, TEST_MOTOR_COUNT);
+    blackboxCompactInit(&decoder, TEST_MOTOR_COUNT);
+}
+
+static void expectRoundTrip(const blackboxCompactFrame_t *frame, bool keyFrame)
+{
+    uint8_t buf[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    blackboxCompactFrame_t decoded;
+
+    const int length = blackboxCompactEncode(&encoder, frame, keyFrame, buf);
+    EXPECT_GT(length, 0);
+    EXPECT_LE(length, BLACKBOX_COMPACT_MAX_FRAME_SIZE);
+
+    EXPECT_EQ(length, blackboxCompactDecode(&decoder, buf, length, &decoded));
+    EXPECT_EQ(frame->time, decoded.time);
+    for (int i = 0; i < TEST_FIELD_COUNT; i++) {
+        EXPECT_EQ(frame->fields[i], decoded.fields[i]);
+    }
+}
+
+TEST(BlackboxCompactTest, KeyAndDeltaFramesRoundTrip)
+{
+    resetStates();
+
+    blackboxCompactFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.time = 1000000;
+    for (int i = 0; i < TEST_FIELD_COUNT; i++) {
+        frame.fields[i] = i * 100 - 500;
+    }
+    expectRoundTrip(&frame, true);
+
+    frame.time += 125;
+    expectRoundTrip(&frame, false);
+    frame.time += 125;
+    frame.fields[BLACKBOX_COMPACT_FIELD_GYRO] += 1;
+    frame.fields[BLACKBOX_COMPACT_FIELD_MOTOR + 3] -= 2;
+    expectRoundTrip(&frame, false);
+
+    // an unchanged frame at a steady loop time only stores the widths
+    uint8_t buf[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    frame.time += 125;
+    blackboxCompactState_t copy = encoder;
+    const int length = blackboxCompactEncode(&copy, &frame, false, buf);
+    EXPECT_EQ(BLACKBOX_COMPACT_DELTA_FRAME, buf[0]);
+    EXPECT_EQ(5, length); // marker, then 6 bits of time width and four 5 bit group widths
+    expectRoundTrip(&frame, false);
+}
+
+TEST(BlackboxCompactTest, ExtremeValuesAndJitterRoundTrip)
+{
+    resetStates();
+    srand(42);
+
+    blackboxCompactFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.time = 0xfffffff0; // wraps during the test
+
+    for (int n = 0; n < 2000; n++) {
+        frame.time += 100 + rand() % 50;
+        for (int i = 0; i < TEST_FIELD_COUNT; i++) {
+            switch (rand() % 4) {
+            case 0:
+                frame.fields[i] = INT16_MIN;
+                break;
+            case 1:
+                frame.fields[i] = INT16_MAX;
+                break;
+            case 2:
+                frame.fields[i] += rand() % 7 - 3;
+                break;
+            default:
+                frame.fields[i] = rand() - RAND_MAX / 2;
+                break;
+            }
+        }
+        expectRoundTrip(&frame, n % 64 == 0);
+    }
+}
+
+TEST(BlackboxCompactTest, UnusedMotorsAreNotEncoded)
+{
+    resetStates();
+
+    blackboxCompactFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    for (int i = TEST_FIELD_COUNT; i < BLACKBOX_COMPACT_FIELD_COUNT; i++) {
+        frame.fields[i] = 1234;
+    }
+
+    uint8_t buf[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    blackboxCompactFrame_t decoded;
+    const int length = blackboxCompactEncode(&encoder, &frame, true, buf);
+    EXPECT_EQ(5, length);
+    EXPECT_EQ(length, blackboxCompactDecode(&decoder, buf, length, &decoded));
+    for (int i = 0; i < BLACKBOX_COMPACT_FIELD_COUNT; i++) {
+        EXPECT_EQ(0, decoded.fields[i]);
+    }
+}
+
+TEST(BlackboxCompactTest, FirstFrameIsAlwaysKeyFrame)
+{
+    resetStates();
+
+    blackboxCompactFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.time = 500;
+
+    uint8_t buf[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    blackboxCompactEncode(&encoder, &frame, false, buf);
+    EXPECT_EQ(BLACKBOX_COMPACT_KEY_FRAME, buf[0]);
+}
+
+TEST(BlackboxCompactTest, DecoderRejectsBadInput)
+{
+    resetStates();
+
+    blackboxCompactFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.time = 1000;
+    frame.fields[0] = 300;
+
+    uint8_t key[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    uint8_t delta[BLACKBOX_COMPACT_MAX_FRAME_SIZE];
+    const int keyLength = blackboxCompactEncode(&encoder, &frame, true, key);
+    frame.time += 125;
+    frame.fields[1] = -300;
+    const int deltaLength = blackboxCompactEncode(&encoder, &frame, false, delta);
+
+    blackboxCompactFrame_t decoded;
+
+    // a delta frame needs a key frame to apply to
+    EXPECT_EQ(-1, blackboxCompactDecode(&decoder, delta, deltaLength, &decoded));
+
+    // truncated frames and unknown markers are rejected without touching the state
+    EXPECT_EQ(-1, blackboxCompactDecode(&decoder, key, keyLength - 1, &decoded));
+    EXPECT_EQ(-1, blackboxCompactDecode(&decoder, key, 0, &decoded));
+    key[0] = 'I';
+    EXPECT_EQ(-1, blackboxCompactDecode(&decoder, key, keyLength, &decoded));
+    key[0] = BLACKBOX_COMPACT_KEY_FRAME;
+
+    EXPECT_EQ(keyLength, blackboxCompactDecode(&decoder, key, keyLength, &decoded));
+    EXPECT_EQ(-1, blackboxCompactDecode(&decoder, delta, deltaLength - 1, &decoded));
+    EXPECT_EQ(deltaLength, blackboxCompactDecode(&decoder, delta, deltaLength, &decoded));
+    EXPECT_EQ(frame.time, decoded.time);
+    EXPECT_EQ(300, decoded.fields[0]);
+    EXPECT_EQ(-300, decoded.fields[1]);
+}
@@ -15,6 +15,7 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 extern "C" {
@@ -22,6 +23,7 @@ extern "C" {
 
     #include "blackbox/blackbox.h"
     #include "blackbox/blackbox_encoding.h"
+    #include "common/huffman.h"
     #include "common/utils.h"
 
     #include "pg/pg.h"
@@ -240,6 +242,116 @@ TEST(BlackboxTest, TestWriteTag2_3SVariable_BITS887)
     EXPECT_EQ(0, buf[3]); // ensure next byte has not been written
     buf += 3;
 }
+/*
+ * Host side decompressor for compressed blackbox logs, appends the bytes of every block in log to out.
+ * Returns the decompressed length, or -1 if the log is malformed.
+ */
+static int decompressLog(uint8_t *out, int outLen, const uint8_t *log, int logLen)
+{
+    int outCount = 0;
+    int pos = 0;
+    while (pos < logLen) {
+        if (logLen - pos < BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE || log[pos] != BLACKBOX_COMPRESSED_BLOCK_MARKER) {
+            return -1;
+        }
+        const int length = log[pos + 1] | (log[pos + 2] << 8);
+        const int compressedLength = log[pos + 3] | (log[pos + 4] << 8);
+        pos += BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE;
+        if (outCount + length > outLen) {
+            return -1;
+        }
+
+        if (compressedLength == 0) {
+            if (pos + length > logLen) {
+                return -1;
+            }
+            memcpy(out + outCount, log + pos, length);
+            outCount += length;
+            pos += length;
+            continue;
+        }
+
+        if (pos + compressedLength > logLen) {
+            return -1;
+        }
+        // match the codes bit by bit against the encoder's table, codes are left aligned in 16 bits
+        uint16_t code = 0;
+        int codeLen = 0;
+        int decoded = 0;
+        for (int bit = 0; bit < compressedLength * 8 && decoded < length; bit++) {
+            if (log[pos + bit / 8] & (0x80 >> (bit % 8))) {
+                code |= 0x8000 >> codeLen;
+            }
+            ++codeLen;
+            for (int ii = 0; ii < HUFFMAN_TABLE_SIZE - 1; ii++) {
+                if (huffmanTable[ii].codeLen == codeLen && huffmanTable[ii].code == code) {
+                    out[outCount + decoded++] = ii;
+                    code = 0;
+                    codeLen = 0;
+                    break;
+                }
+            }
+            if (codeLen > 16) {
+                return -1;
+            }
+        }
+        if (decoded != length) {
+            return -1;
+        }
+        outCount += length;
+        pos += compressedLength;
+    }
+    return outCount;
+}
+
+TEST(BlackboxEncodingTest, TestCompressedLogRoundTrip)
+{
+    static uint8_t original[4 * SERIAL_BUFFER_SIZE];
+    static uint8_t log[4 * BLACKBOX_COMPRESSED_BLOCK_MAX_SIZE(SERIAL_BUFFER_SIZE)];
+    static uint8_t decompressed[sizeof(original)];
+    int originalLength = 0;
+    int logLength = 0;
+
+    // frame data, mostly zero or small deltas as in a steady flight
+    srand(1);
+    for (int block = 0; block < 3; block++) {
+        serialTestResetBuffers();
+        while (serialWritePos < SERIAL_BUFFER_SIZE - 16) {
+            serialWrite(blackboxPort, 'P');
+            int32_t values[4];
+            for (int i = 0; i < 4; i++) {
+                values[i] = rand() % 4 ? 0 : rand() % 3 - 1;
+            }
+            blackboxWriteTag8_4S16(values);
+            blackboxWriteSignedVB(rand() % 9 - 4);
+        }
+        memcpy(original + originalLength, serialWriteBuffer, serialWritePos);
+        const int blockLength = blackboxCompressBlock(log + logLength, serialWriteBuffer, serialWritePos);
+        EXPECT_NE(0, log[logLength + 3] | log[logLength + 4]);
+        EXPECT_LT(blockLength, serialWritePos * 3 / 4);
+        originalLength += serialWritePos;
+        logLength += blockLength;
+    }
+
+    // random bytes don't compress and are stored as they are
+    uint8_t noise[100];
+    for (unsigned i = 0; i < sizeof(noise); i++) {
+        noise[i] = rand();
+    }
+    memcpy(original + originalLength, noise, sizeof(noise));
+    const int blockLength = blackboxCompressBlock(log + logLength, noise, sizeof(noise));
+    EXPECT_EQ(BLACKBOX_COMPRESSED_BLOCK_HEADER_SIZE + (int)sizeof(noise), blockLength);
+    EXPECT_EQ(0, log[logLength + 3] | log[logLength + 4]);
+    originalLength += sizeof(noise);
+    logLength += blockLength;
+
+    EXPECT_EQ(originalLength, decompressLog(decompressed, sizeof(decompressed), log, logLength));
+    EXPECT_EQ(0, memcmp(original, decompressed, originalLength));
+
+    // a truncated log is detected
+    EXPECT_EQ(-1, decompressLog(decompressed, sizeof(decompressed), log, logLength - 1));
+}
+
 // STUBS
 extern "C" {
 PG_REGISTER(blackboxConfig_t, blackboxConfig, PG_BLACKBOX_CONFIG, 0);
@@ -21,6 +21,8 @@ extern "C" {
     #include "platform.h"
 
     #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_io.h"
+    #include "build/debug.h"
     #include "common/utils.h"
 
     #include "pg/pg.h"
@@ -43,18 +45,33 @@ extern "C" {
 
     #include "rx/rx.h"
 
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
     #include "sensors/battery.h"
+    #include "sensors/compass.h"
     #include "sensors/gyro.h"
 
     extern int16_t blackboxIInterval;
     extern int16_t blackboxPInterval;
+    extern struct pidProfile_s *currentPidProfile;
+    void blackboxStart(void);
 }
 
+#include <string>
+
 #include "unittest_macros.h"
 #include "gtest/gtest.h"
 
 gyroDev_t gyroDev;
 
+static int serialWriteBufCalls;
+static int serialWriteBufBytes;
+static uint32_t serialTxFree;
+static std::string serialOutput;
+static uint32_t millisValue;
+static serialPortConfig_t blackboxPortConfig;
+static serialPort_t blackboxSerialPort;
+
 TEST(BlackboxTest, TestInitIntervals)
 {
     blackboxConfigMutable()->p_ratio = 32;
@@ -352,6 +369,142 @@ TEST(BlackboxTest, Test_CalculateRates)
 
 }
 
+TEST(BlackboxTest, Test_StagedWritesCommittedInBulk)
+{
+    blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+    blackboxDeviceFlush(); // drop anything staged by the earlier tests
+    serialTxFree = 1024;
+    serialWriteBufCalls = 0;
+    serialWriteBufBytes = 0;
+
+    // a frame reaches the device in a single write when the iteration is flushed
+    for (int i = 0; i < 40; i++) {
+        blackboxWrite(i);
+    }
+    EXPECT_EQ(6, blackboxWriteString("H test"));
+    EXPECT_EQ(0, serialWriteBufCalls);
+
+    blackboxDeviceFlush();
+    EXPECT_EQ(1, serialWriteBufCalls);
+    EXPECT_EQ(46, serialWriteBufBytes);
+
+    // nothing staged, nothing written
+    blackboxDeviceFlush();
+    EXPECT_EQ(1, serialWriteBufCalls);
+
+    // a full staging buffer is committed without waiting for the flush
+    for (int i = 0; i < BLACKBOX_STAGING_BUFFER_SIZE + 10; i++) {
+        blackboxWrite(i);
+    }
+    EXPECT_EQ(2, serialWriteBufCalls);
+    EXPECT_EQ(46 + BLACKBOX_STAGING_BUFFER_SIZE, serialWriteBufBytes);
+
+    // staged bytes that don't fit the port are dropped whole instead of waiting for it
+    blackboxDroppedBytes = 0;
+    serialTxFree = 4;
+    blackboxDeviceFlush();
+    EXPECT_EQ(2, serialWriteBufCalls);
+    EXPECT_EQ(46 + BLACKBOX_STAGING_BUFFER_SIZE, serialWriteBufBytes);
+    EXPECT_EQ(10, blackboxDroppedBytes);
+
+    // the next block that fits is written in full
+    for (int i = 0; i < 4; i++) {
+        blackboxWrite(i);
+    }
+    blackboxDeviceFlush();
+    EXPECT_EQ(3, serialWriteBufCalls);
+    EXPECT_EQ(46 + BLACKBOX_STAGING_BUFFER_SIZE + 4, serialWriteBufBytes);
+    EXPECT_EQ(10, blackboxDroppedBytes);
+
+    serialTxFree = 0;
+}
+
+
+static pidProfile_t testPidProfile;
+
+// a log's main field definitions, first I frame and first P frame
+typedef struct {
+    std::string fieldNames;
+    size_t iFrameLength;
+    size_t pFrameLength;
+} testLog_t;
+
+static testLog_t recordLog(uint32_t fieldsDisabledMask)
+{
+    testLog_t log;
+
+    blackboxConfigMutable()->device = BLACKBOX_DEVICE_SERIAL;
+    blackboxConfigMutable()->p_ratio = 32;
+    blackboxConfigMutable()->fields_disabled_mask = fieldsDisabledMask;
+    blackboxPortConfig.blackbox_baudrateIndex = BAUD_2000000;
+    currentPidProfile = &testPidProfile;
+    serialTxFree = 1024;
+    blackboxDeviceFlush();
+    serialOutput.clear();
+
+    blackboxStart();
+    blackboxIInterval = 32;
+    blackboxPInterval = 1;
+
+    // send the headers up to the slow frame fields, which follow the main ones
+    for (int i = 0; i < 10000 && serialOutput.find("H Field S encoding:") == std::string::npos; i++) {
+        millisValue += 10;
+        blackboxUpdate(0);
+        blackboxDeviceFlush();
+    }
+    for (int i = 0; i < 100 && serialOutput[serialOutput.size() - 1] != '\n'; i++) {
+        blackboxUpdate(0);
+        blackboxDeviceFlush();
+    }
+
+    const char *namesLine = "H Field I name:";
+    const size_t namesStart = serialOutput.find(namesLine) + strlen(namesLine);
+    log.fieldNames = "," + serialOutput.substr(namesStart, serialOutput.find('\n', namesStart) - namesStart) + ",";
+
+    size_t length = serialOutput.size();
+    blackboxLogIteration(0);
+    blackboxAdvanceIterationTimers();
+    log.iFrameLength = serialOutput.size() - length;
+    EXPECT_EQ('I', serialOutput[length]);
+
+    length = serialOutput.size();
+    blackboxLogIteration(0);
+    blackboxAdvanceIterationTimers();
+    log.pFrameLength = serialOutput.size() - length;
+
+    serialTxFree = 0;
+    return log;
+}
+
+TEST(BlackboxTest, Test_DisabledFieldsLeftOutOfLog)
+{
+    const testLog_t all = recordLog(0);
+    EXPECT_NE(std::string::npos, all.fieldNames.find(",axisP[0],"));
+    EXPECT_NE(std::string::npos, all.fieldNames.find(",axisF[2],"));
+    EXPECT_NE(std::string::npos, all.fieldNames.find(",gyroADC[0],"));
+    EXPECT_NE(std::string::npos, all.fieldNames.find(",motor[0],"));
+
+    const testLog_t noPid = recordLog(1 << FLIGHT_LOG_FIELD_SELECT_PID);
+    EXPECT_EQ(std::string::npos, noPid.fieldNames.find(",axisP["));
+    EXPECT_EQ(std::string::npos, noPid.fieldNames.find(",axisI["));
+    EXPECT_EQ(std::string::npos, noPid.fieldNames.find(",axisF["));
+    EXPECT_NE(std::string::npos, noPid.fieldNames.find(",gyroADC[0],"));
+    // with zero values and zero D gains, the I frame loses 9 one byte P, I and F values, the P frame 3 P and 3 F
+    // deltas and the byte that packs the I deltas
+    EXPECT_EQ(all.iFrameLength - 9, noPid.iFrameLength);
+    EXPECT_EQ(all.pFrameLength - 7, noPid.pFrameLength);
+
+    const testLog_t noGyroOrMotors = recordLog((1 << FLIGHT_LOG_FIELD_SELECT_GYRO) | (1 << FLIGHT_LOG_FIELD_SELECT_MOTOR));
+    EXPECT_EQ(std::string::npos, noGyroOrMotors.fieldNames.find(",gyroADC["));
+    EXPECT_EQ(std::string::npos, noGyroOrMotors.fieldNames.find(",motor["));
+    EXPECT_NE(std::string::npos, noGyroOrMotors.fieldNames.find(",axisP[0],"));
+    // 3 gyro and 4 motor values of one byte each
+    EXPECT_EQ(all.iFrameLength - 7, noGyroOrMotors.iFrameLength);
+    EXPECT_EQ(all.pFrameLength - 7, noGyroOrMotors.pFrameLength);
+
+    blackboxConfigMutable()->fields_disabled_mask = 0;
+}
+
 
 // STUBS
 extern "C" {
@@ -368,11 +521,17 @@ uint8_t stateFlags;
 const uint32_t baudRates[] = {0, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
         400000, 460800, 500000, 921600, 1000000, 1500000, 2000000, 2470000}; // see baudRate_e
 uint8_t debugMode;
-int32_t blackboxHeaderBudget;
 gpsSolutionData_t gpsSol;
 int32_t GPS_home[2];
 
 gyro_t gyro;
+acc_t acc;
+mag_t mag;
+baro_t baro;
+pidAxisData_t pidData[3];
+float rcCommand[4];
+int16_t debug[DEBUG16_VALUE_COUNT];
+float motor[MAX_SUPPORTED_MOTORS];
 
 float motorOutputHigh, motorOutputLow;
 float motor_disarmed[MAX_SUPPORTED_MOTORS];
@@ -385,20 +544,28 @@ boxBitmask_t rcModeActivationMask;
 void mspSerialAllocatePorts(void) {}
 uint32_t getArmingBeepTimeMicros(void) {return 0;}
 uint16_t getBatteryVoltageLatest(void) {return 0;}
+int32_t getAmperageLatest(void) {return 0;}
+uint16_t getRssi(void) {return 0;}
 uint8_t getMotorCount(void) {return 4;}
 bool areMotorsRunning(void) { return false; }
 bool IS_RC_MODE_ACTIVE(boxId_e) {return false;}
 bool isModeActivationConditionPresent(boxId_e) {return false;}
-uint32_t millis(void) {return 0;}
+uint32_t millis(void) {return millisValue;}
 bool sensors(uint32_t) {return false;}
 void serialWrite(serialPort_t *, uint8_t) {}
-uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+{
+    serialWriteBufCalls++;
+    serialWriteBufBytes += count;
+    serialOutput.append((const char *)data, count);
+}
+uint32_t serialTxBytesFree(const serialPort_t *) {return serialTxFree;}
 bool isSerialTransmitBufferEmpty(const serialPort_t *) {return false;}
 bool feature(uint32_t) {return false;}
 void mspSerialReleasePortIfAllocated(serialPort_t *) {}
-serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return NULL;}
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return &blackboxPortConfig;}
 serialPort_t *findSharedSerialPort(uint16_t , serialPortFunction_e ) {return NULL;}
-serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return NULL;}
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) {return &blackboxSerialPort;}
 void closeSerialPort(serialPort_t *) {}
 portSharing_e determinePortSharing(const serialPortConfig_t *, serialPortFunction_e ) {return PORTSHARING_UNUSED;}
 failsafePhase_e failsafePhase(void) {return FAILSAFE_IDLE;}
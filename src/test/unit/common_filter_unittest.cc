@@ -21,6 +21,7 @@
 #include <limits.h>
 
 #include <math.h>
+#include <time.h>
 
 extern "C" {
     #include "common/filter.h"
@@ -114,3 +115,70 @@ TEST(FilterUnittest, TestSlewFilter)
     slewFilterApply(&filter, 200.0f);
     EXPECT_EQ(200, filter.state);
 }
+
+TEST(FilterUnittest, TestBiquadFilter3MatchesPerAxisBiquad)
+{
+    biquadFilter_t perAxis[XYZ_AXIS_COUNT];
+    biquadFilter3_t batched;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInit(&perAxis[axis], 200, 125, 3.5f, FILTER_NOTCH);
+    }
+    biquadFilter3Init(&batched, 200, 125, 3.5f, FILTER_NOTCH);
+
+    for (int i = 0; i < 1000; i++) {
+        float data[XYZ_AXIS_COUNT];
+        float expected[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            data[axis] = 100.0f * sinf(0.01f * i * (axis + 1)) + (i % 7) - 3;
+            expected[axis] = biquadFilterApply(&perAxis[axis], data[axis]);
+        }
+        biquadFilter3Apply(&batched, data);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            EXPECT_FLOAT_EQ(expected[axis], data[axis]);
+        }
+    }
+}
+
+static double elapsedNs(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+TEST(FilterUnittest, TestBiquadFilter3Benchmark)
+{
+    const int samples = 1000000;
+    biquadFilter_t perAxis[XYZ_AXIS_COUNT];
+    biquadFilter3_t batched;
+    // called through a pointer, as the filter chains did before
+    volatile filterApplyFnPtr applyFn = (filterApplyFnPtr)biquadFilterApply;
+    float data[XYZ_AXIS_COUNT] = { 1.0f, 2.0f, 3.0f };
+    struct timespec start, end;
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInit(&perAxis[axis], 200, 125, 3.5f, FILTER_NOTCH);
+    }
+    biquadFilter3Init(&batched, 200, 125, 3.5f, FILTER_NOTCH);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < samples; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            data[axis] = applyFn((filter_t *)&perAxis[axis], data[axis] + 1.0f);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double perAxisNs = elapsedNs(&start, &end) / samples;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < samples; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            data[axis] += 1.0f;
+        }
+        biquadFilter3Apply(&batched, data);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double batchedNs = elapsedNs(&start, &end) / samples;
+
+    printf("biquad per axis: %.2f ns per 3 axis sample, biquad3: %.2f ns per 3 axis sample\n", perAxisNs, batchedNs);
+    EXPECT_TRUE(isfinite(data[X]));
+}
@@ -0,0 +1,125 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/dshot_telemetry.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static const uint8_t gcrEncode[16] = {
+    0x19, 0x1b, 0x12, 0x13, 0x1d, 0x15, 0x16, 0x17,
+    0x1a, 0x09, 0x0a, 0x0b, 0x1e, 0x0d, 0x0e, 0x0f
+};
+
+// builds the edge capture an ESC reply would produce, returns the number of edges
+static uint32_t encodeReply(uint32_t *buffer, uint16_t value12, bool corruptChecksum, int jitter)
+{
+    uint16_t packet = value12 << 4;
+    uint8_t csum = (value12 ^ (value12 >> 4) ^ (value12 >> 8)) & 0xf;
+    csum = ~csum & 0xf;
+    if (corruptChecksum) {
+        csum ^= 0x1;
+    }
+    packet |= csum;
+
+    // start bit followed by four 5 bit symbols, most significant first
+    uint32_t frame = 1;
+    for (int nibble = 3; nibble >= 0; nibble--) {
+        frame = (frame << 5) | gcrEncode[(packet >> (nibble * 4)) & 0xf];
+    }
+
+    uint32_t count = 0;
+    uint32_t time = 1000;
+    for (int bit = 20; bit >= 0; bit--) {
+        if (frame & (1 << bit)) {
+            buffer[count] = time + ((count & 1) ? jitter : -jitter);
+            count++;
+        }
+        time += DSHOT_TELEMETRY_BIT_TICKS;
+    }
+    return count;
+}
+
+static uint16_t periodToValue(uint32_t periodUs)
+{
+    uint32_t exponent = 0;
+    while (periodUs > 0x1ff) {
+        periodUs >>= 1;
+        exponent++;
+    }
+    return (exponent << 9) | periodUs;
+}
+
+TEST(DshotTelemetryUnittest, DecodesErpm)
+{
+    uint32_t buffer[DSHOT_TELEMETRY_INPUT_LEN];
+
+    // 1000us per electrical revolution is 60000 eRPM
+    uint32_t count = encodeReply(buffer, periodToValue(1000), false, 0);
+    EXPECT_EQ(600, dshotDecodeTelemetryPacket(buffer, count));
+
+    count = encodeReply(buffer, periodToValue(250), false, 0);
+    EXPECT_EQ(2400, dshotDecodeTelemetryPacket(buffer, count));
+
+    count = encodeReply(buffer, periodToValue(4000), false, 0);
+    EXPECT_EQ(150, dshotDecodeTelemetryPacket(buffer, count));
+}
+
+TEST(DshotTelemetryUnittest, ToleratesEdgeJitter)
+{
+    uint32_t buffer[DSHOT_TELEMETRY_INPUT_LEN];
+
+    const uint32_t count = encodeReply(buffer, periodToValue(333), false, 3);
+    EXPECT_EQ(1802, dshotDecodeTelemetryPacket(buffer, count));
+}
+
+TEST(DshotTelemetryUnittest, StoppedMotorReportsZero)
+{
+    uint32_t buffer[DSHOT_TELEMETRY_INPUT_LEN];
+
+    const uint32_t count = encodeReply(buffer, 0x0fff, false, 0);
+    EXPECT_EQ(0, dshotDecodeTelemetryPacket(buffer, count));
+}
+
+TEST(DshotTelemetryUnittest, RejectsBadReplies)
+{
+    uint32_t buffer[DSHOT_TELEMETRY_INPUT_LEN];
+
+    uint32_t count = encodeReply(buffer, periodToValue(1000), true, 0);
+    EXPECT_EQ(DSHOT_TELEMETRY_INVALID, dshotDecodeTelemetryPacket(buffer, count));
+
+    // no reply at all
+    EXPECT_EQ(DSHOT_TELEMETRY_INVALID, dshotDecodeTelemetryPacket(buffer, 0));
+
+    // truncated reply
+    count = encodeReply(buffer, periodToValue(1000), false, 0);
+    buffer[count - 1] += 10 * DSHOT_TELEMETRY_BIT_TICKS;
+    EXPECT_EQ(DSHOT_TELEMETRY_INVALID, dshotDecodeTelemetryPacket(buffer, count));
+
+    // capture buffer overflowed
+    EXPECT_EQ(DSHOT_TELEMETRY_INVALID, dshotDecodeTelemetryPacket(buffer, DSHOT_TELEMETRY_INPUT_LEN));
+}
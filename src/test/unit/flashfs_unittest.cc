@@ -0,0 +1,280 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/flash.h"
+
+    #include "io/flashfs.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_SECTORS        64
+#define TEST_SECTOR_SIZE    (256 * 256)
+#define TEST_TOTAL_SIZE     (TEST_SECTORS * TEST_SECTOR_SIZE)
+#define TEST_INDEX_ADDRESS  (TEST_TOTAL_SIZE - TEST_SECTOR_SIZE)
+
+static uint8_t flashData[TEST_TOTAL_SIZE];
+static uint32_t programAddress;
+static uint32_t programPageStart;
+// page programs that ran past the end of the page they started in, the chip wraps them to the start of the page
+static int pageProgramOverruns;
+// most bytes a single page program continue accepts, as when a driver's page buffer is full
+static int programAcceptLimit = TEST_TOTAL_SIZE;
+
+static void writeLog(int length)
+{
+    uint8_t data[100];
+    memset(data, 0x42, sizeof(data));
+
+    flashfsLogStart();
+    while (length > 0) {
+        const int chunk = length < (int)sizeof(data) ? length : sizeof(data);
+        flashfsWrite(data, chunk, true);
+        length -= chunk;
+    }
+}
+
+static void resetFlash(void)
+{
+    memset(flashData, 0xFF, sizeof(flashData));
+    flashfsInit();
+}
+
+TEST(FlashfsTest, LogsAreIndexed)
+{
+    resetFlash();
+    EXPECT_EQ(TEST_INDEX_ADDRESS, (int)flashfsGetSize());
+    EXPECT_EQ(0, (int)flashfsGetOffset());
+
+    flashfsLog_t logs[4];
+    EXPECT_EQ(0, flashfsListLogs(0, logs, 4));
+
+    writeLog(5000);
+    flashfsLogEnd();
+    writeLog(300);
+    flashfsLogEnd();
+
+    // the second log starts on the next free block
+    EXPECT_EQ(2, flashfsListLogs(0, logs, 4));
+    EXPECT_EQ(0u, logs[0].start);
+    EXPECT_EQ(5000u, logs[0].end);
+    EXPECT_EQ(6144u, logs[1].start);
+    EXPECT_EQ(6444u, logs[1].end);
+
+    // paging skips the earlier logs
+    EXPECT_EQ(2, flashfsListLogs(1, logs, 4));
+    EXPECT_EQ(6144u, logs[0].start);
+
+    // at boot the free space starts where the last log ended
+    flashfsInit();
+    EXPECT_EQ(6444, flashfsIdentifyStartOfFreeSpace());
+    EXPECT_EQ(6444u, flashfsGetOffset());
+    EXPECT_EQ(2, flashfsListLogs(0, logs, 4));
+}
+
+TEST(FlashfsTest, UnclosedLogIsClosedAtBoot)
+{
+    resetFlash();
+
+    writeLog(3000);
+    flashfsFlushSync();
+
+    flashfsLog_t logs[4];
+    EXPECT_EQ(1, flashfsListLogs(0, logs, 4));
+    EXPECT_EQ(3000u, logs[0].end);
+
+    // power lost before the end was recorded, the end is found by scanning from the start of the log
+    flashfsInit();
+    EXPECT_EQ(4096u, flashfsGetOffset());
+    EXPECT_EQ(1, flashfsListLogs(0, logs, 4));
+    EXPECT_EQ(0u, logs[0].start);
+    EXPECT_EQ(4096u, logs[0].end);
+}
+
+TEST(FlashfsTest, ShortPageProgramsAreRetried)
+{
+    resetFlash();
+    flashfsLogStart();
+
+    uint8_t data[300];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+    programAcceptLimit = 100;
+    flashfsWrite(data, sizeof(data), true);
+    flashfsFlushSync();
+    programAcceptLimit = TEST_TOTAL_SIZE;
+
+    // bytes the device didn't take are written by the following page programs, nothing is skipped
+    EXPECT_EQ(sizeof(data), flashfsGetOffset());
+    EXPECT_EQ(0, memcmp(data, flashData, sizeof(data)));
+}
+
+TEST(FlashfsTest, WritesAcrossPageBoundaryAreSplit)
+{
+    resetFlash();
+    flashfsLogStart();
+    pageProgramOverruns = 0;
+
+    uint8_t data[400];
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = i * 7;
+    }
+    // the second write starts part way into the first page and runs into the next one
+    flashfsWrite(data, 100, true);
+    flashfsFlushSync();
+    flashfsWrite(data + 100, sizeof(data) - 100, true);
+    flashfsFlushSync();
+
+    EXPECT_EQ(0, pageProgramOverruns);
+    EXPECT_EQ(sizeof(data), flashfsGetOffset());
+    EXPECT_EQ(0, memcmp(data, flashData, sizeof(data)));
+}
+
+TEST(FlashfsTest, ChipWithoutIndexIsScanned)
+{
+    memset(flashData, 0xFF, sizeof(flashData));
+    memset(flashData, 0x42, 5000);
+    flashfsInit();
+
+    EXPECT_EQ(6144u, flashfsGetOffset());
+    flashfsLog_t logs[4];
+    EXPECT_EQ(0, flashfsListLogs(0, logs, 4));
+
+    // the index now tracks the data that was already there
+    flashfsInit();
+    EXPECT_EQ(6144u, flashfsGetOffset());
+}
+
+TEST(FlashfsTest, CorruptIndexIsRebuilt)
+{
+    resetFlash();
+
+    writeLog(1000);
+    flashfsLogEnd();
+
+    // tear the end record
+    flashData[TEST_INDEX_ADDRESS + 3 * 8] &= 0x0F;
+    flashfsInit();
+    EXPECT_EQ(2048u, flashfsGetOffset());
+
+    // data written past the recorded end
+    writeLog(100);
+    flashfsLogEnd();
+    memset(flashData + 2148, 0x42, 3000);
+    flashfsInit();
+    EXPECT_EQ(6144u, flashfsGetOffset());
+}
+
+TEST(FlashfsTest, LogsInIndexSectorDisableIndex)
+{
+    memset(flashData, 0x42, sizeof(flashData));
+    flashfsInit();
+
+    EXPECT_EQ(TEST_TOTAL_SIZE, (int)flashfsGetSize());
+    EXPECT_TRUE(flashfsIsEOF());
+    flashfsLog_t logs[4];
+    EXPECT_EQ(-1, flashfsListLogs(0, logs, 4));
+
+    // erasing the chip gives the sector back to the index
+    flashfsEraseCompletely();
+    EXPECT_EQ(TEST_INDEX_ADDRESS, (int)flashfsGetSize());
+    EXPECT_EQ(0, flashfsListLogs(0, logs, 4));
+    writeLog(10);
+    flashfsLogEnd();
+    EXPECT_EQ(1, flashfsListLogs(0, logs, 4));
+}
+
+// STUBS
+
+extern "C" {
+
+static const flashGeometry_t geometry = {
+    .sectors = TEST_SECTORS,
+    .pageSize = 256,
+    .sectorSize = TEST_SECTOR_SIZE,
+    .totalSize = TEST_TOTAL_SIZE,
+    .pagesPerSector = 256,
+    .flashType = FLASH_TYPE_NOR,
+};
+
+bool flashIsReady(void) { return true; }
+bool flashWaitForReady(uint32_t) { return true; }
+
+void flashEraseSector(uint32_t address)
+{
+    memset(flashData + address - address % TEST_SECTOR_SIZE, 0xFF, TEST_SECTOR_SIZE);
+}
+
+void flashEraseCompletely(void)
+{
+    memset(flashData, 0xFF, sizeof(flashData));
+}
+
+void flashPageProgramBegin(uint32_t address)
+{
+    programAddress = address;
+    programPageStart = address - address % geometry.pageSize;
+}
+
+int flashPageProgramContinue(const uint8_t *data, int length)
+{
+    length = length < programAcceptLimit ? length : programAcceptLimit;
+    // programming can only clear bits
+    for (int i = 0; i < length; i++) {
+        if (programAddress == programPageStart + geometry.pageSize) {
+            programAddress = programPageStart;
+            pageProgramOverruns++;
+        }
+        flashData[programAddress++] &= data[i];
+    }
+    return length;
+}
+
+void flashPageProgramFinish(void) {}
+
+void flashPageProgram(uint32_t address, const uint8_t *data, int length)
+{
+    flashPageProgramBegin(address);
+    flashPageProgramContinue(data, length);
+    flashPageProgramFinish();
+}
+
+int flashReadBytes(uint32_t address, uint8_t *buffer, int length)
+{
+    memcpy(buffer, flashData + address, length);
+    return length;
+}
+
+void flashFlush(void) {}
+
+const flashGeometry_t *flashGetGeometry(void)
+{
+    return &geometry;
+}
+
+}
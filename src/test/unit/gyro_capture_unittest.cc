@@ -0,0 +1,83 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "sensors/gyro_capture.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static void captureSamples(int first, int count)
+{
+    for (int i = first; i < first + count; i++) {
+        const int16_t sample[XYZ_AXIS_COUNT] = { (int16_t)i, (int16_t)-i, (int16_t)(i * 2) };
+        gyroCaptureSample(sample);
+    }
+}
+
+TEST(GyroCaptureTest, SamplesAreOnlyKeptWhileRunning)
+{
+    gyroCaptureStart(125);
+    gyroCaptureStop();
+    captureSamples(0, 10);
+    EXPECT_EQ(GYRO_CAPTURE_STOPPED, gyroCaptureGetState());
+    EXPECT_EQ(0, gyroCaptureSampleCount());
+
+    gyroCaptureStart(125);
+    EXPECT_EQ(GYRO_CAPTURE_RUNNING, gyroCaptureGetState());
+    EXPECT_EQ(125u, gyroCaptureSampleIntervalUs());
+    captureSamples(0, 10);
+    gyroCaptureStop();
+    captureSamples(10, 10);
+    EXPECT_EQ(10, gyroCaptureSampleCount());
+
+    int16_t sample[XYZ_AXIS_COUNT];
+    for (int i = 0; i < 10; i++) {
+        gyroCaptureGetSample(i, sample);
+        EXPECT_EQ(i, sample[X]);
+        EXPECT_EQ(-i, sample[Y]);
+        EXPECT_EQ(i * 2, sample[Z]);
+    }
+}
+
+TEST(GyroCaptureTest, FullBufferKeepsNewestSamples)
+{
+    gyroCaptureStart(31);
+    captureSamples(0, GYRO_CAPTURE_SAMPLE_COUNT + 100);
+    gyroCaptureStop();
+    EXPECT_EQ(GYRO_CAPTURE_SAMPLE_COUNT, gyroCaptureSampleCount());
+
+    // oldest first
+    int16_t sample[XYZ_AXIS_COUNT];
+    gyroCaptureGetSample(0, sample);
+    EXPECT_EQ(100, sample[X]);
+    gyroCaptureGetSample(GYRO_CAPTURE_SAMPLE_COUNT - 1, sample);
+    EXPECT_EQ(GYRO_CAPTURE_SAMPLE_COUNT + 99, sample[X]);
+    EXPECT_EQ(2 * (GYRO_CAPTURE_SAMPLE_COUNT + 99), sample[Z]);
+
+    // a new capture starts empty
+    gyroCaptureStart(31);
+    EXPECT_EQ(0, gyroCaptureSampleCount());
+}
@@ -0,0 +1,623 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Frequency response and cost of the complete gyro filter chain, run through gyroUpdate() exactly as in flight.
+//
+// Every configuration in filterConfigs is swept with sine inputs and the magnitude, phase delay and
+// host ns per gyroUpdate() are printed. The FFT analyser runs on the float stubs at the end of this file
+// instead of CMSIS, so its cost only compares FFT configurations with each other.
+// Set GYRO_TRACE to a text file with one "roll pitch yaw" sample per line,
+// in deg/s at the gyro rate printed by the test, to run the same configurations over a recorded trace.
+// Lines that don't start with a number are skipped, so the gyroADC columns cut from blackbox_decode csv work.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "drivers/accgyro/accgyro.h"
+    #include "drivers/accgyro/accgyro_fake.h"
+    #include "drivers/sensor.h"
+
+    #include "io/beeper.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    #include "scheduler/scheduler.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/gyro.h"
+    #include "sensors/gyroanalyse.h"
+    #include "sensors/sensors.h"
+
+    STATIC_UNIT_TESTED bool fakeGyroRead(gyroDev_t *gyro);
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+
+    static bool dynamicFilterEnabled;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+extern gyroDev_t * const gyroDevPtr;
+
+#define SINE_AMPLITUDE_DPS  200.0f
+#define SETTLE_TIME_S       0.5f
+#define MEASURE_TIME_S      0.25f
+
+typedef struct filterConfig_s {
+    const char *name;
+    uint8_t  lowpassType;
+    uint16_t lowpassHz;
+    uint8_t  lowpass2Type;
+    uint16_t lowpass2Hz;
+    uint16_t notchHz;
+    uint16_t notchCutoffHz;
+    bool     dynamicNotch;
+    uint8_t  dynNotchAnalyser;
+    uint8_t  dynNotchCount;
+} filterConfig_t;
+
+static const filterConfig_t filterConfigs[] = {
+    { .name = "none",
+      .lowpassType = FILTER_PT1, .lowpassHz = 0, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 0,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "pt1 100",
+      .lowpassType = FILTER_PT1, .lowpassHz = 100, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 0,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "biquad 100",
+      .lowpassType = FILTER_BIQUAD, .lowpassHz = 100, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 0,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "kalman",
+      .lowpassType = FILTER_KALMAN, .lowpassHz = 100, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 0,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "kalman + biquad 90",
+      .lowpassType = FILTER_KALMAN, .lowpassHz = 100, .lowpass2Type = FILTER_BIQUAD, .lowpass2Hz = 90,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "pt1 200 + pt1 100",
+      .lowpassType = FILTER_PT1, .lowpassHz = 200, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 100,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "notch 300/200 + pt1",
+      .lowpassType = FILTER_PT1, .lowpassHz = 100, .lowpass2Type = FILTER_PT1, .lowpass2Hz = 0,
+      .notchHz = 300, .notchCutoffHz = 200, .dynamicNotch = false, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "dyn notch + biquad 90",
+      .lowpassType = FILTER_PT1, .lowpassHz = 0, .lowpass2Type = FILTER_BIQUAD, .lowpass2Hz = 90,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = true, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 1 },
+    { .name = "sdft notch + biquad 90",
+      .lowpassType = FILTER_PT1, .lowpassHz = 0, .lowpass2Type = FILTER_BIQUAD, .lowpass2Hz = 90,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = true, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_SDFT, .dynNotchCount = 1 },
+    { .name = "3 dyn notches + biq 90",
+      .lowpassType = FILTER_PT1, .lowpassHz = 0, .lowpass2Type = FILTER_BIQUAD, .lowpass2Hz = 90,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = true, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_FFT, .dynNotchCount = 3 },
+    { .name = "3 sdft notches + biq 90",
+      .lowpassType = FILTER_PT1, .lowpassHz = 0, .lowpass2Type = FILTER_BIQUAD, .lowpass2Hz = 90,
+      .notchHz = 0, .notchCutoffHz = 0, .dynamicNotch = true, .dynNotchAnalyser = DYN_NOTCH_ANALYSER_SDFT, .dynNotchCount = 3 },
+};
+
+static const float sweepFrequenciesHz[] = { 25, 50, 100, 150, 200, 300, 400, 500, 700, 1000 };
+
+typedef struct filterResponse_s {
+    float magnitude;
+    float delayUs;
+} filterResponse_t;
+
+static uint64_t nanos(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static timeUs_t currentTimeUs;
+static uint64_t filterNanos;
+static uint32_t filterSamples;
+
+static void setupFilters(const filterConfig_t *config)
+{
+    pgResetAll();
+    // 4kHz, the usual F4/F7 gyro loop rate
+    gyroConfigMutable()->gyro_sync_denom = 2;
+    gyroConfigMutable()->gyro_lowpass_type = config->lowpassType;
+    gyroConfigMutable()->gyro_lowpass_hz = config->lowpassHz;
+    gyroConfigMutable()->gyro_lowpass2_type = config->lowpass2Type;
+    gyroConfigMutable()->gyro_lowpass2_hz = config->lowpass2Hz;
+    gyroConfigMutable()->gyro_soft_notch_hz_1 = config->notchHz;
+    gyroConfigMutable()->gyro_soft_notch_cutoff_1 = config->notchCutoffHz;
+    // the harness feeds large fast sines, which must not trip the flight safety checks
+    gyroConfigMutable()->checkOverflow = GYRO_OVERFLOW_CHECK_NONE;
+    gyroConfigMutable()->yaw_spin_recovery = false;
+    gyroConfigMutable()->dyn_notch_analyser = config->dynNotchAnalyser;
+    gyroConfigMutable()->dyn_notch_count = MAX(config->dynNotchCount, 1);
+    dynamicFilterEnabled = config->dynamicNotch;
+
+    gyroInit();
+    gyroDevPtr->readFn = fakeGyroRead;
+
+    currentTimeUs = 0;
+    gyroStartCalibration(false);
+    while (!isGyroCalibrationComplete()) {
+        fakeGyroSet(gyroDevPtr, 0, 0, 0);
+        gyroUpdate(currentTimeUs);
+        currentTimeUs += gyro.targetLooptime;
+    }
+    filterNanos = 0;
+    filterSamples = 0;
+}
+
+static void filterSample(const float *sampleDps)
+{
+    fakeGyroSet(gyroDevPtr,
+        lrintf(sampleDps[X] / gyroDevPtr->scale),
+        lrintf(sampleDps[Y] / gyroDevPtr->scale),
+        lrintf(sampleDps[Z] / gyroDevPtr->scale));
+
+    const uint64_t startNanos = nanos();
+    gyroUpdate(currentTimeUs);
+    filterNanos += nanos() - startNanos;
+    filterSamples++;
+
+    currentTimeUs += gyro.targetLooptime;
+}
+
+static float nanosPerSample(void)
+{
+    return filterSamples ? (float)filterNanos / filterSamples : 0.0f;
+}
+
+// feeds a sine to all axes and demodulates the settled roll output against it
+static filterResponse_t measureResponse(float frequencyHz)
+{
+    const float sampleRateHz = 1e6f / gyro.targetLooptime;
+    const int settleSamples = SETTLE_TIME_S * sampleRateHz;
+    // close to a whole number of periods, so the demodulation has little leakage
+    const int measureSamples = lrintf(MAX(1, lrintf(MEASURE_TIME_S * frequencyHz)) * sampleRateHz / frequencyHz);
+    const float omega = 2 * M_PIf * frequencyHz / sampleRateHz;
+
+    double inputI = 0, inputQ = 0, outputI = 0, outputQ = 0;
+    for (int i = 0; i < settleSamples + measureSamples; i++) {
+        const float input = SINE_AMPLITUDE_DPS * sinf(omega * i);
+        const float sample[XYZ_AXIS_COUNT] = { input, input, input };
+        filterSample(sample);
+        if (i >= settleSamples) {
+            const float quantisedInput = lrintf(input / gyroDevPtr->scale) * gyroDevPtr->scale;
+            inputI += quantisedInput * sinf(omega * i);
+            inputQ += quantisedInput * cosf(omega * i);
+            outputI += gyro.gyroADCf[X] * sinf(omega * i);
+            outputQ += gyro.gyroADCf[X] * cosf(omega * i);
+        }
+    }
+
+    filterResponse_t response;
+    response.magnitude = sqrt(outputI * outputI + outputQ * outputQ) / sqrt(inputI * inputI + inputQ * inputQ);
+    float phase = atan2(outputQ, outputI) - atan2(inputQ, inputI);
+    while (phase > 0) {
+        phase -= 2 * M_PIf;
+    }
+    while (phase <= -2 * M_PIf) {
+        phase += 2 * M_PIf;
+    }
+    response.delayUs = -phase / (2 * M_PIf * frequencyHz) * 1e6f;
+    return response;
+}
+
+static filterResponse_t configResponse(const filterConfig_t *config, float frequencyHz)
+{
+    setupFilters(config);
+    return measureResponse(frequencyHz);
+}
+
+TEST(GyroFilterResponseUnittest, Sweep)
+{
+    setupFilters(&filterConfigs[0]);
+    printf("gyro rate %dHz, magnitude / phase delay in us at each frequency\n", (int)lrintf(1e6f / gyro.targetLooptime));
+    printf("%-22s", "");
+    for (unsigned f = 0; f < ARRAYLEN(sweepFrequenciesHz); f++) {
+        printf(" %11dHz", (int)sweepFrequenciesHz[f]);
+    }
+    printf("  ns/sample\n");
+
+    for (unsigned c = 0; c < ARRAYLEN(filterConfigs); c++) {
+        const filterConfig_t *config = &filterConfigs[c];
+        printf("%-22s", config->name);
+        float nanosSum = 0;
+        for (unsigned f = 0; f < ARRAYLEN(sweepFrequenciesHz); f++) {
+            const filterResponse_t response = configResponse(config, sweepFrequenciesHz[f]);
+            printf(" %5.3f/%6.0f", response.magnitude, response.delayUs);
+            nanosSum += nanosPerSample();
+
+            if (sweepFrequenciesHz[f] <= 25) {
+                // every configuration must pass stick inputs
+                EXPECT_GT(response.magnitude, 0.85f) << config->name;
+            }
+        }
+        printf(" %10.1f\n", nanosSum / ARRAYLEN(sweepFrequenciesHz));
+    }
+}
+
+TEST(GyroFilterResponseUnittest, UnfilteredIsTransparent)
+{
+    const filterResponse_t response = configResponse(&filterConfigs[0], 200);
+    EXPECT_NEAR(1.0f, response.magnitude, 0.01f);
+    EXPECT_NEAR(0.0f, response.delayUs, 5.0f);
+}
+
+TEST(GyroFilterResponseUnittest, Pt1MatchesTheory)
+{
+    // first order lowpass: -3dB and 45 degrees of phase at the cutoff, i.e. 1/8 of a period of delay
+    const filterResponse_t response = configResponse(&filterConfigs[1], 100);
+    EXPECT_NEAR(M_SQRT1_2, response.magnitude, 0.05f);
+    EXPECT_NEAR(1e6f / (8 * 100), response.delayUs, 150.0f);
+}
+
+TEST(GyroFilterResponseUnittest, StaticNotchRemovesCentreFrequency)
+{
+    EXPECT_LT(configResponse(&filterConfigs[6], 300).magnitude, 0.05f);
+}
+
+TEST(GyroFilterResponseUnittest, DynamicNotchTracksTone)
+{
+    filterConfig_t withoutDynamicNotch = filterConfigs[7];
+    withoutDynamicNotch.dynamicNotch = false;
+    const float unnotched = configResponse(&withoutDynamicNotch, 300).magnitude;
+    const float notched = configResponse(&filterConfigs[7], 300).magnitude;
+    EXPECT_LT(notched, 0.25f * unnotched);
+}
+
+TEST(GyroFilterResponseUnittest, SdftNotchTracksTone)
+{
+    filterConfig_t withoutDynamicNotch = filterConfigs[8];
+    withoutDynamicNotch.dynamicNotch = false;
+    const float unnotched = configResponse(&withoutDynamicNotch, 300).magnitude;
+    const float notched = configResponse(&filterConfigs[8], 300).magnitude;
+    EXPECT_LT(notched, 0.25f * unnotched);
+}
+
+TEST(GyroFilterResponseUnittest, SdftTracksThreePeaks)
+{
+    static const float toneHz[DYN_NOTCH_COUNT_MAX] = { 180, 310, 450 };
+    static const float toneDps[DYN_NOTCH_COUNT_MAX] = { 40, 100, 60 };
+
+    setupFilters(&filterConfigs[8]);
+    static gyroAnalyseState_t state;
+    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    gyroDataAnalyseStateInit(&state, gyro.targetLooptime);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+            biquadFilterInit(&notchFilterDyn[axis][i], 400, gyro.targetLooptime, 1.0f, FILTER_NOTCH);
+        }
+    }
+
+    const float sampleRateHz = 1e6f / gyro.targetLooptime;
+    for (int i = 0; i < SETTLE_TIME_S * sampleRateHz; i++) {
+        float sample = 0;
+        for (int tone = 0; tone < DYN_NOTCH_COUNT_MAX; tone++) {
+            sample += toneDps[tone] * sinf(2 * M_PIf * toneHz[tone] * i / sampleRateHz);
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDataAnalysePush(&state, axis, sample);
+        }
+        gyroDataAnalyse(&state, notchFilterDyn);
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        // every tone is tracked by exactly one slot
+        for (int tone = 0; tone < DYN_NOTCH_COUNT_MAX; tone++) {
+            int matches = 0;
+            for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+                const dynNotchPeak_t *peak = &state.peaks[axis][i];
+                if (peak->power > 0 && fabsf(peak->frequency - toneHz[tone]) < 8.0f) {
+                    matches++;
+                }
+            }
+            EXPECT_EQ(1, matches) << "axis " << axis << " tone " << toneHz[tone];
+        }
+        // the single notch sits on the strongest tone
+        EXPECT_NEAR(toneHz[1], state.centerFreq[axis], 8);
+    }
+}
+
+TEST(GyroFilterResponseUnittest, AnalyserSampleCountMatchesGyroRate)
+{
+    // gyro rates and the gyro samples averaged into each analyser sample
+    static const struct { uint32_t looptimeUs; uint8_t sampleCount; } rates[] = {
+        { 125, 6 }, { 250, 3 }, { 375, 3 }, { 500, 3 },
+    };
+    static gyroAnalyseState_t state;
+    for (unsigned i = 0; i < ARRAYLEN(rates); i++) {
+        gyroDataAnalyseStateInit(&state, rates[i].looptimeUs);
+        EXPECT_EQ(rates[i].sampleCount, state.maxSampleCount) << rates[i].looptimeUs << "us";
+    }
+}
+
+// gyroInit() runs again after a config change, the analyser must not carry anything over
+TEST(GyroFilterResponseUnittest, AnalyserReinitStartsEmpty)
+{
+    static gyroAnalyseState_t state;
+    biquadFilter_t notchFilterDyn[XYZ_AXIS_COUNT][DYN_NOTCH_COUNT_MAX];
+    setupFilters(&filterConfigs[9]);
+    gyroDataAnalyseStateInit(&state, gyro.targetLooptime);
+    for (int i = 0; i < 1000; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroDataAnalysePush(&state, axis, SINE_AMPLITUDE_DPS * sinf(0.5f * i));
+        }
+        gyroDataAnalyse(&state, notchFilterDyn);
+    }
+
+    gyroDataAnalyseStateInit(&state, gyro.targetLooptime);
+    EXPECT_EQ(0, state.sampleCount);
+    EXPECT_EQ(0, state.circularBufferIdx);
+    EXPECT_EQ(0, state.updateStep);
+    EXPECT_EQ(0, state.updateAxis);
+    EXPECT_EQ(0, state.notchUpdateIdx);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_EQ(0, state.oversampledGyroAccumulator[axis]);
+        for (int i = 0; i < FFT_WINDOW_SIZE; i++) {
+            EXPECT_EQ(0, state.downsampledGyroData[axis][i]);
+        }
+        for (int i = 0; i < DYN_NOTCH_COUNT_MAX; i++) {
+            EXPECT_EQ(0, state.peaks[axis][i].frequency);
+        }
+    }
+}
+
+// rms roll output for a sum of tones after the notches have settled, relative to the rms input
+static float multiToneResponse(const filterConfig_t *config, const float *toneHz, const float *toneDps, int toneCount)
+{
+    setupFilters(config);
+    const float sampleRateHz = 1e6f / gyro.targetLooptime;
+    const int settleSamples = SETTLE_TIME_S * sampleRateHz;
+    const int measureSamples = MEASURE_TIME_S * sampleRateHz;
+
+    double inputSquares = 0, outputSquares = 0;
+    for (int i = 0; i < settleSamples + measureSamples; i++) {
+        float input = 0;
+        for (int tone = 0; tone < toneCount; tone++) {
+            input += toneDps[tone] * sinf(2 * M_PIf * toneHz[tone] * i / sampleRateHz);
+        }
+        const float sample[XYZ_AXIS_COUNT] = { input, input, input };
+        filterSample(sample);
+        if (i >= settleSamples) {
+            inputSquares += input * input;
+            outputSquares += gyro.gyroADCf[X] * gyro.gyroADCf[X];
+        }
+    }
+    return sqrt(outputSquares / inputSquares);
+}
+
+TEST(GyroFilterResponseUnittest, NotchCascadeRemovesSeveralResonances)
+{
+    // frame resonance and motor noise at different frequencies, no lowpass to hide them
+    static const float toneHz[] = { 180, 320, 470 };
+    static const float toneDps[] = { 60, 100, 80 };
+
+    for (int analyser = DYN_NOTCH_ANALYSER_FFT; analyser <= DYN_NOTCH_ANALYSER_SDFT; analyser++) {
+        filterConfig_t config = filterConfigs[0];
+        config.dynamicNotch = true;
+        config.dynNotchAnalyser = analyser;
+        config.dynNotchCount = 1;
+        const float single = multiToneResponse(&config, toneHz, toneDps, ARRAYLEN(toneHz));
+        config.dynNotchCount = 3;
+        const float cascade = multiToneResponse(&config, toneHz, toneDps, ARRAYLEN(toneHz));
+        printf("analyser %d: rms out/in %.3f with one notch, %.3f with three\n", analyser, single, cascade);
+
+        // one notch can remove at most the strongest tone
+        EXPECT_GT(single, 0.3f);
+        EXPECT_LT(cascade, 0.25f * single);
+    }
+}
+
+// reads the next "roll pitch yaw" sample, skipping lines that don't start with one
+static bool readTraceSample(FILE *file, float *sample)
+{
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%f%*[ ,;\t]%f%*[ ,;\t]%f", &sample[X], &sample[Y], &sample[Z]) == XYZ_AXIS_COUNT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// the specialised filter chains must give exactly the output of the generic one
+TEST(GyroFilterResponseUnittest, VariantsMatchGenericChain)
+{
+    const int sampleCount = 2000;
+    static float output[2000][XYZ_AXIS_COUNT];
+    for (unsigned c = 0; c < ARRAYLEN(filterConfigs); c++) {
+        const filterConfig_t *config = &filterConfigs[c];
+        for (int generic = 0; generic <= 1; generic++) {
+            // any gyro debug mode runs the generic filterGyroDebug()
+            debugMode = generic ? DEBUG_GYRO_FILTERED : DEBUG_NONE;
+            setupFilters(config);
+            for (int i = 0; i < sampleCount; i++) {
+                const float input = SINE_AMPLITUDE_DPS * (sinf(0.05f * i) + 0.5f * sinf(0.6f * i));
+                const float sample[XYZ_AXIS_COUNT] = { input, -input, 0.5f * input };
+                filterSample(sample);
+                for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                    if (generic) {
+                        ASSERT_EQ(output[i][axis], gyro.gyroADCf[axis]) << config->name << " sample " << i;
+                    } else {
+                        output[i][axis] = gyro.gyroADCf[axis];
+                    }
+                }
+            }
+        }
+    }
+    debugMode = DEBUG_NONE;
+}
+
+TEST(GyroFilterResponseUnittest, Trace)
+{
+    const char *traceName = getenv("GYRO_TRACE");
+    if (!traceName) {
+        printf("set GYRO_TRACE=<file> to compare the filter configurations on a recorded gyro trace\n");
+        return;
+    }
+    FILE *file = fopen(traceName, "r");
+    ASSERT_TRUE(file != NULL) << "can't open " << traceName;
+
+    printf("%s: rms in deg/s roll pitch yaw\n", traceName);
+    for (unsigned c = 0; c < ARRAYLEN(filterConfigs); c++) {
+        const filterConfig_t *config = &filterConfigs[c];
+        setupFilters(config);
+        // the trace is streamed again for every configuration, so any length fits
+        rewind(file);
+        double inputSquares[XYZ_AXIS_COUNT] = { 0 };
+        double outputSquares[XYZ_AXIS_COUNT] = { 0 };
+        int sampleCount = 0;
+        float sample[XYZ_AXIS_COUNT];
+        while (readTraceSample(file, sample)) {
+            filterSample(sample);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                inputSquares[axis] += sample[axis] * sample[axis];
+                outputSquares[axis] += gyro.gyroADCf[axis] * gyro.gyroADCf[axis];
+            }
+            sampleCount++;
+        }
+        ASSERT_GT(sampleCount, 0);
+
+        printf("%-22s", config->name);
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            printf(" %7.2f -> %7.2f", sqrt(inputSquares[axis] / sampleCount), sqrt(outputSquares[axis] / sampleCount));
+        }
+        printf("  %6.1f ns/sample\n", nanosPerSample());
+    }
+    fclose(file);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return currentTimeUs; }
+// host nanoseconds stand in for the cycle counter of DEBUG_GYRO_FILTER_CYCLES
+uint32_t ticks(void) { return nanos(); }
+void beeper(beeperMode_e) {}
+uint8_t detectedSensors[] = { GYRO_NONE, ACC_NONE };
+timeDelta_t getGyroUpdateRate(void) { return gyro.targetLooptime; }
+void sensorsSet(uint32_t) {}
+void schedulerResetTaskStatistics(cfTaskId_e) {}
+int getArmingDisableFlags(void) { return 0; }
+bool feature(uint32_t mask) { return (mask & FEATURE_DYNAMIC_FILTER) && dynamicFilterEnabled; }
+
+// float versions of the CMSIS DSP functions gyroanalyse.c uses, see unit/arm_math.h
+// The complex FFT stage leaves its output in natural order, so the bit reversal stage has nothing to do.
+arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32 *S, uint16_t fftLen)
+{
+    S->fftLenRFFT = fftLen;
+    S->pTwiddleRFFT = NULL;
+    S->Sint.fftLen = fftLen / 2;
+    S->Sint.pTwiddle = NULL;
+    S->Sint.pBitRevTable = NULL;
+    S->Sint.bitRevLength = 0;
+    return ARM_MATH_SUCCESS;
+}
+
+// in place radix 2 FFT of fftLen complex values, output in natural order
+static void cfft(float32_t *p, uint16_t fftLen)
+{
+    for (int i = 1, j = 0; i < fftLen; i++) {
+        int bit = fftLen >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float32_t tmp = p[2 * i];
+            p[2 * i] = p[2 * j];
+            p[2 * j] = tmp;
+            tmp = p[2 * i + 1];
+            p[2 * i + 1] = p[2 * j + 1];
+            p[2 * j + 1] = tmp;
+        }
+    }
+    for (int len = 2; len <= fftLen; len <<= 1) {
+        for (int k = 0; k < len / 2; k++) {
+            const float twRe = cosf(2 * M_PIf * k / len);
+            const float twIm = -sinf(2 * M_PIf * k / len);
+            for (int i = k; i < fftLen; i += len) {
+                float32_t *a = &p[2 * i];
+                float32_t *b = &p[2 * (i + len / 2)];
+                const float bRe = b[0] * twRe - b[1] * twIm;
+                const float bIm = b[0] * twIm + b[1] * twRe;
+                b[0] = a[0] - bRe;
+                b[1] = a[1] - bIm;
+                a[0] += bRe;
+                a[1] += bIm;
+            }
+        }
+    }
+}
+
+void arm_cfft_radix8by2_f32(arm_cfft_instance_f32 *S, float32_t *p1) { cfft(p1, S->fftLen); }
+void arm_cfft_radix8by4_f32(arm_cfft_instance_f32 *S, float32_t *p1) { cfft(p1, S->fftLen); }
+void arm_radix8_butterfly_f32(float32_t *pSrc, uint16_t fftLen, const float32_t *, uint16_t) { cfft(pSrc, fftLen); }
+void arm_bitreversal_32(uint32_t *, const uint16_t, const uint16_t *) {}
+
+// splits the complex FFT of the even/odd packed real input into the real FFT, scaled by 1/2 like CMSIS,
+// with the real nyquist bin in the imaginary part of bin 0
+void stage_rfft_f32(arm_rfft_fast_instance_f32 *S, float32_t *p, float32_t *pOut)
+{
+    const int n = S->Sint.fftLen;
+    pOut[0] = 0.5f * (p[0] + p[1]);
+    pOut[1] = 0.5f * (p[0] - p[1]);
+    for (int k = 1; k < n; k++) {
+        const float aRe = p[2 * k], aIm = p[2 * k + 1];
+        const float bRe = p[2 * (n - k)], bIm = -p[2 * (n - k) + 1];
+        const float evenRe = 0.5f * (aRe + bRe), evenIm = 0.5f * (aIm + bIm);
+        const float oddRe = 0.5f * (aIm - bIm), oddIm = -0.5f * (aRe - bRe);
+        const float twRe = cosf(M_PIf * k / n), twIm = -sinf(M_PIf * k / n);
+        pOut[2 * k] = 0.5f * (evenRe + twRe * oddRe - twIm * oddIm);
+        pOut[2 * k + 1] = 0.5f * (evenIm + twRe * oddIm + twIm * oddRe);
+    }
+}
+
+void arm_cmplx_mag_f32(float32_t *pSrc, float32_t *pDst, uint32_t numSamples)
+{
+    for (uint32_t i = 0; i < numSamples; i++) {
+        pDst[i] = sqrtf(pSrc[2 * i] * pSrc[2 * i] + pSrc[2 * i + 1] * pSrc[2 * i + 1]);
+    }
+}
+
+void arm_mult_f32(float32_t *pSrcA, float32_t *pSrcB, float32_t *pDst, uint32_t blockSize)
+{
+    for (uint32_t i = 0; i < blockSize; i++) {
+        pDst[i] = pSrcA[i] * pSrcB[i];
+    }
+}
+
+}
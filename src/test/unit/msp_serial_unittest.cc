@@ -0,0 +1,451 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/crc.h"
+    #include "common/maths.h"
+    #include "common/streambuf.h"
+    #include "common/utils.h"
+
+    #include "drivers/serial.h"
+
+    #include "interface/cli.h"
+    #include "interface/msp.h"
+    #include "interface/msp_protocol.h"
+
+    #include "io/serial.h"
+
+    #include "msp/msp_serial.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    PG_REGISTER(serialConfig_t, serialConfig, PG_SERIAL_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_BUFFER_SIZE 512
+
+typedef struct testData_s {
+    uint8_t rxBuffer[TEST_BUFFER_SIZE];
+    int rxLength;
+    int rxPos;
+
+    bool frameCapable;
+    int framesSent;
+    const uint8_t *frame;
+    int frameLength;
+    serialTxFrameDoneCallbackPtr frameDoneCb[MSP_FRAME_POOL_SIZE + 1];
+    void *frameDoneData[MSP_FRAME_POOL_SIZE + 1];
+
+    uint8_t txCopy[TEST_BUFFER_SIZE];
+    int txCopyLength;
+    int txSize;     // the size of the port's transmit buffer, the copied bytes are what it still holds
+    bool txOverflow;
+
+    int commandCount;
+    int replySize;
+} testData_t;
+
+static testData_t testData;
+static serialPort_t testPort;
+static serialPortConfig_t testPortConfig;
+
+static void releaseSentFrames(void)
+{
+    for (int i = 0; i < testData.framesSent; i++) {
+        if (testData.frameDoneCb[i]) {
+            testData.frameDoneCb[i](testData.frameDoneData[i]);
+            testData.frameDoneCb[i] = NULL;
+        }
+    }
+}
+
+static void resetTest(bool frameCapable)
+{
+    // the pool outlives the test, hand back whatever the previous one left in flight
+    releaseSentFrames();
+
+    memset(&testData, 0, sizeof(testData));
+    testData.frameCapable = frameCapable;
+    testData.replySize = 3;
+    testData.txSize = TEST_BUFFER_SIZE;
+
+    memset(&testPort, 0, sizeof(testPort));
+    testPortConfig.identifier = SERIAL_PORT_USART1;
+    testPortConfig.functionMask = FUNCTION_MSP;
+    mspSerialInit();
+}
+
+static void queueV1Request(uint8_t cmd)
+{
+    uint8_t *p = &testData.rxBuffer[testData.rxLength];
+    p[0] = '$';
+    p[1] = 'M';
+    p[2] = '<';
+    p[3] = 0;
+    p[4] = cmd;
+    p[5] = cmd;
+    testData.rxLength += 6;
+}
+
+static void queueV2Request(uint16_t cmd, const uint8_t *payload, int payloadLength)
+{
+    uint8_t *p = &testData.rxBuffer[testData.rxLength];
+    p[0] = '$';
+    p[1] = 'X';
+    p[2] = '<';
+    p[3] = 0;
+    p[4] = cmd & 0xff;
+    p[5] = cmd >> 8;
+    p[6] = payloadLength & 0xff;
+    p[7] = payloadLength >> 8;
+    memcpy(&p[8], payload, payloadLength);
+    p[8 + payloadLength] = crc8_dvb_s2_update(0, &p[3], 5 + payloadLength);
+    testData.rxLength += 9 + payloadLength;
+}
+
+// a stand in for the MSP2_DATAFLASH_STREAM handler of msp.c, streaming from flashData instead of the flash chip
+static uint8_t flashData[1000];
+static uint32_t streamAddress;
+static uint32_t streamRemaining;
+static bool streamEnded;
+
+static bool testStreamFrame(sbuf_t *dst)
+{
+    if (streamEnded) {
+        return false;
+    }
+
+    const uint32_t readLength = MIN(streamRemaining, (uint32_t)sbufBytesRemaining(dst) - sizeof(uint32_t));
+    sbufWriteU32(dst, streamAddress);
+    sbufWriteData(dst, &flashData[streamAddress], readLength);
+
+    streamAddress += readLength;
+    streamRemaining -= readLength;
+    streamEnded = readLength == 0;
+
+    return true;
+}
+
+static void testStreamStart(serialPort_t *port)
+{
+    mspSerialStreamStart(port, MSP2_DATAFLASH_STREAM, testStreamFrame);
+}
+
+static mspResult_e testProcessCommand(mspPacket_t *cmd, mspPacket_t *reply, mspPostProcessFnPtr *mspPostProcessFn)
+{
+    testData.commandCount++;
+    if (cmd->cmd == MSP2_DATAFLASH_STREAM) {
+        streamAddress = sbufReadU32(&cmd->buf);
+        streamRemaining = sbufReadU32(&cmd->buf);
+        streamEnded = false;
+        reply->cmd = cmd->cmd;
+        sbufWriteU32(&reply->buf, streamAddress);
+        sbufWriteU32(&reply->buf, streamRemaining);
+        *mspPostProcessFn = testStreamStart;
+        return MSP_RESULT_ACK;
+    }
+    if (testData.replySize < 0) {
+        return MSP_RESULT_NO_REPLY;
+    }
+    reply->cmd = cmd->cmd;
+    for (int i = 0; i < testData.replySize; i++) {
+        sbufWriteU8(&reply->buf, i + 1);
+    }
+    return MSP_RESULT_ACK;
+}
+
+static void testProcessReply(mspPacket_t *reply)
+{
+    UNUSED(reply);
+}
+
+static void processMsp(void)
+{
+    mspSerialProcess(MSP_SKIP_NON_MSP_DATA, testProcessCommand, testProcessReply);
+}
+
+TEST(MspSerialTest, ReplyIsSentFromFramePool)
+{
+    resetTest(true);
+
+    queueV1Request(MSP_API_VERSION);
+    processMsp();
+
+    EXPECT_EQ(1, testData.commandCount);
+    EXPECT_EQ(1, testData.framesSent);
+    EXPECT_EQ(0, testData.txCopyLength);
+
+    const uint8_t expected[] = { '$', 'M', '>', 3, MSP_API_VERSION, 1, 2, 3, 3 ^ MSP_API_VERSION ^ 1 ^ 2 ^ 3 };
+    ASSERT_EQ((int)sizeof(expected), testData.frameLength);
+    EXPECT_EQ(0, memcmp(expected, testData.frame, sizeof(expected)));
+}
+
+TEST(MspSerialTest, RequestsWaitForFreeFrame)
+{
+    resetTest(true);
+
+    for (int i = 0; i <= MSP_FRAME_POOL_SIZE; i++) {
+        queueV1Request(MSP_API_VERSION);
+    }
+
+    // every frame is still being sent, the last request stays in the receive buffer
+    for (int i = 0; i <= MSP_FRAME_POOL_SIZE; i++) {
+        processMsp();
+    }
+    EXPECT_EQ(MSP_FRAME_POOL_SIZE, testData.commandCount);
+    EXPECT_EQ(6, testData.rxLength - testData.rxPos);
+
+    releaseSentFrames();
+    processMsp();
+    EXPECT_EQ(MSP_FRAME_POOL_SIZE + 1, testData.commandCount);
+    EXPECT_EQ(MSP_FRAME_POOL_SIZE + 1, testData.framesSent);
+}
+
+TEST(MspSerialTest, FrameIsCopiedWhenPortCannotSendIt)
+{
+    resetTest(false);
+
+    // the frame is released as soon as it has been copied
+    for (int i = 0; i <= MSP_FRAME_POOL_SIZE; i++) {
+        queueV1Request(MSP_API_VERSION);
+        processMsp();
+    }
+
+    EXPECT_EQ(MSP_FRAME_POOL_SIZE + 1, testData.commandCount);
+    EXPECT_EQ(0, testData.framesSent);
+    EXPECT_EQ((MSP_FRAME_POOL_SIZE + 1) * 9, testData.txCopyLength);
+    EXPECT_EQ('$', testData.txCopy[9]);
+    EXPECT_EQ(3 ^ MSP_API_VERSION ^ 1 ^ 2 ^ 3, testData.txCopy[8]);
+}
+
+TEST(MspSerialTest, JumboAndV2Replies)
+{
+    resetTest(true);
+
+    testData.replySize = 300;
+    queueV1Request(MSP_API_VERSION);
+    processMsp();
+    ASSERT_EQ(1, testData.framesSent);
+    ASSERT_EQ(5 + 2 + 300 + 1, testData.frameLength);
+    EXPECT_EQ(255, testData.frame[3]);
+    EXPECT_EQ(300, testData.frame[5] | testData.frame[6] << 8);
+    EXPECT_EQ(1, testData.frame[7]);
+    releaseSentFrames();
+
+    // MSPv2 native request for command 0x1234
+    testData.replySize = 2;
+    uint8_t *p = &testData.rxBuffer[testData.rxLength];
+    const uint8_t request[] = { '$', 'X', '<', 0, 0x34, 0x12, 0, 0 };
+    memcpy(p, request, sizeof(request));
+    p[sizeof(request)] = crc8_dvb_s2_update(0, &request[3], 5);
+    testData.rxLength += sizeof(request) + 1;
+    processMsp();
+
+    ASSERT_EQ(2, testData.framesSent);
+    const uint8_t expected[] = { '$', 'X', '>', 0, 0x34, 0x12, 2, 0, 1, 2 };
+    ASSERT_EQ((int)sizeof(expected) + 1, testData.frameLength);
+    EXPECT_EQ(0, memcmp(expected, testData.frame, sizeof(expected)));
+    EXPECT_EQ(crc8_dvb_s2_update(0, &expected[3], sizeof(expected) - 3), testData.frame[sizeof(expected)]);
+}
+
+TEST(MspSerialTest, NoReplyReleasesFrame)
+{
+    resetTest(true);
+
+    testData.replySize = -1;
+    for (int i = 0; i <= MSP_FRAME_POOL_SIZE; i++) {
+        queueV1Request(MSP_API_VERSION);
+        processMsp();
+    }
+
+    EXPECT_EQ(MSP_FRAME_POOL_SIZE + 1, testData.commandCount);
+    EXPECT_EQ(0, testData.framesSent);
+    EXPECT_EQ(0, testData.txCopyLength);
+}
+
+typedef struct streamCapture_s {
+    uint8_t data[sizeof(flashData)];
+    uint32_t nextAddress;
+    int frames;
+    int largestFrame;
+    bool ended;
+} streamCapture_t;
+
+// checks the MSPv2 stream frames the port has taken so far and empties its transmit buffer
+static void drainStreamFrames(streamCapture_t *capture)
+{
+    const uint8_t *p = testData.txCopy;
+    while (p < testData.txCopy + testData.txCopyLength) {
+        ASSERT_EQ(0, memcmp(p, "$X>", 3));
+        ASSERT_EQ(MSP2_DATAFLASH_STREAM, p[4] | p[5] << 8);
+        const int size = p[6] | p[7] << 8;
+        ASSERT_EQ(crc8_dvb_s2_update(0, &p[3], 5 + size), p[8 + size]);
+        ASSERT_FALSE(capture->ended);
+
+        const uint32_t address = p[8] | p[9] << 8 | p[10] << 16 | p[11] << 24;
+        EXPECT_EQ(capture->nextAddress, address);
+        const int dataLength = size - 4;
+        memcpy(&capture->data[address], &p[12], dataLength);
+        capture->nextAddress = address + dataLength;
+        capture->frames++;
+        capture->largestFrame = MAX(capture->largestFrame, 9 + size);
+        capture->ended = dataLength == 0;
+        p += 9 + size;
+    }
+    testData.txCopyLength = 0;
+}
+
+static void requestStream(uint32_t address, uint32_t length)
+{
+    const uint8_t request[] = {
+        (uint8_t)address, (uint8_t)(address >> 8), (uint8_t)(address >> 16), (uint8_t)(address >> 24),
+        (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)(length >> 16), (uint8_t)(length >> 24),
+    };
+    queueV2Request(MSP2_DATAFLASH_STREAM, request, sizeof(request));
+    processMsp();
+
+    // the reply echoes the range, the frames follow it
+    ASSERT_EQ(9 + 8, testData.txCopyLength);
+    EXPECT_EQ(0, memcmp(request, &testData.txCopy[8], sizeof(request)));
+    testData.txCopyLength = 0;
+}
+
+TEST(MspSerialTest, StreamIsPacedByTransmitBuffer)
+{
+    resetTest(false);
+    for (unsigned i = 0; i < sizeof(flashData); i++) {
+        flashData[i] = i * 13;
+    }
+    streamCapture_t capture;
+    memset(&capture, 0, sizeof(capture));
+
+    requestStream(0, sizeof(flashData));
+    EXPECT_EQ(1, testData.commandCount);
+
+    // too little room for a worthwhile frame, nothing is sent
+    testData.txSize = 60;
+    processMsp();
+    EXPECT_EQ(0, testData.txCopyLength);
+
+    // each pass sends frames for as long as they fit, never more than the port has room for
+    testData.txSize = 200;
+    for (int i = 0; i < 20 && !capture.ended; i++) {
+        processMsp();
+        EXPECT_GT(testData.txCopyLength, 0);
+        EXPECT_LE(testData.txCopyLength, testData.txSize);
+        drainStreamFrames(&capture);
+    }
+
+    // the data arrives in order in several frames and an empty frame ends the stream
+    EXPECT_FALSE(testData.txOverflow);
+    EXPECT_TRUE(capture.ended);
+    EXPECT_GT(capture.frames, 5);
+    EXPECT_LE(capture.largestFrame, 200);
+    EXPECT_EQ(sizeof(flashData), capture.nextAddress);
+    EXPECT_EQ(0, memcmp(flashData, capture.data, sizeof(flashData)));
+
+    // once ended nothing more is sent
+    processMsp();
+    EXPECT_EQ(0, testData.txCopyLength);
+    EXPECT_EQ(1, testData.commandCount);
+}
+
+TEST(MspSerialTest, StreamIsCancelledByRequest)
+{
+    resetTest(false);
+    streamCapture_t capture;
+    memset(&capture, 0, sizeof(capture));
+
+    requestStream(0, sizeof(flashData));
+    testData.txSize = 200;
+    processMsp();
+    drainStreamFrames(&capture);
+    EXPECT_GT(capture.frames, 0);
+    EXPECT_FALSE(capture.ended);
+
+    // anything received on the port stops the stream, the request is answered instead
+    queueV1Request(MSP_API_VERSION);
+    processMsp();
+    EXPECT_EQ(2, testData.commandCount);
+    ASSERT_EQ(9, testData.txCopyLength);
+    EXPECT_EQ('>', testData.txCopy[2]);
+    testData.txCopyLength = 0;
+
+    processMsp();
+    EXPECT_EQ(0, testData.txCopyLength);
+}
+
+// STUBS
+
+extern "C" {
+    int cliSmartMode;
+    const uint32_t baudRates[] = { 0, 9600, 19200, 38400, 57600, 115200 };
+
+    uint32_t millis(void) { return 0; }
+    void systemResetToBootloader(void) {}
+    void cliEnter(serialPort_t *) {}
+
+    serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return &testPortConfig; }
+    serialPortConfig_t *findNextSerialPortConfig(serialPortFunction_e) { return NULL; }
+    bool isSerialPortShared(const serialPortConfig_t *, uint16_t, serialPortFunction_e) { return false; }
+    serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_e, portOptions_e) { return &testPort; }
+    void closeSerialPort(serialPort_t *) {}
+    void waitForSerialPortToFinishTransmitting(serialPort_t *) {}
+
+    uint32_t serialRxBytesWaiting(const serialPort_t *) { return testData.rxLength - testData.rxPos; }
+    uint8_t serialRead(serialPort_t *) { return testData.rxBuffer[testData.rxPos++]; }
+    uint32_t serialTxBytesFree(const serialPort_t *) { return testData.txSize - testData.txCopyLength; }
+    bool isSerialTransmitBufferEmpty(const serialPort_t *) { return true; }
+    void serialBeginWrite(serialPort_t *) {}
+    void serialEndWrite(serialPort_t *) {}
+
+    void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+    {
+        if (testData.txCopyLength + count > TEST_BUFFER_SIZE) {
+            testData.txOverflow = true;
+            return;
+        }
+        memcpy(&testData.txCopy[testData.txCopyLength], data, count);
+        testData.txCopyLength += count;
+    }
+
+    bool serialWriteFrame(serialPort_t *, const uint8_t *data, int count, serialTxFrameDoneCallbackPtr doneCb, void *doneData)
+    {
+        if (!testData.frameCapable) {
+            return false;
+        }
+        testData.frame = data;
+        testData.frameLength = count;
+        testData.frameDoneCb[testData.framesSent] = doneCb;
+        testData.frameDoneData[testData.framesSent] = doneData;
+        testData.framesSent++;
+        return true;
+    }
+}
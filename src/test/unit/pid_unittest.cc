@@ -18,6 +18,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <limits.h>
+#include <string.h>
 #include <cmath>
 
 #include "unittest_macros.h"
@@ -465,6 +466,80 @@ TEST(pidControllerTest, testCrashRecoveryMode) {
     // Add additional verifications
 }
 
+typedef struct pidParityConfig_s {
+    uint8_t butteredPids;
+    uint8_t dtermFilterType;
+    uint16_t dtermLowpassHz;
+    uint16_t dtermNotchHz;
+    uint8_t itermRotation;
+} pidParityConfig_t;
+
+static const pidParityConfig_t pidParityConfigs[] = {
+    { true,  FILTER_BIQUAD, 100, 260, false },
+    { true,  FILTER_PT1,    100, 0,   false },
+    { false, FILTER_BIQUAD, 100, 260, true  },
+    { false, FILTER_PT1,    100, 260, false },
+    { false, FILTER_BIQUAD, 0,   0,   true  },
+};
+
+// sum of the magnitude of every P, I, D and F output over the run, per axis
+static void runPidParityScenario(const pidParityConfig_t *config, double sums[XYZ_AXIS_COUNT][4])
+{
+    resetTest();
+    pidProfile->buttered_pids = config->butteredPids;
+    pidProfile->dterm_filter_type = config->dtermFilterType;
+    pidProfile->dterm_lowpass_hz = config->dtermLowpassHz;
+    pidProfile->dterm_notch_hz = config->dtermNotchHz;
+    pidProfile->iterm_rotation = config->itermRotation;
+    // 8kHz, so the D term filters are inside the nyquist limit
+    gyro.targetLooptime = 125;
+    pidConfigMutable()->pid_process_denom = 1;
+    pidInit(pidProfile);
+    ENABLE_ARMING_FLAG(ARMED);
+    pidStabilisationState(PID_STABILISATION_ON);
+
+    memset(sums, 0, sizeof(double) * XYZ_AXIS_COUNT * 4);
+    for (int loop = 0; loop < 2000; loop++) {
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            setStickPosition(axis, 0.5f * sinf(0.01f * loop * (axis + 1)));
+            gyro.gyroADCf[axis] = 0.9f * simulatedSetpointRate[axis] + 40.0f * sinf(0.2f * loop + axis);
+        }
+        simulateMixerSaturated = (loop / 150) % 3 == 2;
+        simulatedMotorMixRange = simulateMixerSaturated ? 1.0f : 0.5f;
+        simulatedThrottlePIDAttenuation = 0.7f + 0.3f * cosf(0.003f * loop);
+        pidController(pidProfile, &rollAndPitchTrims, currentTestTime());
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            sums[axis][0] += fabsf(pidData[axis].P);
+            sums[axis][1] += fabsf(pidData[axis].I);
+            sums[axis][2] += fabsf(pidData[axis].D);
+            sums[axis][3] += fabsf(pidData[axis].F);
+        }
+
+    }
+}
+
+// sums recorded with the per axis controllers that ran TPA, saturation and the D term filter separately for each axis
+static const double pidParitySums[ARRAYLEN(pidParityConfigs)][XYZ_AXIS_COUNT][4] = {
+    { { 114434.681, 23950.0393, 1011593.94, 229238.814 }, { 170643.488, 9443.6893, 2262735.08, 419450.205 }, { 1741386.62, 112064.466, 1935044.84, 52322.2661 } },
+    { { 114434.681, 23950.0393, 1025105.52, 229238.814 }, { 170643.488, 9443.6893, 2213915.49, 419450.205 }, { 1741386.62, 112064.466, 1840251.91, 52322.2661 } },
+    { { 114434.681, 71479.3499, 1002124.88, 229238.814 }, { 170643.488, 29081.3942, 2252794.59, 419450.205 }, { 1741386.62, 101888.73, 1903989.55, 52322.2661 } },
+    { { 114434.681, 23950.0393, 997316.889, 229238.814 }, { 170643.488, 9443.6893, 2186866.64, 419450.205 }, { 1741386.62, 112064.466, 1803425.25, 52322.2661 } },
+    { { 114434.681, 71479.3499, 1213359.65, 229238.814 }, { 170643.488, 29081.3942, 2422900.76, 419450.205 }, { 1741386.62, 101888.73, 2044423.84, 52322.2661 } },
+};
+
+TEST(pidControllerTest, testThreeAxisControllerParity) {
+    for (unsigned c = 0; c < ARRAYLEN(pidParityConfigs); c++) {
+        double sums[XYZ_AXIS_COUNT][4];
+        runPidParityScenario(&pidParityConfigs[c], sums);
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            for (int term = 0; term < 4; term++) {
+                EXPECT_NEAR(pidParitySums[c][axis][term], sums[axis][term], 1e-6 * pidParitySums[c][axis][term])
+                    << "config " << c << " axis " << axis << " term " << term;
+            }
+        }
+    }
+}
+
 TEST(pidControllerTest, pidSetpointTransition) {
 // TODO
 }
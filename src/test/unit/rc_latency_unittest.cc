@@ -0,0 +1,127 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "fc/rc_latency.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static timeUs_t currentTimeUs;
+
+static void markStages(const uint32_t *delaysUs)
+{
+    for (int stage = RC_LATENCY_STAGE_RX_CHANNELS; stage < RC_LATENCY_STAGE_COUNT; stage++) {
+        currentTimeUs += delaysUs[stage];
+        rcLatencyMark((rcLatencyStage_e)stage);
+    }
+}
+
+TEST(RcLatencyTest, StageDelaysAndTotal)
+{
+    rcLatencyReset();
+    debugMode = DEBUG_RC_LATENCY;
+
+    const uint32_t delaysUs[RC_LATENCY_STAGE_COUNT] = { 0, 300, 90, 20, 5, 3000 };
+    currentTimeUs = 10000;
+    rcLatencyFrameReceived(currentTimeUs - 40);
+    markStages(delaysUs);
+
+    const rcLatencyStats_t *total = rcLatencyGetStats(RC_LATENCY_STAGE_RX_FRAME);
+    EXPECT_EQ(1u, total->count);
+    EXPECT_EQ(3455u, total->maxUs);
+    EXPECT_EQ(1, total->histogram[9]); // 2048 <= 3455 < 4096
+
+    const rcLatencyStats_t *channels = rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS);
+    EXPECT_EQ(340u, channels->sumUs);
+    EXPECT_EQ(1, channels->histogram[6]);
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_MIXER)->histogram[0]);
+    EXPECT_EQ(3000u, rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR_OUTPUT)->maxUs);
+
+    EXPECT_EQ(340, debug[0]);
+    EXPECT_EQ(90, debug[1]);
+    EXPECT_EQ(3025, debug[2]);
+    EXPECT_EQ(3455, debug[3]);
+}
+
+TEST(RcLatencyTest, StagesOutOfOrderAreIgnored)
+{
+    rcLatencyReset();
+    currentTimeUs = 0xffffff00; // wraps during the test
+
+    // nothing is traced before a frame arrives
+    rcLatencyMark(RC_LATENCY_STAGE_RX_CHANNELS);
+    rcLatencyMark(RC_LATENCY_STAGE_MOTOR_OUTPUT);
+    EXPECT_EQ(0u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->count);
+
+    rcLatencyFrameReceived(currentTimeUs);
+    // motor updates run every loop, only the one after the mixer has used the frame counts
+    rcLatencyMark(RC_LATENCY_STAGE_MOTOR_OUTPUT);
+    rcLatencyMark(RC_LATENCY_STAGE_PID);
+    currentTimeUs += 100;
+    rcLatencyMark(RC_LATENCY_STAGE_RX_CHANNELS);
+    EXPECT_EQ(0u, rcLatencyGetStats(RC_LATENCY_STAGE_MOTOR_OUTPUT)->count);
+    EXPECT_EQ(0u, rcLatencyGetStats(RC_LATENCY_STAGE_PID)->count);
+    EXPECT_EQ(100u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->sumUs);
+
+    // a new frame abandons the one being traced
+    rcLatencyFrameReceived(currentTimeUs);
+    const uint32_t delaysUs[RC_LATENCY_STAGE_COUNT] = { 0, 10, 10, 10, 10, 10 };
+    markStages(delaysUs);
+    EXPECT_EQ(1u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_FRAME)->count);
+    EXPECT_EQ(50u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_FRAME)->sumUs);
+    EXPECT_EQ(2u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->count);
+
+    // stages after the motor output wait for the next frame
+    rcLatencyMark(RC_LATENCY_STAGE_RX_CHANNELS);
+    EXPECT_EQ(2u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->count);
+
+    rcLatencyReset();
+    EXPECT_EQ(0u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_FRAME)->count);
+    EXPECT_EQ(0u, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->maxUs);
+}
+
+TEST(RcLatencyTest, LongDelaysGoToLastBucket)
+{
+    rcLatencyReset();
+    currentTimeUs = 0;
+
+    const uint32_t delaysUs[RC_LATENCY_STAGE_COUNT] = { 0, 100000, 1, 1, 1, 1 };
+    rcLatencyFrameReceived(currentTimeUs);
+    markStages(delaysUs);
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_RX_CHANNELS)->histogram[RC_LATENCY_HISTOGRAM_BUCKET_COUNT - 1]);
+    EXPECT_EQ(1, rcLatencyGetStats(RC_LATENCY_STAGE_PID)->histogram[0]);
+}
+
+// STUBS
+
+extern "C" {
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+
+timeUs_t micros(void) { return currentTimeUs; }
+}
@@ -0,0 +1,148 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "fc/rc_prediction.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define FRAME_INTERVAL_US 4000
+#define STICK_RATE 0.05f // rcCommand change per us
+
+static rcPredictionState_t state;
+
+static float stickAt(timeUs_t timeUs)
+{
+    return STICK_RATE * timeUs;
+}
+
+// sends a frame sampled by the transmitter at sentAtUs which arrives delayUs later
+static void sendFrame(timeUs_t sentAtUs, int delayUs)
+{
+    const float values[RC_PREDICTION_CHANNEL_COUNT] = { stickAt(sentAtUs), -stickAt(sentAtUs), 0, 1500 };
+    rcPredictionFrame(&state, values, sentAtUs + delayUs);
+}
+
+TEST(RcPredictionTest, TracksRampWithJitter)
+{
+    rcPredictionInit(&state);
+    srand(1);
+
+    timeUs_t sentAtUs = 100000;
+    int delayUs = 0;
+    for (int frame = 0; frame < 200; frame++) {
+        const timeUs_t arrivedAtUs = sentAtUs + delayUs;
+        const float predicted = rcPredictionValue(&state, 0, arrivedAtUs);
+        sendFrame(sentAtUs, delayUs);
+        if (frame > 1) {
+            // a new frame does not step the output
+            EXPECT_NEAR(predicted, rcPredictionValue(&state, 0, arrivedAtUs), 0.01f);
+        }
+
+        sentAtUs += FRAME_INTERVAL_US;
+        delayUs = rand() % 400;
+        for (timeUs_t nowUs = arrivedAtUs; nowUs < sentAtUs + delayUs; nowUs += 125) {
+            const float value = rcPredictionValue(&state, 0, nowUs);
+            if (frame > 50) {
+                // follows the stick with the latency of the link, not a frame behind it
+                EXPECT_NEAR(stickAt(nowUs - 200), value, STICK_RATE * 600);
+                EXPECT_FLOAT_EQ(-value, rcPredictionValue(&state, 1, nowUs));
+                EXPECT_FLOAT_EQ(1500, rcPredictionValue(&state, 3, nowUs));
+            }
+        }
+    }
+
+    EXPECT_NEAR(FRAME_INTERVAL_US, state.link.frameIntervalUs, 50);
+    EXPECT_NEAR(100, state.link.jitterUs, 50); // mean absolute difference of two uniform delays in [0, 400)
+    EXPECT_EQ(0u, state.link.droppedFrames);
+}
+
+TEST(RcPredictionTest, DroppedFramesKeepVelocity)
+{
+    rcPredictionInit(&state);
+
+    timeUs_t sentAtUs = 100000;
+    for (int frame = 0; frame < 20; frame++) {
+        sendFrame(sentAtUs, 0);
+        sentAtUs += FRAME_INTERVAL_US;
+    }
+
+    // a lost frame holds the output once the next frame is overdue
+    const timeUs_t lastAtUs = sentAtUs - FRAME_INTERVAL_US;
+    const float held = rcPredictionValue(&state, 0, lastAtUs + FRAME_INTERVAL_US + 100);
+    EXPECT_FLOAT_EQ(held, rcPredictionValue(&state, 0, lastAtUs + 2 * FRAME_INTERVAL_US - 100));
+    EXPECT_NEAR(stickAt(lastAtUs + FRAME_INTERVAL_US), held, 1);
+
+    // the frame after it still gives the stick velocity and the link rate is unchanged
+    sentAtUs += FRAME_INTERVAL_US;
+    sendFrame(sentAtUs, 0);
+    EXPECT_EQ(1u, state.link.droppedFrames);
+    EXPECT_FLOAT_EQ(FRAME_INTERVAL_US, state.link.frameIntervalUs);
+    EXPECT_NEAR(STICK_RATE, state.channel[0].velocity, 0.0001f);
+    // once the held output has been blended out
+    EXPECT_NEAR(stickAt(sentAtUs + FRAME_INTERVAL_US), rcPredictionValue(&state, 0, sentAtUs + FRAME_INTERVAL_US), 1);
+}
+
+TEST(RcPredictionTest, FollowsSlowerLink)
+{
+    rcPredictionInit(&state);
+
+    timeUs_t sentAtUs = 100000;
+    for (int frame = 0; frame < 10; frame++) {
+        sendFrame(sentAtUs, 0);
+        sentAtUs += FRAME_INTERVAL_US;
+    }
+    for (int frame = 0; frame < RC_PREDICTION_RESYNC_INTERVALS; frame++) {
+        sentAtUs += FRAME_INTERVAL_US;
+        sendFrame(sentAtUs, 0);
+        sentAtUs += FRAME_INTERVAL_US;
+    }
+
+    EXPECT_FLOAT_EQ(2 * FRAME_INTERVAL_US, state.link.frameIntervalUs);
+    EXPECT_EQ(RC_PREDICTION_RESYNC_INTERVALS - 1u, state.link.droppedFrames);
+}
+
+TEST(RcPredictionTest, RestartsAfterSignalLoss)
+{
+    rcPredictionInit(&state);
+
+    // nothing to predict from before the second frame
+    const float values[RC_PREDICTION_CHANNEL_COUNT] = { 100, 200, 300, 1200 };
+    rcPredictionFrame(&state, values, 1000);
+    EXPECT_FLOAT_EQ(100, rcPredictionValue(&state, 0, 3000));
+
+    timeUs_t sentAtUs = 100000;
+    for (int frame = 0; frame < 10; frame++) {
+        sendFrame(sentAtUs, 0);
+        sentAtUs += FRAME_INTERVAL_US;
+    }
+
+    rcPredictionFrame(&state, values, sentAtUs + RC_PREDICTION_MAX_INTERVAL_US);
+    EXPECT_FLOAT_EQ(0, state.link.frameIntervalUs);
+    EXPECT_FLOAT_EQ(300, rcPredictionValue(&state, 2, sentAtUs + RC_PREDICTION_MAX_INTERVAL_US + 2000));
+}
@@ -0,0 +1,189 @@
+/*
+ * This file is part of Cleanflight and Betaflight.
+ *
+ * Cleanflight and Betaflight are free software. You can redistribute
+ * this software and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * Cleanflight and Betaflight are distributed in the hope that they
+ * will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/feature.h"
+
+    #include "pg/pg.h"
+    #include "pg/pg_ids.h"
+
+    #include "flight/mixer.h"
+    #include "flight/rpm_filter.h"
+
+    #include "sensors/esc_sensor.h"
+    #include "sensors/gyro.h"
+
+    uint8_t debugMode;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+
+    gyro_t gyro;
+    uint32_t targetPidLooptime;
+    motorConfig_t motorConfig_System;
+
+    static bool escSensorFeatureEnabled;
+    static uint8_t motorCount;
+    static escSensorData_t escSensorData[MAX_SUPPORTED_MOTORS];
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOPTIME_US 125
+#define SAMPLE_RATE_HZ (1e6f / LOOPTIME_US)
+
+// eRPM/100 with 14 poles -> 400Hz fundamental
+#define MOTOR_RPM_LSB 1680
+#define MOTOR_FREQUENCY_HZ 400.0f
+
+static rpmFilterGyroState_t gyroState;
+static rpmFilterGyroState_t secondGyroState;
+
+static void setupFilter(bool enableEscSensor)
+{
+    pgResetAll();
+    gyro.targetLooptime = LOOPTIME_US;
+    targetPidLooptime = LOOPTIME_US;
+    motorConfig_System.motorPoleCount = 14;
+    motorCount = 4;
+    escSensorFeatureEnabled = enableEscSensor;
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        escSensorData[i].dataAge = 0;
+        escSensorData[i].rpm = MOTOR_RPM_LSB;
+    }
+    memset(&gyroState, 0, sizeof(gyroState));
+    memset(&secondGyroState, 0, sizeof(secondGyroState));
+    rpmFilterInit(rpmFilterConfig());
+}
+
+// returns the peak output amplitude once the notches have settled
+static float peakResponse(float frequencyHz)
+{
+    float peak = 0;
+    for (int i = 0; i < 4000; i++) {
+        rpmFilterUpdate();
+        const float input = sinf(2 * M_PIf * frequencyHz * i / SAMPLE_RATE_HZ);
+        const float output = rpmFilterGyro(&gyroState, FD_ROLL, input);
+        if (i >= 3000) {
+            peak = MAX(peak, fabsf(output));
+        }
+    }
+    return peak;
+}
+
+TEST(RpmFilterUnittest, DisabledWithoutRpmSource)
+{
+    setupFilter(false);
+    EXPECT_FALSE(isRpmFilterEnabled());
+    EXPECT_FLOAT_EQ(123.0f, rpmFilterGyro(&gyroState, FD_ROLL, 123.0f));
+}
+
+TEST(RpmFilterUnittest, DisabledWithZeroHarmonics)
+{
+    pgResetAll();
+    rpmFilterConfigMutable()->gyro_rpm_notch_harmonics = 0;
+    escSensorFeatureEnabled = true;
+    motorCount = 4;
+    rpmFilterInit(rpmFilterConfig());
+    EXPECT_FALSE(isRpmFilterEnabled());
+}
+
+TEST(RpmFilterUnittest, NotchesMotorHarmonics)
+{
+    setupFilter(true);
+    ASSERT_TRUE(isRpmFilterEnabled());
+
+    EXPECT_LT(peakResponse(MOTOR_FREQUENCY_HZ), 0.05f);
+    setupFilter(true);
+    EXPECT_LT(peakResponse(2 * MOTOR_FREQUENCY_HZ), 0.05f);
+    setupFilter(true);
+    EXPECT_LT(peakResponse(3 * MOTOR_FREQUENCY_HZ), 0.05f);
+}
+
+TEST(RpmFilterUnittest, PassesFrequenciesBetweenHarmonics)
+{
+    setupFilter(true);
+    EXPECT_GT(peakResponse(1.5f * MOTOR_FREQUENCY_HZ), 0.6f);
+    setupFilter(true);
+    EXPECT_GT(peakResponse(50.0f), 0.95f);
+}
+
+TEST(RpmFilterUnittest, InvalidTelemetryParksNotchesAtMinimum)
+{
+    setupFilter(true);
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        escSensorData[i].dataAge = ESC_DATA_INVALID;
+    }
+    // notches sit at gyro_rpm_notch_min, so the old motor frequency is no longer removed
+    EXPECT_GT(peakResponse(MOTOR_FREQUENCY_HZ), 0.8f);
+}
+
+TEST(RpmFilterUnittest, GyrosKeepSeparateHistory)
+{
+    float expected[1000];
+
+    setupFilter(true);
+    for (int i = 0; i < 1000; i++) {
+        rpmFilterUpdate();
+        expected[i] = rpmFilterGyro(&gyroState, FD_ROLL, sinf(2 * M_PIf * 1.5f * MOTOR_FREQUENCY_HZ * i / SAMPLE_RATE_HZ));
+    }
+
+    // a second gyro filtered through the same notches doesn't disturb the first
+    setupFilter(true);
+    for (int i = 0; i < 1000; i++) {
+        rpmFilterUpdate();
+        const float output = rpmFilterGyro(&gyroState, FD_ROLL, sinf(2 * M_PIf * 1.5f * MOTOR_FREQUENCY_HZ * i / SAMPLE_RATE_HZ));
+        rpmFilterGyro(&secondGyroState, FD_ROLL, 100.0f * cosf(2 * M_PIf * 50.0f * i / SAMPLE_RATE_HZ));
+        EXPECT_FLOAT_EQ(expected[i], output);
+    }
+}
+
+// STUBS
+
+extern "C" {
+    bool feature(uint32_t mask)
+    {
+        return (mask & FEATURE_ESC_SENSOR) && escSensorFeatureEnabled;
+    }
+
+    uint8_t getMotorCount(void)
+    {
+        return motorCount;
+    }
+
+    escSensorData_t *getEscSensorData(uint8_t motorNumber)
+    {
+        if (!escSensorFeatureEnabled) {
+            return NULL;
+        }
+        return &escSensorData[motorNumber];
+    }
+}
@@ -42,15 +42,18 @@ extern "C" {
     #include "telemetry/msp_shared.h"
 
     void crsfDataReceive(uint16_t c);
+    void crsfFrameReceive(const uint8_t *data, int length, timeUs_t frameTimeUs, void *callbackData);
     uint8_t crsfFrameCRC(void);
     uint8_t crsfFrameStatus(void);
     uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
+    timeUs_t crsfFrameTimeUs(const rxRuntimeConfig_t *rxRuntimeConfig);
 
     extern bool crsfFrameDone;
     extern crsfFrame_t crsfFrame;
     extern uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
     uint32_t dummyTimeUs;
+    int rxFrameCompleteSignals;
 
     PG_REGISTER(rxConfig_t, rxConfig, PG_RX_CONFIG, 0);
 }
@@ -277,6 +280,54 @@ TEST(CrossFireTest, TestCrsfDataReceive)
     EXPECT_EQ(crc, crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]);
 }
 
+TEST(CrossFireTest, TestCrsfFrameReceive)
+{
+    crsfFrameDone = false;
+    rxFrameCompleteSignals = 0;
+    timeUs_t frameTimeUs = 1000000;
+
+    // a frame cut short by the line going idle is dropped when the next one arrives
+    crsfFrameReceive(capturedData, 10, frameTimeUs, NULL);
+    EXPECT_EQ(false, crsfFrameDone);
+    EXPECT_EQ(0, rxFrameCompleteSignals);
+
+    frameTimeUs += 6667; // 150Hz
+    crsfFrameReceive(capturedData, sizeof(crsfRcChannelsFrame_t), frameTimeUs, NULL);
+    EXPECT_EQ(true, crsfFrameDone);
+    EXPECT_EQ(1, rxFrameCompleteSignals);
+    EXPECT_EQ(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, crsfFrame.frame.type);
+    for (int ii = 0; ii < CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE; ++ii) {
+        EXPECT_EQ(capturedData[ii + 3], crsfFrame.frame.payload[ii]);
+    }
+}
+
+TEST(CrossFireTest, TestCrsfFrameTimeOnlyFromValidRcFrames)
+{
+    rxFrameCompleteSignals = 0;
+    timeUs_t frameTimeUs = 2000000;
+    crsfFrameReceive(capturedData, sizeof(crsfRcChannelsFrame_t), frameTimeUs, NULL);
+    EXPECT_EQ(1, rxFrameCompleteSignals);
+    EXPECT_EQ(frameTimeUs, crsfFrameTimeUs(NULL));
+    const timeUs_t rcFrameTimeUs = frameTimeUs;
+
+    // a frame of another type does not move the RC frame time
+    uint8_t pingFrame[] = { CRSF_ADDRESS_CRSF_RECEIVER, 4, CRSF_FRAMETYPE_DEVICE_PING, 0x00, CRSF_ADDRESS_FLIGHT_CONTROLLER, 0 };
+    pingFrame[5] = crc8_dvb_s2_buf(&pingFrame[2], 3);
+    frameTimeUs += 6667;
+    crsfFrameReceive(pingFrame, sizeof(pingFrame), frameTimeUs, NULL);
+    EXPECT_EQ(true, crsfFrameDone);
+    EXPECT_EQ(1, rxFrameCompleteSignals);
+    EXPECT_EQ(rcFrameTimeUs, crsfFrameTimeUs(NULL));
+
+    // nor does an RC frame with a bad CRC
+    crsfRcChannelsFrame_t corruptFrame = *(const crsfRcChannelsFrame_t *)capturedData;
+    corruptFrame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] ^= 0xff;
+    frameTimeUs += 6667;
+    crsfFrameReceive((const uint8_t *)&corruptFrame, sizeof(corruptFrame), frameTimeUs, NULL);
+    EXPECT_EQ(1, rxFrameCompleteSignals);
+    EXPECT_EQ(rcFrameTimeUs, crsfFrameTimeUs(NULL));
+}
+
 // STUBS
 
 extern "C" {
@@ -292,4 +343,5 @@ void crsfScheduleMspResponse(void) {};
 bool bufferMspFrame(uint8_t *, int) {return true;}
 bool isBatteryVoltageAvailable(void) { return true; }
 bool isAmperageAvailable(void) { return true; }
+void rxSignalFrameComplete(void) { rxFrameCompleteSignals++; }
 }
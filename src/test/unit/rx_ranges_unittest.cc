@@ -31,6 +31,7 @@ extern "C" {
     #include "fc/rc_controls.h"
     #include "fc/rc_modes.h"
     #include "rx/rx.h"
+    #include "scheduler/scheduler.h"
 }
 
 #include "unittest_macros.h"
@@ -106,6 +107,7 @@ void failsafeOnRxSuspend(uint32_t ) {}
 void failsafeOnRxResume(void) {}
 
 uint32_t micros(void) { return 0; }
+void schedulerSignalTask(cfTaskId_e) {}
 uint32_t millis(void) { return 0; }
 
 void rxPwmInit(rxRuntimeConfig_t *rxRuntimeConfig, rcReadRawDataFnPtr *callback)
@@ -34,6 +34,7 @@ extern "C" {
     #include "pg/pg.h"
     #include "pg/pg_ids.h"
     #include "io/beeper.h"
+    #include "scheduler/scheduler.h"
 
     boxBitmask_t rcModeActivationMask;
     int16_t debug[DEBUG16_VALUE_COUNT];
@@ -203,6 +204,7 @@ extern "C" {
     void failsafeOnRxResume(void) {}
 
     uint32_t micros(void) { return 0; }
+    void schedulerSignalTask(cfTaskId_e) {}
     uint32_t millis(void) { return 0; }
 
     bool isPPMDataBeingReceived(void) {
@@ -38,23 +38,31 @@ const int TEST_DISPATCH_TIME = 1;
 #define TASK_PERIOD_HZ(hz) (1000000 / (hz))
 
 extern "C" {
-    cfTask_t * unittest_scheduler_selectedTask;
-    uint8_t unittest_scheduler_selectedTaskDynPrio;
-    uint16_t unittest_scheduler_waitingTasks;
+    extern cfTask_t * unittest_scheduler_selectedTask;
+    extern uint8_t unittest_scheduler_selectedTaskDynPrio;
+    extern uint16_t unittest_scheduler_waitingTasks;
 
     // set up micros() to simulate time
     uint32_t simulatedTime = 0;
     uint32_t micros(void) { return simulatedTime; }
+    // one simulated cpu cycle per microsecond
+    uint32_t ticks(void) { return simulatedTime; }
+    uint32_t clockCyclesToMicros(uint32_t clockCycles) { return clockCycles; }
+    uint32_t clockMicrosToCycles(uint32_t micros) { return micros; }
 
     // set up tasks to take a simulated representative time to execute
     void taskMainPidLoop(timeUs_t) { simulatedTime += TEST_PID_LOOP_TIME; }
     void taskUpdateAccelerometer(timeUs_t) { simulatedTime += TEST_UPDATE_ACCEL_TIME; }
     void taskHandleSerial(timeUs_t) { simulatedTime += TEST_HANDLE_SERIAL_TIME; }
     void taskUpdateBatteryVoltage(timeUs_t) { simulatedTime += TEST_UPDATE_BATTERY_TIME; }
-    bool rxUpdateCheck(timeUs_t, timeDelta_t) { simulatedTime += TEST_UPDATE_RX_CHECK_TIME; return false; }
+    int rxUpdateCheckCount = 0;
+    bool rxFrameReady = false;
+    bool rxUpdateCheck(timeUs_t, timeDelta_t) { simulatedTime += TEST_UPDATE_RX_CHECK_TIME; rxUpdateCheckCount++; return rxFrameReady; }
     void taskUpdateRxMain(timeUs_t) { simulatedTime += TEST_UPDATE_RX_MAIN_TIME; }
     void imuUpdateAttitude(timeUs_t) { simulatedTime += TEST_IMU_UPDATE_TIME; }
     void dispatchProcess(timeUs_t) { simulatedTime += TEST_DISPATCH_TIME; }
+    bool gyroDataReady = false;
+    bool gyroDataReadyCheck(timeUs_t, timeDelta_t) { return gyroDataReady; }
 
     extern int taskQueueSize;
     extern cfTask_t* taskQueueArray[];
@@ -66,6 +74,9 @@ extern "C" {
     extern cfTask_t *queueFirst(void);
     extern cfTask_t *queueNext(void);
 
+    // only the configuration of each task is given, the scheduling and statistics fields start zeroed
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
     cfTask_t cfTasks[TASK_COUNT] = {
         [TASK_SYSTEM] = {
             .taskName = "SYSTEM",
@@ -73,6 +84,9 @@ extern "C" {
             .desiredPeriod = TASK_PERIOD_HZ(10),
             .staticPriority = TASK_PRIORITY_MEDIUM_HIGH,
         },
+        [TASK_MAIN] = {
+            .taskName = "MAIN",
+        },
         [TASK_GYROPID] = {
             .taskName = "PID",
             .subTaskName = "GYRO",
@@ -116,8 +130,17 @@ extern "C" {
             .taskFunc = taskUpdateBatteryVoltage,
             .desiredPeriod = TASK_PERIOD_HZ(50),
             .staticPriority = TASK_PRIORITY_MEDIUM,
+        },
+        // stands in for the gyro/PID task of a target that runs it from the gyro data ready interrupt
+        [TASK_BATTERY_CURRENT] = {
+            .taskName = "PID_TRIGGER",
+            .checkFunc = gyroDataReadyCheck,
+            .taskFunc = taskMainPidLoop,
+            .desiredPeriod = 1000,
+            .staticPriority = TASK_PRIORITY_TRIGGER,
         }
     };
+#pragma GCC diagnostic pop
 }
 
 TEST(SchedulerUnittest, TestPriorites)
@@ -393,3 +416,181 @@ TEST(SchedulerUnittest, TestTwoTasks)
     scheduler();
     EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
 }
+
+TEST(SchedulerUnittest, TestTaskHistogram)
+{
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_ACCEL, true);
+    schedulerResetTaskHistogram(TASK_ACCEL);
+    cfTasks[TASK_ACCEL].maxExecutionCycles = 0;
+    cfTasks[TASK_ACCEL].lastStartedAtCycles = 0;
+
+    simulatedTime = 100000;
+    cfTasks[TASK_ACCEL].lastExecutedAt = simulatedTime - 10000;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+
+    // start 300 cycles later than the desired period
+    simulatedTime = 100000 + 10000 + 300;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_ACCEL], unittest_scheduler_selectedTask);
+
+    cfTaskHistogram_t taskHistogram;
+    getTaskHistogram(TASK_ACCEL, &taskHistogram);
+    EXPECT_EQ(TEST_UPDATE_ACCEL_TIME, taskHistogram.maxExecutionCycles);
+    EXPECT_EQ(TEST_UPDATE_ACCEL_TIME + 1, cfTasks[TASK_ACCEL].worstExecutionTime);
+    // 192 cycles are in [2^7, 2^8)
+    EXPECT_EQ(2, taskHistogram.executionHistogram[1]);
+    // the first invocation has no previous start to measure jitter against, 300 cycles are in [2^8, 2^9)
+    EXPECT_EQ(1, taskHistogram.jitterHistogram[2]);
+
+    schedulerResetTaskHistogram(TASK_ACCEL);
+    getTaskHistogram(TASK_ACCEL, &taskHistogram);
+    EXPECT_EQ(0, taskHistogram.executionHistogram[1]);
+    EXPECT_EQ(0, taskHistogram.jitterHistogram[2]);
+}
+
+TEST(SchedulerUnittest, TestDeadlineScheduling)
+{
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_GYROPID, true);
+    setTaskEnabled(TASK_SERIAL, true);
+    setTaskEnabled(TASK_BATTERY_VOLTAGE, true);
+    cfTasks[TASK_GYROPID].dynamicPriority = 0;
+    cfTasks[TASK_SERIAL].dynamicPriority = 0;
+    cfTasks[TASK_BATTERY_VOLTAGE].dynamicPriority = 0;
+    cfTasks[TASK_SERIAL].worstExecutionTime = TEST_HANDLE_SERIAL_TIME;
+    cfTasks[TASK_BATTERY_VOLTAGE].worstExecutionTime = TEST_UPDATE_BATTERY_TIME;
+
+    // TASK_SERIAL is due earlier, but TASK_BATTERY_VOLTAGE is two periods late and has the higher dynamic priority
+    static const uint32_t startTime = 200000;
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 100;
+    cfTasks[TASK_SERIAL].lastExecutedAt = startTime - 35000;
+    cfTasks[TASK_BATTERY_VOLTAGE].lastExecutedAt = startTime - 40000;
+
+    schedulerSetDeadlineScheduling(false);
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_BATTERY_VOLTAGE], unittest_scheduler_selectedTask);
+
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 100;
+    cfTasks[TASK_BATTERY_VOLTAGE].lastExecutedAt = startTime - 40000;
+    cfTasks[TASK_BATTERY_VOLTAGE].dynamicPriority = 0;
+    schedulerSetDeadlineScheduling(true);
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_SERIAL], unittest_scheduler_selectedTask);
+
+    // TASK_GYROPID is due in 20us, so TASK_SERIAL no longer fits in front of it
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 980;
+    cfTasks[TASK_SERIAL].lastExecutedAt = startTime - 15000;
+    cfTasks[TASK_SERIAL].worstExecutionTime = TEST_HANDLE_SERIAL_TIME;
+    cfTasks[TASK_BATTERY_VOLTAGE].worstExecutionTime = TEST_UPDATE_BATTERY_TIME;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_BATTERY_VOLTAGE], unittest_scheduler_selectedTask);
+
+    // once TASK_GYROPID is due it runs first
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 1000;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_GYROPID], unittest_scheduler_selectedTask);
+
+    schedulerSetDeadlineScheduling(false);
+}
+
+TEST(SchedulerUnittest, TestSignalledTask)
+{
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_GYROPID, true);
+    setTaskEnabled(TASK_RX, true);
+    setTaskEnabled(TASK_SERIAL, true);
+    cfTasks[TASK_GYROPID].dynamicPriority = 0;
+    cfTasks[TASK_RX].dynamicPriority = 0;
+    cfTasks[TASK_SERIAL].dynamicPriority = 0;
+    schedulerSetDeadlineScheduling(false);
+
+    static const uint32_t startTime = 300000;
+    simulatedTime = startTime;
+    cfTasks[TASK_GYROPID].lastExecutedAt = startTime - 100;
+    cfTasks[TASK_SERIAL].lastExecutedAt = startTime - 5000;
+    cfTasks[TASK_RX].lastExecutedAt = startTime - 1000;
+
+    // until the task has been signalled its check function is polled on every pass
+    rxUpdateCheckCount = 0;
+    rxFrameReady = false;
+    scheduler();
+    scheduler();
+    EXPECT_EQ(2, rxUpdateCheckCount);
+
+    // once signalled, it is only checked when signalled or when its period has elapsed
+    schedulerSignalTask(TASK_RX);
+    rxFrameReady = true;
+    simulatedTime = startTime;
+    cfTasks[TASK_SERIAL].lastExecutedAt = startTime - 50000;
+    scheduler();
+    EXPECT_EQ(3, rxUpdateCheckCount);
+    // a ready signalled task goes ahead of a task that has waited several periods
+    EXPECT_EQ(&cfTasks[TASK_RX], unittest_scheduler_selectedTask);
+
+    rxFrameReady = false;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_SERIAL], unittest_scheduler_selectedTask);
+    scheduler();
+    EXPECT_EQ(3, rxUpdateCheckCount);
+
+    simulatedTime = startTime + TASK_PERIOD_HZ(50);
+    cfTasks[TASK_GYROPID].lastExecutedAt = simulatedTime - 100;
+    scheduler();
+    EXPECT_EQ(4, rxUpdateCheckCount);
+
+    // a signalled task still waits for a realtime task that is due
+    schedulerSignalTask(TASK_RX);
+    rxFrameReady = true;
+    cfTasks[TASK_GYROPID].lastExecutedAt = simulatedTime - 1000;
+    scheduler();
+    EXPECT_EQ(5, rxUpdateCheckCount);
+    EXPECT_EQ(&cfTasks[TASK_GYROPID], unittest_scheduler_selectedTask);
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_RX], unittest_scheduler_selectedTask);
+
+    rxFrameReady = false;
+    cfTasks[TASK_RX].signalDriven = false;
+}
+
+TEST(SchedulerUnittest, TestSignalledTaskWaitsForTriggerTask)
+{
+    for (int taskId = 0; taskId < TASK_COUNT; ++taskId) {
+        setTaskEnabled(static_cast<cfTaskId_e>(taskId), false);
+    }
+    setTaskEnabled(TASK_BATTERY_CURRENT, true);
+    setTaskEnabled(TASK_RX, true);
+    cfTasks[TASK_BATTERY_CURRENT].dynamicPriority = 0;
+    cfTasks[TASK_RX].dynamicPriority = 0;
+    schedulerSetDeadlineScheduling(false);
+
+    static const uint32_t startTime = 400000;
+    simulatedTime = startTime;
+    cfTasks[TASK_BATTERY_CURRENT].lastExecutedAt = startTime - 1000;
+    cfTasks[TASK_RX].lastExecutedAt = startTime - 1000;
+
+    // the gyro data is ready and a receiver frame has been signalled at the same time
+    gyroDataReady = true;
+    schedulerSignalTask(TASK_RX);
+    rxFrameReady = true;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_BATTERY_CURRENT], unittest_scheduler_selectedTask);
+
+    gyroDataReady = false;
+    scheduler();
+    EXPECT_EQ(&cfTasks[TASK_RX], unittest_scheduler_selectedTask);
+
+    rxFrameReady = false;
+    cfTasks[TASK_RX].signalDriven = false;
+}
@@ -296,4 +296,6 @@ extern "C" {
     int32_t getMAhDrawn(void) {
       return testmAhDrawn;
     }
+
+    void rxSignalFrameComplete(void) {}
 }